@@ -0,0 +1,31 @@
+/*!
+\file bench.h
+\author Edward Ji
+\date 19 Oct 2026
+\brief Timing utilities shared by the benchmarks.
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <time.h>
+
+#define STRINGIFY(x) STRINGIFY2(x)
+#define STRINGIFY2(x) #x
+
+//! Returns the current time in seconds from a monotonic clock.
+static inline double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+//! Runs a statement once and prints how long it took in milliseconds.
+#define BENCH(label, stmt) do {                                                \
+    double bench_start_ = bench_now();                                         \
+    stmt;                                                                      \
+    printf("%-40s %10.2f ms\n", label, (bench_now() - bench_start_) * 1e3);    \
+} while (0)
+
+#endif
@@ -0,0 +1,104 @@
+/*!
+\file cached.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares the comparator sort against the cached prefix sort on string keys.
+
+The records mimic those in the student demonstration. Names are either random
+letters, which rarely share a prefix, or drawn from a small pool of first and
+last names followed by the id, which often do. To count cache misses, run the executable under
+`perf stat -e cache-misses`.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../darray.h"
+#include "bench.h"
+
+//! The number of records in the array.
+#define N 1000000
+
+typedef struct {
+    size_t id;
+    char name[32];
+    unsigned char score;
+} record;
+
+static const char *const first_names[] = {
+    "Aiden", "Beatrice", "Darren", "Gina", "Joseph", "Leo", "Sophie", "Vicki"
+};
+
+static const char *const last_names[] = {
+    "Caldwell", "Clark", "Rodriguez", "Sims", "Smith", "Walters", "Welch"
+};
+
+int record_cmp_name(const void *p1, const void *p2) {
+    const record *rec1 = p1;
+    const record *rec2 = p2;
+
+    return strcmp(rec1->name, rec2->name);
+}
+
+uint64_t record_name_prefix(const void *p) {
+    const unsigned char *name = (const unsigned char *) ((record *) p)->name;
+    uint64_t key = 0;
+    for (int i = 0; i < 8; i++) {
+        key = key << 8 | *name;
+        name += *name != '\0';
+    }
+
+    return key;
+}
+
+void *shallow_cpy(const void *p) {
+    return (void *) p;
+}
+
+darray *shallow_clone(darray *array) {
+    darray *clone = darray_clone(array, shallow_cpy);
+    darray_set_item_free(clone, NULL);
+
+    return clone;
+}
+
+void run(darray *records) {
+    darray *clone = shallow_clone(records);
+    BENCH("darray_sort", darray_sort(clone, record_cmp_name));
+    del_darray(clone);
+
+    clone = shallow_clone(records);
+    BENCH("darray_sort_cached",
+            darray_sort_cached(clone, record_name_prefix, record_cmp_name));
+    del_darray(clone);
+}
+
+int main() {
+    srand(42);
+
+    darray *records = new_darray(free);
+    for (size_t i = 0; i < N; i++) {
+        record *rec = calloc(1, sizeof(record));
+        rec->id = i;
+        for (int j = 0; j < 12; j++) {
+            rec->name[j] = 'a' + rand() % 26;
+        }
+        darray_append(records, rec);
+    }
+    puts("random names:");
+    run(records);
+
+    for (size_t i = 0; i < N; i++) {
+        record *rec = darray_get(records, i);
+        snprintf(rec->name, sizeof(rec->name), "%s %s %zu",
+                 first_names[rand() % 8], last_names[rand() % 7], i);
+    }
+    puts("pooled names:");
+    run(records);
+
+    del_darray(records);
+
+    return 0;
+}
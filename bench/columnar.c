@@ -0,0 +1,94 @@
+/*!
+\file columnar.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares a dynamic array of student structs against a columnar student table
+when aggregating scores.
+
+Each struct takes 48 bytes, so summing scores through `darray_aggregate` loads
+a scattered cache line per student. The table keeps scores in their own array of
+bytes, so `dtyped_sum` reads 64 scores per cache line.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../darray.h"
+#include "../util/dtyped.h"
+#include "bench.h"
+
+//! The number of students in each table.
+#define N 10000000
+
+//! The highest score of a student.
+#define SCORE_MAX 100
+
+//! The number of bytes in the name of a student.
+#define NAME_LEN 32
+
+typedef struct {
+    size_t id;
+    char name[NAME_LEN];
+    unsigned char score;
+} student;
+
+#define STUDENT_FIELDS(X) X(ulong, id) X(string, name) X(uchar, score)
+
+MAKE_DTYPE_TABLE(student, STUDENT_FIELDS)
+
+void add_score(const void *p, void *resp) {
+    *((unsigned long long *) resp) += ((const student *) p)->score;
+}
+
+int main() {
+    char name[NAME_LEN];
+
+    srand(1);
+    student_table *table = new_student_table();
+    BENCH("student_table_append",
+            for (size_t i = 0; i < N; i++) {
+                snprintf(name, NAME_LEN, "student %zu", i);
+                student_table_append(table, (student_row) {
+                        i, name, rand() % (SCORE_MAX + 1)});
+            });
+    unsigned long long table_sum = 0;
+    BENCH("dtyped_sum (score column)", table_sum = dtyped_sum(table->score));
+    size_t *rows = malloc(sizeof(size_t) * N);
+    size_t passed = 0;
+    BENCH("uchar_array_between (score column)",
+            passed = uchar_array_between(table->score, 50, SCORE_MAX, rows));
+    BENCH("uchar_array_argsort (score column)",
+            uchar_array_argsort(table->score, rows));
+    int sorted = 1;
+    for (size_t i = 1; i < N; i++) {
+        sorted &= dtyped_get(table->score, rows[i - 1]) <=
+            dtyped_get(table->score, rows[i]);
+    }
+    free(rows);
+    del_student_table(table);
+
+    srand(1);
+    darray *students = new_darray(free);
+    BENCH("darray_append (student)",
+            for (size_t i = 0; i < N; i++) {
+                student *stu = malloc(sizeof(student));
+                stu->id = i;
+                snprintf(stu->name, NAME_LEN, "student %zu", i);
+                stu->score = rand() % (SCORE_MAX + 1);
+                darray_append(students, stu);
+            });
+    unsigned long long struct_sum = 0;
+    BENCH("darray_aggregate (score field)",
+            darray_aggregate(students, &struct_sum, add_score));
+    size_t struct_passed = 0;
+    BENCH("darray_get (score filter)",
+            for (size_t i = 0; i < N; i++) {
+                struct_passed +=
+                    ((student *) darray_get(students, i))->score >= 50;
+            });
+    del_darray(students);
+
+    return !sorted || table_sum != struct_sum || passed != struct_passed;
+}
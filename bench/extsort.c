@@ -0,0 +1,87 @@
+/*!
+\file extsort.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Measures sorting more integers than a memory budget allows with an external
+sorter, against sorting them all in memory.
+*/
+
+#include <stdlib.h>
+
+#include "../darray.h"
+#include "../dsort.h"
+#include "bench.h"
+
+//! The number of items to sort.
+#define N 5000000
+
+//! The number of bytes of items the external sorter keeps in memory.
+#define BUDGET ((size_t) 16 << 20)
+
+int int_cmp(const void *p1, const void *p2) {
+    int a = *(const int *) p1, b = *(const int *) p2;
+    return (a > b) - (a < b);
+}
+
+size_t int_size(const void *p) {
+    return sizeof(int);
+}
+
+int write_int(const void *p, FILE *stream) {
+    return fwrite(p, sizeof(int), 1, stream) == 1;
+}
+
+void *read_int(FILE *stream) {
+    int *p = malloc(sizeof(int));
+    if (p != NULL && fread(p, sizeof(int), 1, stream) != 1) {
+        free(p);
+        p = NULL;
+    }
+    return p;
+}
+
+//! Counts an integer that is not less than the previous one and frees it.
+void check_int(void *p, void *ctx) {
+    int **prev = ctx;
+    if (*prev == NULL || **prev <= *(int *) p) {
+        free(*prev);
+        *prev = p;
+    } else {
+        free(p);
+    }
+}
+
+int main() {
+    srand(1);
+    darray *numbers = new_darray(free);
+    BENCH("darray_append (" STRINGIFY(N) ")",
+            for (int i = 0; i < N; i++) {
+                int *p = malloc(sizeof(int));
+                *p = rand();
+                darray_append(numbers, p);
+            });
+    BENCH("darray_partial_sort (in memory)",
+            darray_partial_sort(numbers, N, int_cmp));
+    del_darray(numbers);
+
+    srand(1);
+    dsort *sorter = new_dsort(BUDGET, int_cmp, int_size, write_int, read_int,
+                              free);
+    BENCH("dsort_push (" STRINGIFY(N) ", 16 MiB budget)",
+            for (int i = 0; i < N; i++) {
+                int *p = malloc(sizeof(int));
+                *p = rand();
+                dsort_push(sorter, p);
+            });
+    printf("%-40s %10zu\n", "runs", dsort_runs(sorter));
+    int *last = NULL;
+    int failed = 0;
+    BENCH("dsort_drain_r",
+            failed = !dsort_drain_r(sorter, check_int, &last));
+    free(last);
+    del_dsort(sorter);
+
+    return failed;
+}
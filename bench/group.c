@@ -0,0 +1,183 @@
+/*!
+\file group.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares grouping students with ad-hoc `darray_aggregate` callbacks against
+`darray_group_by` and its dense counterpart.
+
+The score histogram is computed by a callback that counts into an array, with a
+hash table of scores, and with a table indexed by score. Counts per course, of
+which there are many, are computed with a hash table on one and more threads.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../darray.h"
+#include "bench.h"
+
+//! The number of students.
+#define N 10000000
+
+//! The highest score of a student.
+#define SCORE_MAX 100
+
+//! The number of courses students are enrolled in.
+#define COURSES 1000000
+
+//! The number of threads of the threaded grouping.
+#define THREADS 4
+
+typedef struct {
+    size_t id;
+    char name[32];
+    unsigned char score;
+    unsigned course;
+} student;
+
+typedef struct {
+    size_t key;
+    size_t count;
+} bucket;
+
+//! The histogram of scores filled by `count_score`.
+size_t histogram[SCORE_MAX + 1];
+
+void count_score(const void *p, void *resp) {
+    ((size_t *) resp)[((const student *) p)->score]++;
+}
+
+void *student_score(const void *p) {
+    return (void *) &((const student *) p)->score;
+}
+
+uint64_t student_score_key(const void *p) {
+    return ((const student *) p)->score;
+}
+
+size_t score_hash(const void *p) {
+    return *((const unsigned char *) p) * 11400714819323198485u;
+}
+
+int score_cmp(const void *p1, const void *p2) {
+    return *((const unsigned char *) p1) - *((const unsigned char *) p2);
+}
+
+void *student_course(const void *p) {
+    return (void *) &((const student *) p)->course;
+}
+
+size_t course_hash(const void *p) {
+    return *((const unsigned *) p) * 11400714819323198485u;
+}
+
+int course_cmp(const void *p1, const void *p2) {
+    unsigned c1 = *((const unsigned *) p1), c2 = *((const unsigned *) p2);
+    return (c1 > c2) - (c1 < c2);
+}
+
+void *new_score_bucket(const void *p) {
+    bucket *b = malloc(sizeof(bucket));
+    b->key = *((const unsigned char *) p);
+    b->count = 0;
+    return b;
+}
+
+void *new_dense_bucket(const void *p) {
+    bucket *b = malloc(sizeof(bucket));
+    b->key = *((const uint64_t *) p);
+    b->count = 0;
+    return b;
+}
+
+void *new_course_bucket(const void *p) {
+    bucket *b = malloc(sizeof(bucket));
+    b->key = *((const unsigned *) p);
+    b->count = 0;
+    return b;
+}
+
+void bucket_step(const void *p, void *resp) {
+    ((bucket *) resp)->count++;
+}
+
+void bucket_merge(const void *p, void *resp) {
+    ((bucket *) resp)->count += ((const bucket *) p)->count;
+}
+
+//! Returns whether the buckets of scores match the global histogram.
+int match_histogram(darray *buckets) {
+    int match = 1;
+    for (size_t i = 0; i < darray_len(buckets); i++) {
+        bucket *b = darray_get(buckets, i);
+        match &= b->key <= SCORE_MAX && histogram[b->key] == b->count;
+    }
+    return match;
+}
+
+//! Returns the total count of the buckets.
+size_t total(darray *buckets) {
+    size_t sum = 0;
+    for (size_t i = 0; i < darray_len(buckets); i++) {
+        sum += ((bucket *) darray_get(buckets, i))->count;
+    }
+    return sum;
+}
+
+int main() {
+    srand(1);
+    darray *students = new_darray(free);
+    for (size_t i = 0; i < N; i++) {
+        student *stu = malloc(sizeof(student));
+        stu->id = i;
+        memset(stu->name, 0, sizeof(stu->name));
+        stu->score = rand() % (SCORE_MAX + 1);
+        stu->course = rand() % COURSES;
+        darray_append(students, stu);
+    }
+
+    BENCH("darray_aggregate (histogram)",
+            darray_aggregate(students, histogram, count_score));
+    darray *hashed, *dense, *dense_threaded;
+    BENCH("darray_group_by (score)",
+            hashed = darray_group_by(students, student_score, score_hash,
+                                     score_cmp, new_score_bucket, bucket_step,
+                                     NULL, free, 1));
+    BENCH("darray_group_by_dense (score)",
+            dense = darray_group_by_dense(students, student_score_key,
+                                          SCORE_MAX + 1, new_dense_bucket,
+                                          bucket_step, NULL, free, 1));
+    BENCH("darray_group_by_dense (score, " STRINGIFY(THREADS) " threads)",
+            dense_threaded = darray_group_by_dense(
+                students, student_score_key, SCORE_MAX + 1, new_dense_bucket,
+                bucket_step, bucket_merge, free, THREADS));
+    int correct = match_histogram(hashed) && match_histogram(dense) &&
+        match_histogram(dense_threaded) && total(dense) == N;
+    del_darray(hashed);
+    del_darray(dense);
+    del_darray(dense_threaded);
+
+    darray *courses, *courses_threaded;
+    BENCH("darray_group_by (course)",
+            courses = darray_group_by(students, student_course, course_hash,
+                                      course_cmp, new_course_bucket,
+                                      bucket_step, NULL, free, 1));
+    BENCH("darray_group_by (course, " STRINGIFY(THREADS) " threads)",
+            courses_threaded = darray_group_by(
+                students, student_course, course_hash, course_cmp,
+                new_course_bucket, bucket_step, bucket_merge, free, THREADS));
+    correct &= darray_len(courses) == darray_len(courses_threaded) &&
+        total(courses) == N && total(courses_threaded) == N;
+    for (size_t i = 0; i < darray_len(courses) && correct; i++) {
+        bucket *b1 = darray_get(courses, i);
+        bucket *b2 = darray_get(courses_threaded, i);
+        correct = b1->key == b2->key && b1->count == b2->count;
+    }
+    del_darray(courses);
+    del_darray(courses_threaded);
+    del_darray(students);
+
+    return !correct;
+}
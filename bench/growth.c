@@ -0,0 +1,42 @@
+/*!
+\file growth.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares growing a dynamic array with `realloc` and with anonymous mappings.
+
+The array grows from empty to 100M items one append at a time, then shrinks
+back with a single pop.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../darray.h"
+#include "bench.h"
+
+//! The number of items to append.
+#define N 100000000
+
+void grow(darray *array) {
+    for (uintptr_t i = 0; i < N; i++) {
+        darray_append(array, (void *) (i + 1));
+    }
+}
+
+int main() {
+    darray *array = new_darray(NULL);
+    darray_set_map_threshold(SIZE_MAX);
+    BENCH("darray_append (realloc)", grow(array));
+    BENCH("darray_pop_range (realloc)", darray_pop_range(array, 0, N));
+    del_darray(array);
+
+    array = new_darray(NULL);
+    darray_set_map_threshold((size_t) 4 << 20);
+    BENCH("darray_append (mremap)", grow(array));
+    BENCH("darray_pop_range (mremap)", darray_pop_range(array, 0, N));
+    del_darray(array);
+
+    return 0;
+}
@@ -0,0 +1,122 @@
+/*!
+\file heap.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares a ready queue kept sorted by `darray_sort` against a binary heap.
+
+Each round pushes a task with a random priority and pops the most urgent one.
+The sorted queue is only run at a small size since every push re-sorts it.
+*/
+
+#include <stdlib.h>
+
+#include "../darray.h"
+#include "bench.h"
+
+//! The number of tasks waiting in the small queue.
+#define SMALL 500
+
+//! The number of tasks waiting in the large queue.
+#define LARGE 1000000
+
+//! The number of push and pop rounds.
+#define ROUNDS 2000
+
+//! The number of priority changes in the large queue.
+#define UPDATES 1000000
+
+typedef struct {
+    int priority;
+    size_t pos;
+} task;
+
+int task_cmp(const void *p1, const void *p2) {
+    int a = ((const task *) p1)->priority, b = ((const task *) p2)->priority;
+    return (a > b) - (a < b);
+}
+
+void task_track(void *p, size_t index) {
+    ((task *) p)->pos = index;
+}
+
+//! Pushes and pops a queue kept sorted with the most urgent task last.
+long long resort_rounds(darray *queue, task *tasks, size_t n) {
+    long long total = 0;
+    for (size_t i = 0; i < n; i++) {
+        darray_append(queue, tasks + i);
+        darray_sort(queue, task_cmp);
+        size_t last = darray_len(queue) - 1;
+        total += ((task *) darray_get(queue, last))->priority;
+        darray_pop(queue, last);
+    }
+    return total;
+}
+
+//! Pushes and pops a heap with the most urgent task at the root.
+long long heap_rounds(darray *queue, task *tasks, size_t n, tracker track) {
+    long long total = 0;
+    for (size_t i = 0; i < n; i++) {
+        darray_heap_push(queue, tasks + i, task_cmp, track);
+        total += ((task *) darray_get(queue, 0))->priority;
+        darray_heap_pop(queue, task_cmp, track);
+    }
+    return total;
+}
+
+//! Returns a new queue of the same random tasks every time.
+darray *new_queue(task *tasks, size_t n) {
+    darray *queue = new_darray(NULL);
+    srand(1);
+    for (size_t i = 0; i < n; i++) {
+        tasks[i].priority = rand();
+        darray_append(queue, tasks + i);
+    }
+    return queue;
+}
+
+int main() {
+    task *waiting = malloc(sizeof(task) * LARGE);
+    task *arriving = malloc(sizeof(task) * ROUNDS);
+    for (size_t i = 0; i < ROUNDS; i++) {
+        arriving[i].priority = rand();
+    }
+
+    long long resort_total, heap_total;
+    darray *queue = new_queue(waiting, SMALL);
+    darray_sort(queue, task_cmp);
+    BENCH("darray_sort per push (" STRINGIFY(SMALL) " waiting)",
+            resort_total = resort_rounds(queue, arriving, ROUNDS));
+    del_darray(queue);
+
+    queue = new_queue(waiting, SMALL);
+    darray_heapify(queue, task_cmp, NULL);
+    BENCH("darray_heap_push/pop (" STRINGIFY(SMALL) " waiting)",
+            heap_total = heap_rounds(queue, arriving, ROUNDS, NULL));
+    del_darray(queue);
+
+    queue = new_queue(waiting, LARGE);
+    BENCH("darray_heapify (" STRINGIFY(LARGE) " waiting)",
+            darray_heapify(queue, task_cmp, task_track));
+    BENCH("darray_heap_push/pop (" STRINGIFY(LARGE) " waiting)",
+            heap_rounds(queue, arriving, ROUNDS, task_track));
+
+    size_t *picks = malloc(sizeof(size_t) * UPDATES);
+    for (size_t i = 0; i < UPDATES; i++) {
+        picks[i] = (size_t) rand() % LARGE;
+    }
+    BENCH("darray_heap_update (" STRINGIFY(UPDATES) " changes)",
+            for (size_t i = 0; i < UPDATES; i++) {
+                task *t = waiting + picks[i];
+                t->priority = rand();
+                darray_heap_update(queue, t->pos, task_cmp, task_track);
+            });
+    del_darray(queue);
+
+    free(picks);
+    free(arriving);
+    free(waiting);
+
+    return resort_total != heap_total;
+}
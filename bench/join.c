@@ -0,0 +1,152 @@
+/*!
+\file join.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares joining students with their enrollments by nested searches, by a
+secondary index, by `darray_hash_join` and by `darray_merge_join`.
+
+Nested searches take O(n * m) time, so they are only run for a small number of
+enrollments. The merge join is timed apart from sorting its inputs.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../darray.h"
+#include "bench.h"
+
+//! The number of students.
+#define STUDENTS 1000000
+
+//! The number of enrollments.
+#define ENROLLMENTS 1000000
+
+//! The number of enrollments joined by nested searches.
+#define SMALL 200
+
+typedef struct {
+    size_t id;
+    char name[32];
+    unsigned char score;
+} student;
+
+typedef struct {
+    size_t student_id;
+    unsigned course;
+} enrollment;
+
+//! Represents the pairs seen by `count_pair`.
+typedef struct {
+    size_t pairs;
+    unsigned long long checksum;
+} join_count;
+
+void *student_id(const void *p) {
+    return (void *) &((const student *) p)->id;
+}
+
+void *enrollment_student(const void *p) {
+    return (void *) &((const enrollment *) p)->student_id;
+}
+
+uint64_t student_key(const void *p) {
+    return ((const student *) p)->id;
+}
+
+uint64_t enrollment_key(const void *p) {
+    return ((const enrollment *) p)->student_id;
+}
+
+size_t id_hash(const void *p) {
+    return *((const size_t *) p) * 11400714819323198485u;
+}
+
+int id_cmp(const void *p1, const void *p2) {
+    size_t id1 = *((const size_t *) p1), id2 = *((const size_t *) p2);
+    return (id1 > id2) - (id1 < id2);
+}
+
+int has_id(const void *p, void *ctx) {
+    return ((const student *) p)->id == *((const size_t *) ctx);
+}
+
+void count_pair(void *p1, void *p2, void *ctx) {
+    join_count *count = ctx;
+    count->pairs++;
+    count->checksum += ((student *) p1)->score * ((enrollment *) p2)->course;
+}
+
+int main() {
+    srand(1);
+    darray *students = new_darray(free);
+    for (size_t i = 0; i < STUDENTS; i++) {
+        student *stu = malloc(sizeof(student));
+        stu->id = i;
+        memset(stu->name, 0, sizeof(stu->name));
+        stu->score = rand() % 101;
+        darray_append(students, stu);
+    }
+    void **item_ptr_arr = darray_data(students);
+    for (size_t i = STUDENTS - 1; i > 0; i--) {
+        size_t j = (size_t) rand() % (i + 1);
+        void *tmp = item_ptr_arr[i];
+        item_ptr_arr[i] = item_ptr_arr[j];
+        item_ptr_arr[j] = tmp;
+    }
+    darray *enrollments = new_darray(free);
+    for (size_t i = 0; i < ENROLLMENTS; i++) {
+        enrollment *enr = malloc(sizeof(enrollment));
+        enr->student_id = (size_t) rand() % STUDENTS;
+        enr->course = rand() % 1000;
+        darray_append(enrollments, enr);
+    }
+
+    join_count nested = {0, 0};
+    BENCH("darray_search_r (" STRINGIFY(SMALL) " enrollments)",
+            for (size_t i = 0; i < SMALL; i++) {
+                enrollment *enr = darray_get(enrollments, i);
+                size_t idx;
+                if (darray_search_r(students, has_id, &enr->student_id,
+                                    &idx)) {
+                    count_pair(darray_get(students, idx), enr, &nested);
+                }
+            });
+
+    join_count indexed = {0, 0};
+    BENCH("darray_index_search",
+            darray_index *by_id = new_darray_index(
+                students, student_id, id_hash, id_cmp);
+            for (size_t i = 0; i < ENROLLMENTS; i++) {
+                enrollment *enr = darray_get(enrollments, i);
+                size_t idx;
+                if (darray_index_search(by_id, &enr->student_id, &idx)) {
+                    count_pair(darray_get(students, idx), enr, &indexed);
+                }
+            }
+            del_darray_index(by_id));
+
+    join_count hashed = {0, 0};
+    BENCH("darray_hash_join",
+            darray_hash_join(students, enrollments, student_id,
+                             enrollment_student, id_hash, id_cmp, count_pair,
+                             &hashed));
+
+    BENCH("darray_sort_by_key (both)",
+            darray_sort_by_key(students, student_key);
+            darray_sort_by_key(enrollments, enrollment_key));
+    join_count merged = {0, 0};
+    BENCH("darray_merge_join",
+            darray_merge_join(students, enrollments, student_id,
+                              enrollment_student, id_cmp, count_pair,
+                              &merged));
+
+    del_darray(enrollments);
+    del_darray(students);
+
+    return nested.pairs != SMALL || indexed.pairs != ENROLLMENTS ||
+        hashed.pairs != ENROLLMENTS || merged.pairs != ENROLLMENTS ||
+        hashed.checksum != indexed.checksum ||
+        merged.checksum != indexed.checksum;
+}
@@ -0,0 +1,91 @@
+/*!
+\file kernels.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares the dense matrix kernels against naive loops.
+
+The matrix sizes are given as arguments and default to 1024, 2048 and 4096. The
+naive matrix product is timed at every size, so the largest default takes a few
+minutes.
+*/
+
+#include <stdlib.h>
+
+#include "../dmatrix.h"
+#include "bench.h"
+
+//! Multiplies two square matrices with the textbook triple loop.
+void naive_mul(const double *a, const double *b, double *c, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            double sum = 0;
+            for (size_t k = 0; k < n; k++) {
+                sum += a[i * n + k] * b[k * n + j];
+            }
+            c[i * n + j] = sum;
+        }
+    }
+}
+
+dmatrix *random_dmatrix(size_t n) {
+    dmatrix *mat = new_dmatrix(sizeof(double), n, n);
+    for (size_t i = 0; i < n; i++) {
+        double *row = dmatrix_row(mat, i);
+        for (size_t j = 0; j < n; j++) {
+            row[j] = (double) rand() / RAND_MAX;
+        }
+    }
+
+    return mat;
+}
+
+void run(size_t n) {
+    double flop = 2.0 * n * n * n;
+    dmatrix *a = random_dmatrix(n);
+    dmatrix *b = random_dmatrix(n);
+    printf("n = %zu\n", n);
+
+    double *naive = malloc(sizeof(double) * n * n);
+    double start = bench_now();
+    naive_mul(dmatrix_row(a, 0), dmatrix_row(b, 0), naive, n);
+    double naive_rate = flop / (bench_now() - start) * 1e-9;
+    printf("%-40s %10.2f GFLOP/s\n", "naive triple loop", naive_rate);
+    free(naive);
+
+    start = bench_now();
+    dmatrix *c = dmatrix_mul_double(a, b);
+    double rate = flop / (bench_now() - start) * 1e-9;
+    printf("%-40s %10.2f GFLOP/s %6.1fx\n", "dmatrix_mul_double", rate,
+           rate / naive_rate);
+    del_dmatrix(c);
+
+    dmatrix *t;
+    BENCH("dmatrix_transpose", t = dmatrix_transpose(a));
+    del_dmatrix(t);
+
+    double *vec = calloc(n, sizeof(double));
+    double *out = malloc(sizeof(double) * n);
+    BENCH("dmatrix_mul_vec_double", dmatrix_mul_vec_double(a, vec, out));
+    free(vec);
+    free(out);
+
+    del_dmatrix(a);
+    del_dmatrix(b);
+}
+
+int main(int argc, char *argv[]) {
+    srand(42);
+
+    if (argc < 2) {
+        run(1024);
+        run(2048);
+        run(4096);
+    }
+    for (int i = 1; i < argc; i++) {
+        run((size_t) strtoul(argv[i], NULL, 10));
+    }
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+/*!
+\file matrix.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares finding the maximum of a matrix stored as nested dynamic arrays against
+a dense matrix.
+*/
+
+#include <limits.h>
+#include <stdlib.h>
+
+#include "../darray.h"
+#include "../dmatrix.h"
+#include "bench.h"
+
+//! The number of rows and columns in the matrix.
+#define N 4096
+
+int *new_int(int x) {
+    int *p = (int *) malloc(sizeof(int));
+    *p = x;
+
+    return p;
+}
+
+void int_max(const void *p1, void *p2) {
+    const int *item = p1;
+    int *resp = p2;
+    if (*item > *resp) {
+        *resp = *item;
+    }
+}
+
+void array_max(const void *p1, void *p2) {
+    darray_aggregate((darray *) p1, p2, int_max);
+}
+
+void int_max_tile(const void *tile_ptr,
+                  size_t rows, size_t cols, size_t stride, void *resp) {
+    const int *row = tile_ptr;
+    int max = *((int *) resp);
+    for (size_t i = 0; i < rows; i++, row += stride) {
+        for (size_t j = 0; j < cols; j++) {
+            max = row[j] > max ? row[j] : max;
+        }
+    }
+    *((int *) resp) = max;
+}
+
+int main() {
+    srand(42);
+
+    darray *nested = new_darray((consumer) del_darray);
+    dmatrix *dense = new_dmatrix(sizeof(int), N, N);
+    for (int i = 0; i < N; i++) {
+        darray *row = new_darray(free);
+        for (int j = 0; j < N; j++) {
+            int num = rand();
+            darray_append(row, new_int(num));
+            *((int *) dmatrix_get(dense, i, j)) = num;
+        }
+        darray_append(nested, row);
+    }
+
+    int max1 = INT_MIN, max2 = INT_MIN, max3 = INT_MIN;
+    BENCH("nested darray_aggregate", darray_aggregate(nested, &max1, array_max));
+    BENCH("dmatrix_aggregate", dmatrix_aggregate(dense, &max2, int_max));
+    BENCH("dmatrix_aggregate_tiles (256 x 256)",
+            dmatrix_aggregate_tiles(dense, 256, 256, &max3, int_max_tile));
+    if (max1 != max2 || max2 != max3) {
+        fprintf(stderr, "results differ: %d %d %d\n", max1, max2, max3);
+    }
+
+    del_darray(nested);
+    del_dmatrix(dense);
+
+    return 0;
+}
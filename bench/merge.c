@@ -0,0 +1,90 @@
+/*!
+\file merge.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares `darray_extend` followed by `darray_sort` against `darray_merge`, and
+measures set operations between a large array and a small one.
+
+The arrays are kept small for the sort since `darray_sort` picks the last item
+as the pivot, which is slow on runs that are already sorted.
+*/
+
+#include <stdlib.h>
+
+#include "../darray.h"
+#include "bench.h"
+
+//! The number of items in each array that is sorted.
+#define SMALL 10000
+
+//! The number of items in the large array.
+#define LARGE 10000000
+
+//! The number of items in the array that is skewed against the large one.
+#define SKEWED 100
+
+int int_cmp(const void *p1, const void *p2) {
+    int a = *(const int *) p1, b = *(const int *) p2;
+    return (a > b) - (a < b);
+}
+
+//! Returns a new sorted array of `n` multiples of `step` plus `offset`.
+darray *new_multiples(int *ints, size_t n, int step, int offset) {
+    darray *array = new_darray(NULL);
+    for (size_t i = 0; i < n; i++) {
+        ints[i] = (int) i * step + offset;
+        darray_append(array, ints + i);
+    }
+    return array;
+}
+
+int main() {
+    int *evens = malloc(sizeof(int) * LARGE);
+    int *odds = malloc(sizeof(int) * LARGE);
+    int *sparse = malloc(sizeof(int) * SKEWED);
+
+    darray *array1 = new_multiples(evens, SMALL, 2, 0);
+    darray *array2 = new_multiples(odds, SMALL, 2, 1);
+    BENCH("darray_extend + darray_sort (" STRINGIFY(SMALL) ")",
+            darray_extend(array1, array2); darray_sort(array1, int_cmp));
+    del_darray(array1);
+    array1 = new_multiples(evens, SMALL, 2, 0);
+    BENCH("darray_merge (" STRINGIFY(SMALL) ")",
+            darray_merge(array1, array2, int_cmp));
+    del_darray(array1);
+    del_darray(array2);
+
+    array1 = new_multiples(evens, LARGE, 2, 0);
+    array2 = new_multiples(odds, LARGE, 2, 1);
+    BENCH("darray_merge (" STRINGIFY(LARGE) ", interleaved)",
+            darray_merge(array1, array2, int_cmp));
+    del_darray(array1);
+    del_darray(array2);
+
+    array1 = new_multiples(evens, LARGE, 2, 0);
+    array2 = new_multiples(sparse, SKEWED, LARGE / SKEWED * 2, 0);
+    darray *result;
+    BENCH("darray_set_intersection (" STRINGIFY(SKEWED) " in "
+            STRINGIFY(LARGE) ")",
+            result = darray_set_intersection(array2, array1, int_cmp));
+    int failed = darray_len(result) != SKEWED;
+    del_darray(result);
+    BENCH("darray_set_difference (" STRINGIFY(LARGE) " minus "
+            STRINGIFY(SKEWED) ")",
+            result = darray_set_difference(array1, array2, int_cmp));
+    failed |= darray_len(result) != LARGE - SKEWED;
+    del_darray(result);
+    BENCH("darray_merge (" STRINGIFY(SKEWED) " into " STRINGIFY(LARGE) ")",
+            darray_merge(array1, array2, int_cmp));
+    failed |= darray_len(array1) != LARGE + SKEWED;
+    del_darray(array1);
+    del_darray(array2);
+
+    free(sparse);
+    free(odds);
+    free(evens);
+
+    return failed;
+}
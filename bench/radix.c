@@ -0,0 +1,77 @@
+/*!
+\file radix.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares the comparator sort against the radix sort on an integer key.
+
+The records mimic those in the student demonstration, with shuffled ids.
+*/
+
+#include <stdlib.h>
+
+#include "../darray.h"
+#include "bench.h"
+
+//! The number of records in the array.
+#define N 2000000
+
+typedef struct {
+    size_t id;
+    char name[32];
+    unsigned char score;
+} record;
+
+int record_cmp_id(const void *p1, const void *p2) {
+    const record *rec1 = p1;
+    const record *rec2 = p2;
+
+    return (rec1->id > rec2->id) - (rec1->id < rec2->id);
+}
+
+uint64_t record_id(const void *p) {
+    return ((const record *) p)->id;
+}
+
+void *shallow_cpy(const void *p) {
+    return (void *) p;
+}
+
+darray *shallow_clone(darray *array) {
+    darray *clone = darray_clone(array, shallow_cpy);
+    darray_set_item_free(clone, NULL);
+
+    return clone;
+}
+
+int main() {
+    srand(42);
+
+    darray *records = new_darray(free);
+    for (size_t i = 0; i < N; i++) {
+        record *rec = calloc(1, sizeof(record));
+        rec->id = i;
+        darray_append(records, rec);
+    }
+    for (size_t i = N - 1; i > 0; i--) {
+        size_t j = (size_t) rand() % (i + 1);
+        record *rec1 = darray_get(records, i);
+        record *rec2 = darray_get(records, j);
+        size_t id = rec1->id;
+        rec1->id = rec2->id;
+        rec2->id = id;
+    }
+
+    darray *clone = shallow_clone(records);
+    BENCH("darray_sort", darray_sort(clone, record_cmp_id));
+    del_darray(clone);
+
+    clone = shallow_clone(records);
+    BENCH("darray_sort_by_key", darray_sort_by_key(clone, record_id));
+    del_darray(clone);
+
+    del_darray(records);
+
+    return 0;
+}
@@ -0,0 +1,64 @@
+/*!
+\file segment.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares the tail latency of appending to a dynamic array and to a segmented
+array.
+
+Every append is timed on its own. Growing a dynamic array reallocates its
+pointer array, which may copy every slot, while growing a segmented array only
+allocates a new block.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../darray.h"
+#include "../dseg.h"
+#include "bench.h"
+
+//! The number of items to append.
+#define N 16000000
+
+int double_cmp(const void *p1, const void *p2) {
+    double x = *((const double *) p1);
+    double y = *((const double *) p2);
+
+    return (x > y) - (x < y);
+}
+
+//! Prints percentiles of the latencies in nanoseconds.
+void report(const char *label, double *latency_arr) {
+    qsort(latency_arr, N, sizeof(double), double_cmp);
+    printf("%-14s p50 %6.0f ns  p99 %6.0f ns  p99.9 %6.0f ns  max %10.0f ns\n",
+           label, latency_arr[N / 2] * 1e9, latency_arr[N / 100 * 99] * 1e9,
+           latency_arr[N / 1000 * 999] * 1e9, latency_arr[N - 1] * 1e9);
+}
+
+int main() {
+    double *latency_arr = malloc(sizeof(double) * N);
+
+    darray *array = new_darray(NULL);
+    for (uintptr_t i = 0; i < N; i++) {
+        double start = bench_now();
+        darray_append(array, (void *) (i + 1));
+        latency_arr[i] = bench_now() - start;
+    }
+    report("darray_append", latency_arr);
+    del_darray(array);
+
+    dseg *seg = new_dseg(NULL);
+    for (uintptr_t i = 0; i < N; i++) {
+        double start = bench_now();
+        dseg_append(seg, (void *) (i + 1));
+        latency_arr[i] = bench_now() - start;
+    }
+    report("dseg_append", latency_arr);
+    del_dseg(seg);
+
+    free(latency_arr);
+
+    return 0;
+}
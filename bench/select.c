@@ -0,0 +1,77 @@
+/*!
+\file select.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares a full sort against selection of the smallest few items.
+
+Each function runs on a fresh shallow clone of the same random array.
+*/
+
+#include <stdlib.h>
+
+#include "../darray.h"
+#include "bench.h"
+
+//! The number of items in the array.
+#define N 2000000
+//! The number of items to select.
+#define K 100
+
+int *new_int(int x) {
+    int *p = (int *) malloc(sizeof(int));
+    *p = x;
+
+    return p;
+}
+
+int int_cmp(const void *p1, const void *p2) {
+    int x = *((const int *) p1);
+    int y = *((const int *) p2);
+
+    return (x > y) - (x < y);
+}
+
+void *shallow_cpy(const void *p) {
+    return (void *) p;
+}
+
+darray *shallow_clone(darray *array) {
+    darray *clone = darray_clone(array, shallow_cpy);
+    darray_set_item_free(clone, NULL);
+
+    return clone;
+}
+
+int main() {
+    srand(42);
+
+    darray *numbers = new_darray(free);
+    for (int i = 0; i < N; i++) {
+        darray_append(numbers, new_int(rand()));
+    }
+
+    darray *clone = shallow_clone(numbers);
+    BENCH("darray_sort", darray_sort(clone, int_cmp));
+    del_darray(clone);
+
+    clone = shallow_clone(numbers);
+    BENCH("darray_partial_sort (k = " STRINGIFY(K) ")",
+            darray_partial_sort(clone, K, int_cmp));
+    del_darray(clone);
+
+    clone = shallow_clone(numbers);
+    BENCH("darray_nth_element (median)",
+            darray_nth_element(clone, N / 2, int_cmp));
+    del_darray(clone);
+
+    darray *top;
+    BENCH("darray_top_k (k = " STRINGIFY(K) ")",
+            top = darray_top_k(numbers, K, int_cmp));
+    del_darray(top);
+
+    del_darray(numbers);
+
+    return 0;
+}
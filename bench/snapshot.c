@@ -0,0 +1,58 @@
+/*!
+\file snapshot.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares an eager clone against a copy-on-write clone used as a snapshot.
+
+The snapshot is only read, so the copy-on-write clone never copies.
+*/
+
+#include <stdlib.h>
+
+#include "../darray.h"
+#include "bench.h"
+
+//! The number of items in the array.
+#define N 10000000
+
+void *shallow_cpy(const void *p) {
+    return (void *) p;
+}
+
+void int_sum(const void *p, void *resp) {
+    *((long long *) resp) += *((const int *) p);
+}
+
+int main() {
+    darray *numbers = new_darray(free);
+    for (int i = 0; i < N; i++) {
+        int *p = (int *) malloc(sizeof(int));
+        *p = i;
+        darray_append(numbers, p);
+    }
+
+    darray *snapshot;
+    long long sum = 0;
+    BENCH("darray_clone", snapshot = darray_clone(numbers, shallow_cpy));
+    darray_set_item_free(snapshot, NULL);
+    darray_aggregate(snapshot, &sum, int_sum);
+    BENCH("del_darray (clone)", del_darray(snapshot));
+
+    BENCH("darray_clone_cow",
+            snapshot = darray_clone_cow(numbers, shallow_cpy));
+    darray_set_item_free(snapshot, NULL);
+    darray_aggregate(snapshot, &sum, int_sum);
+    BENCH("del_darray (copy-on-write clone)", del_darray(snapshot));
+
+    snapshot = darray_clone_cow(numbers, shallow_cpy);
+    darray_set_item_free(snapshot, NULL);
+    BENCH("darray_append (first write after sharing)",
+            darray_append(numbers, malloc(sizeof(int))));
+    del_darray(snapshot);
+
+    del_darray(numbers);
+
+    return sum != 2 * ((long long) N * (N - 1) / 2);
+}
@@ -0,0 +1,108 @@
+/*!
+\file stream.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares a fused stream against the same pipeline built from materialized
+arrays.
+
+The pipeline takes the score of each record, keeps the even scores and maps each
+of them to a newly allocated doubled score.
+*/
+
+#include <stdlib.h>
+
+#include "../darray.h"
+#include "bench.h"
+
+//! The number of records in the array.
+#define N 10000000
+//! The number of threads of the parallel stream.
+#define THREADS 4
+
+struct record {
+    int id;
+    int score;
+};
+
+void *record_score(const void *p) {
+    return (void *) &((const struct record *) p)->score;
+}
+
+int is_even(const void *p) {
+    return *((const int *) p) % 2 == 0;
+}
+
+void *new_doubled(const void *p) {
+    int *doubled = (int *) malloc(sizeof(int));
+    *doubled = *((const int *) p) * 2;
+
+    return doubled;
+}
+
+void int_sum(const void *p, void *resp) {
+    *((long long *) resp) += *((const int *) p);
+}
+
+darray *materialized(darray *records) {
+    darray *scores = darray_clone(records, record_score);
+    darray_set_item_free(scores, NULL);
+
+    darray *even = new_darray(NULL);
+    for (size_t i = 0; i < darray_len(scores); i++) {
+        int *score = darray_get(scores, i);
+        if (is_even(score)) {
+            darray_append(even, score);
+        }
+    }
+    del_darray(scores);
+
+    darray *doubled = darray_clone(even, new_doubled);
+    darray_set_item_free(doubled, free);
+    del_darray(even);
+
+    return doubled;
+}
+
+darray_stream *pipeline(darray *records) {
+    darray_stream *stream = new_darray_stream(records);
+    darray_stream_map(stream, record_score, NULL);
+    darray_stream_filter(stream, is_even);
+    darray_stream_map(stream, new_doubled, free);
+
+    return stream;
+}
+
+int main() {
+    srand(42);
+
+    darray *records = new_darray(free);
+    for (int i = 0; i < N; i++) {
+        struct record *record = malloc(sizeof(struct record));
+        record->id = i;
+        record->score = rand() % 100;
+        darray_append(records, record);
+    }
+
+    darray *res;
+    long long sum = 0;
+    BENCH("materialized collect", res = materialized(records));
+    BENCH("materialized aggregate", darray_aggregate(res, &sum, int_sum));
+    del_darray(res);
+
+    darray_stream *stream = pipeline(records);
+    BENCH("stream collect", res = darray_stream_collect(stream));
+    del_darray(res);
+    sum = 0;
+    BENCH("stream aggregate", darray_stream_aggregate(stream, &sum, int_sum));
+    darray_stream_set_threads(stream, THREADS);
+    BENCH("stream collect (" STRINGIFY(THREADS) " threads)",
+            res = darray_stream_collect(stream));
+    del_darray(res);
+    del_darray_stream(stream);
+
+    del_darray(records);
+
+    return 0;
+}
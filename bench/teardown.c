@@ -0,0 +1,74 @@
+/*!
+\file teardown.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares ways to deallocate an array of many small items.
+
+The bulk free function returns the items to the pool they were carved from in a
+single step, where the per item free function can only count them. The deferred
+deletion is timed on the calling thread only.
+*/
+
+#include <stdlib.h>
+
+#include "../darray.h"
+#include "bench.h"
+
+//! The number of items in the array.
+#define N 5000000
+
+darray *new_ints(void) {
+    darray *numbers = new_darray(free);
+    for (int i = 0; i < N; i++) {
+        int *p = (int *) malloc(sizeof(int));
+        *p = i;
+        darray_append(numbers, p);
+    }
+
+    return numbers;
+}
+
+//! The number of items handed back to the pool.
+size_t pool_returned;
+
+void pool_free(void *p) {
+    (void) p;
+    pool_returned++;
+}
+
+void pool_bulk_free(void **item_ptr_arr, size_t n) {
+    (void) item_ptr_arr;
+    pool_returned += n;
+}
+
+darray *new_pooled(int *pool) {
+    darray *numbers = new_darray(pool_free);
+    for (int i = 0; i < N; i++) {
+        pool[i] = i;
+        darray_append(numbers, pool + i);
+    }
+
+    return numbers;
+}
+
+int main() {
+    darray *numbers = new_ints();
+    BENCH("del_darray (free)", del_darray(numbers));
+
+    numbers = new_ints();
+    BENCH("del_darray_deferred (free, caller)", del_darray_deferred(numbers));
+    BENCH("darray_reclaim_wait", darray_reclaim_wait());
+
+    int *pool = (int *) malloc(sizeof(int) * N);
+    numbers = new_pooled(pool);
+    BENCH("del_darray (pool, per item)", del_darray(numbers));
+
+    numbers = new_pooled(pool);
+    darray_set_bulk_free(numbers, pool_bulk_free);
+    BENCH("del_darray (pool, bulk)", del_darray(numbers));
+    free(pool);
+
+    return pool_returned != 2 * (size_t) N;
+}
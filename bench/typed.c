@@ -0,0 +1,58 @@
+/*!
+\file typed.c
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares a dynamic array of pointers to doubles, summed and sorted through
+function pointers, against a value array from the `_Generic` front-end.
+
+The value array is measured first, since freeing millions of small items leaves
+the allocator busy merging free chunks on the next large allocation.
+*/
+
+#include <stdlib.h>
+
+#include "../darray.h"
+#include "../util/dtyped.h"
+#include "bench.h"
+
+//! The number of values in each array.
+#define N 10000000
+
+MAKE_DTYPE_DOUBLE()
+
+void add_double(const void *p, void *resp) {
+    *((double *) resp) += *((const double *) p);
+}
+
+int main() {
+    srand(1);
+    double_array *values = new_double_array();
+    BENCH("dtyped_push (double_array)",
+            for (int i = 0; i < N; i++) {
+                dtyped_push(values, rand() / (double) RAND_MAX);
+            });
+    double value_sum = 0;
+    BENCH("dtyped_sum (double_array)", value_sum = dtyped_sum(values));
+    BENCH("dtyped_sort (double_array)", dtyped_sort(values));
+    int sorted = 1;
+    for (size_t i = 1; i < dtyped_len(values); i++) {
+        sorted &= dtyped_get(values, i - 1) <= dtyped_get(values, i);
+    }
+    del_double_array(values);
+
+    srand(1);
+    darray *pointers = new_darray(free);
+    BENCH("darray_append (new_double)",
+            for (int i = 0; i < N; i++) {
+                darray_append(pointers, new_double(rand() / (double) RAND_MAX));
+            });
+    double pointer_sum = 0;
+    BENCH("darray_aggregate (sum)",
+            darray_aggregate(pointers, &pointer_sum, add_double));
+    BENCH("darray_sort (double_cmp)", darray_sort(pointers, double_cmp));
+    del_darray(pointers);
+
+    return !sorted || pointer_sum != value_sum;
+}
@@ -0,0 +1,57 @@
+/*!
+\file wrapper.cpp
+\author Edward Ji
+\date 19 Oct 2026
+
+\brief
+Compares sorting with `darray_sort` against the standard algorithms on the
+iterators of the C++ wrapper.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <execution>
+
+#include "../darray.hpp"
+#include "bench.h"
+
+//! The number of items in the array.
+#define N 5000000
+
+int int_cmp(const void *p1, const void *p2) {
+    int a = *static_cast<const int *>(p1), b = *static_cast<const int *>(p2);
+    return (a > b) - (a < b);
+}
+
+//! Returns a new array of the same random integers every time.
+DArray<int> random_ints() {
+    DArray<int> numbers;
+    std::srand(1);
+    for (int i = 0; i < N; i++) {
+        numbers.emplace_back(std::rand());
+    }
+    return numbers;
+}
+
+int main() {
+    DArray<int> numbers = random_ints();
+    BENCH("darray_sort", darray_sort(numbers.get(), int_cmp));
+    bool sorted = std::is_sorted(numbers.begin(), numbers.end());
+
+    numbers = random_ints();
+    BENCH("std::sort", std::sort(numbers.begin(), numbers.end()));
+    sorted = sorted && std::is_sorted(numbers.begin(), numbers.end());
+
+    numbers = random_ints();
+    BENCH("std::sort (std::execution::par)",
+            std::sort(std::execution::par, numbers.begin(), numbers.end()));
+    sorted = sorted && std::is_sorted(numbers.begin(), numbers.end());
+
+    long long sum = 0;
+    BENCH("range-based for (sum)",
+            for (int number : numbers) {
+                sum += number;
+            });
+
+    return !sorted || sum == 0;
+}
@@ -9,9 +9,29 @@ definition in the header file. The documentation in this source file is targeted
 to maintainers.
 */
 
+#if defined(__linux__) && !defined(DARRAY_NO_MMAP)
+#define _GNU_SOURCE
+#define DARRAY_MMAP
+#endif
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <pthread.h>
+
+#ifdef DARRAY_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifndef DARRAY_MMAP_THRESHOLD
+//! The default size in bytes from which pointer arrays are mapped.
+#define DARRAY_MMAP_THRESHOLD ((size_t) 4 << 20)
+#endif
+
 #include "darray.h"
 
 //! Represents a dynamic array structure.
@@ -20,28 +40,356 @@ struct darray {
     void **item_ptr_arr;
     /*! Points to a function that frees an item in the array. */
     consumer item_free;
+    /*! Points to a function that frees a range of items in the array. */
+    bulk_consumer bulk_free;
     /*! The number of items stored in the array. */
     size_t len;
     /*! The current capacity of the array. */
     size_t cap;
+    /*! The number of pointers the anonymous mapping backing the pointer array
+    can hold, or 0 if the pointer array is allocated with `malloc`. */
+    size_t map_cap;
+    /*! Points to the first secondary index attached to the array. */
+    darray_index *index;
+    /*! Points to the first ordered view attached to the array. */
+    darray_view *view;
+    /*! Points to the share of the pointer array with copy-on-write clones, or
+    `NULL` if the array has its own pointer array. */
+    struct darray_share *share;
+#ifdef DARRAY_STATS
+    /*! The operation counters of the array. */
+    darray_stat stat;
+#endif
+#ifdef DARRAY_REGISTRY
+    /*! Points to the previous live array in the registry. */
+    darray *prev;
+    /*! Points to the next live array in the registry. */
+    darray *next;
+    /*! The length of the array as of its last resize, for other threads. */
+    _Atomic size_t reg_len;
+    /*! The capacity of the array as of its last resize, for other threads. */
+    _Atomic size_t reg_cap;
+#endif
+};
+
+//! Represents a pointer array shared by copy-on-write clones.
+/*!
+The items in a shared pointer array belong to the arrays sharing it. An array
+that is about to be modified stops sharing by copying the items into its own
+pointer array, and the last array left takes over the shared pointer array along
+with its items.
+*/
+struct darray_share {
+    /*! The number of arrays sharing the pointer array. */
+    size_t refs;
+    /*! Points to the function that copies an item for an array that stops
+    sharing. */
+    unary copy;
+};
+
+//! Represents a slot in the hash table of a secondary index.
+struct index_slot {
+    /*! The hash of the key of the item, cached to avoid rehashing. */
+    size_t hash;
+    /*! The index of the item in the array, `SIZE_MAX` if the slot is empty. */
+    size_t idx;
+};
+
+//! Represents a secondary hash index over a dynamic array.
+/*!
+The hash table uses open addressing with linear probing. It is kept up to date
+when items are added to or removed from the end of the array. Any other
+operation that moves items marks the index as stale, and it is rebuilt on the
+next search.
+*/
+struct darray_index {
+    /*! Points to the indexed array. */
+    darray *array;
+    /*! Points to a function that extracts the key of an item. */
+    unary key;
+    /*! Points to a function that hashes a key. */
+    hasher hash;
+    /*! Points to a function that compares two keys. */
+    comparator cmp;
+    /*! Points to an allocated array of slots. */
+    struct index_slot *slot_arr;
+    /*! The number of occupied slots. */
+    size_t len;
+    /*! The number of slots, which is zero or a power of two. */
+    size_t cap;
+    /*! Non-zero if the slots no longer reflect the array. */
+    int stale;
+    /*! Points to the next index attached to the same array. */
+    darray_index *next;
+};
+
+//! Represents an ordered view of a dynamic array.
+/*!
+The view stores the positions of the items in the array, ordered by a
+comparator. Positions are 32-bit unless the array is too long for them, which
+makes the view half the size of a shallow clone on 64-bit machines.
+*/
+struct darray_view {
+    /*! Points to the viewed array. */
+    darray *array;
+    /*! Points to a function that compares two items in the array. */
+    comparator cmp;
+    /*! Points to an allocated array of positions, sorted by the comparator. */
+    union {
+        uint32_t *narrow;
+        size_t *wide;
+    } pos;
+    /*! Non-zero if the positions are of type `size_t`. */
+    int wide;
+    /*! The number of positions stored in the view. */
+    size_t len;
+    /*! The current capacity of the view. */
+    size_t cap;
+    /*! Non-zero if the positions no longer reflect the array. */
+    int stale;
+    /*! Points to the next view attached to the same array. */
+    darray_view *next;
 };
 
 const size_t sizeof_darray = sizeof(darray);
 
 darray_error darray_errno;
 
+/*
+Static tracepoints for perf and bpftrace, under the provider `darray`:
+
+- `resize__begin` and `resize__end` with the old and new capacity;
+- `sort__start` and `sort__end` with the length of the array;
+- `search` with the number of comparisons and whether the item was found;
+- `alloc__fail` when an allocation fails.
+
+They are compiled in if `<sys/sdt.h>` is available, unless `DARRAY_NO_PROBES`
+is defined, and cost a single `nop` each when not traced.
+*/
+#if defined(__has_include) && !defined(DARRAY_NO_PROBES)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+//! Fires a static tracepoint with no arguments.
+#define PROBE0(name) DTRACE_PROBE(darray, name)
+//! Fires a static tracepoint with one argument.
+#define PROBE1(name, a) DTRACE_PROBE1(darray, name, a)
+//! Fires a static tracepoint with two arguments.
+#define PROBE2(name, a, b) DTRACE_PROBE2(darray, name, a, b)
+#endif
+#endif
+#ifndef PROBE0
+#define PROBE0(name) ((void) 0)
+#define PROBE1(name, a) ((void) 0)
+#define PROBE2(name, a, b) ((void) 0)
+#endif
+
+#ifdef DARRAY_REGISTRY
+//! Points to the most recently created live array.
+static darray *registry_head;
+
+//! Guards the registry, which is shared between threads.
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+//! Publishes the length and capacity of an array to the registry.
+/*!
+The registry is read by other threads while the array changes, so it reads these
+copies rather than the fields of the array.
+*/
+static void registry_note(darray *array, size_t len) {
+    atomic_store_explicit(&array->reg_len, len, memory_order_relaxed);
+    atomic_store_explicit(&array->reg_cap, array->cap, memory_order_relaxed);
+}
+
+//! Adds a new array to the registry.
+static void registry_add(darray *array) {
+    registry_note(array, array->len);
+    pthread_mutex_lock(&registry_lock);
+    array->prev = NULL;
+    array->next = registry_head;
+    if (registry_head != NULL) {
+        registry_head->prev = array;
+    }
+    registry_head = array;
+    pthread_mutex_unlock(&registry_lock);
+}
+
+//! Removes an array about to be deallocated from the registry.
+static void registry_remove(darray *array) {
+    pthread_mutex_lock(&registry_lock);
+    if (array->prev != NULL) {
+        array->prev->next = array->next;
+    } else {
+        registry_head = array->next;
+    }
+    if (array->next != NULL) {
+        array->next->prev = array->prev;
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
+#else
+#define registry_note(array, len) ((void) 0)
+#define registry_add(array) ((void) 0)
+#define registry_remove(array) ((void) 0)
+#endif
+
+#ifdef DARRAY_STATS
+//! Represents the operation counters of all arrays combined.
+/*!
+Arrays used on different threads update these counters at the same time, so
+they are atomic.
+*/
+struct stat_global {
+    /*! The number of times the capacity changed. */
+    _Atomic size_t resizes;
+    /*! The number of bytes moved to close or open gaps in arrays. */
+    _Atomic size_t bytes_moved;
+    /*! The number of comparator calls. */
+    _Atomic size_t cmp_calls;
+    /*! The number of times a free function was called on an item. */
+    _Atomic size_t item_frees;
+    /*! The biggest capacity reached by any array. */
+    _Atomic size_t peak_cap;
+};
+
+//! The operation counters of all arrays combined.
+static struct stat_global darray_stat_global;
+
+//! Points to the comparator being counted by `stat_counting_cmp`.
+static _Thread_local comparator stat_cmp;
+
+//! The number of calls to `stat_counting_cmp` on this thread.
+static _Thread_local size_t stat_cmp_calls;
+
+//! Counts a call to the comparator in `stat_cmp` and forwards it.
+static int stat_counting_cmp(const void *item_ptr1, const void *item_ptr2) {
+    stat_cmp_calls++;
+    return stat_cmp(item_ptr1, item_ptr2);
+}
+
+//! Points to the context comparator being counted by `stat_counting_cmp_r`.
+static _Thread_local comparator_r stat_cmp_r;
+
+//! Counts a call to the comparator in `stat_cmp_r` and forwards it.
+static int stat_counting_cmp_r(const void *item_ptr1, const void *item_ptr2,
+                               void *ctx) {
+    stat_cmp_calls++;
+    return stat_cmp_r(item_ptr1, item_ptr2, ctx);
+}
+
+//! Adds to an operation counter of an array and the global one.
+#define STAT_ADD(array, field, n) do {                                         \
+    (array)->stat.field += (n);                                                \
+    atomic_fetch_add_explicit(&darray_stat_global.field, (n),                  \
+                              memory_order_relaxed);                           \
+} while (0)
+
+//! Raises the peak capacity counters of an array and the global one.
+#define STAT_PEAK(array, cap) do {                                             \
+    size_t stat_cap_ = (cap);                                                  \
+    if (stat_cap_ > (array)->stat.peak_cap) {                                  \
+        (array)->stat.peak_cap = stat_cap_;                                    \
+    }                                                                          \
+    size_t stat_peak_ = atomic_load_explicit(&darray_stat_global.peak_cap,     \
+                                             memory_order_relaxed);            \
+    while (stat_cap_ > stat_peak_ &&                                           \
+            !atomic_compare_exchange_weak_explicit(                            \
+                &darray_stat_global.peak_cap, &stat_peak_, stat_cap_,          \
+                memory_order_relaxed, memory_order_relaxed)) {                 \
+    }                                                                          \
+} while (0)
+
+//! Replaces a comparator with one that counts its calls.
+/*!
+Must be paired with `STAT_CMP_END` in the same block.
+*/
+#define STAT_CMP_BEGIN(fp)                                                     \
+    comparator stat_saved_cmp_ = stat_cmp;                                     \
+    size_t stat_saved_calls_ = stat_cmp_calls;                                 \
+    stat_cmp = (fp);                                                           \
+    (fp) = stat_counting_cmp
+
+//! Adds the counted comparator calls to an array and restores the comparator.
+#define STAT_CMP_END(array, fp) do {                                           \
+    STAT_ADD(array, cmp_calls, stat_cmp_calls - stat_saved_calls_);            \
+    (fp) = stat_cmp;                                                           \
+    stat_cmp = stat_saved_cmp_;                                                \
+} while (0)
+
+//! Replaces a context comparator with one that counts its calls.
+#define STAT_CMP_R_BEGIN(fp)                                                   \
+    comparator_r stat_saved_cmp_r_ = stat_cmp_r;                               \
+    size_t stat_saved_calls_ = stat_cmp_calls;                                 \
+    stat_cmp_r = (fp);                                                         \
+    (fp) = stat_counting_cmp_r
+
+//! Adds the counted context comparator calls and restores the comparator.
+#define STAT_CMP_R_END(array, fp) do {                                         \
+    STAT_ADD(array, cmp_calls, stat_cmp_calls - stat_saved_calls_);            \
+    (fp) = stat_cmp_r;                                                         \
+    stat_cmp_r = stat_saved_cmp_r_;                                            \
+} while (0)
+#else
+#define STAT_ADD(array, field, n) ((void) 0)
+#define STAT_PEAK(array, cap) ((void) 0)
+#define STAT_CMP_BEGIN(fp) ((void) 0)
+#define STAT_CMP_END(array, fp) ((void) 0)
+#define STAT_CMP_R_BEGIN(fp) ((void) 0)
+#define STAT_CMP_R_END(array, fp) ((void) 0)
+#endif
+
 darray *new_darray(consumer item_free) {
     darray *array = malloc(sizeof(darray));
     if (array != NULL) {
         array->item_free = item_free;
+        array->bulk_free = NULL;
         array->len = 0;
         array->cap = 1;
+        array->index = NULL;
+        array->view = NULL;
+        array->share = NULL;
+#ifdef DARRAY_STATS
+        memset(&array->stat, 0, sizeof(darray_stat));
+        STAT_PEAK(array, array->cap);
+#endif
         array->item_ptr_arr = malloc(sizeof(void *) * array->cap);
+        array->map_cap = 0;
         if (array->item_ptr_arr == NULL) {
             darray_errno = DARRAY_EALLOC;
+            PROBE0(alloc__fail);
             return NULL;
         }
+        registry_add(array);
+    }
+
+    return array;
+}
+
+darray *new_darray_from(consumer item_free, void **item_ptr_arr, size_t len) {
+    if (item_ptr_arr == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+
+    darray *array = malloc(sizeof(darray));
+    if (array == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
+        return NULL;
     }
+    array->item_free = item_free;
+    array->bulk_free = NULL;
+    array->len = len;
+    array->cap = len > 0 ? len : 1;
+    array->index = NULL;
+    array->view = NULL;
+    array->share = NULL;
+#ifdef DARRAY_STATS
+    memset(&array->stat, 0, sizeof(darray_stat));
+    STAT_PEAK(array, array->cap);
+#endif
+    array->item_ptr_arr = item_ptr_arr;
+    array->map_cap = 0;
+    registry_add(array);
 
     return array;
 }
@@ -57,6 +405,179 @@ int darray_set_item_free(darray *array, consumer item_free) {
     return 1;
 }
 
+int darray_set_bulk_free(darray *array, bulk_consumer bulk_free) {
+    if (array == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    array->bulk_free = bulk_free;
+
+    return 1;
+}
+
+//! Frees items with a bulk free function if any, or one by one otherwise.
+static void release_items(void **item_ptr_arr, size_t n,
+                          consumer item_free, bulk_consumer bulk_free) {
+    if (item_free == NULL || n == 0) {
+        return;
+    }
+    if (bulk_free != NULL) {
+        bulk_free(item_ptr_arr, n);
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            item_free(item_ptr_arr[i]);
+        }
+    }
+}
+
+//! Frees a range of items removed from an array.
+static void darray_free_items(darray *array, void **item_ptr_arr, size_t n) {
+    if (array->item_free != NULL) {
+        release_items(item_ptr_arr, n, array->item_free, array->bulk_free);
+        STAT_ADD(array, item_frees, n);
+    }
+}
+
+//! Stops an array from sharing its pointer array.
+/*!
+Returns 1 if the array held the last reference, in which case it keeps the
+pointer array and owns its items. Returns 0 if other arrays still share it, in
+which case the caller must not free the pointer array or its items.
+*/
+static int darray_release(darray *array) {
+    struct darray_share *share = array->share;
+    if (share == NULL) {
+        return 1;
+    }
+
+    array->share = NULL;
+    if (share->refs == 1) {
+        free(share);
+        return 1;
+    }
+    share->refs--;
+
+    return 0;
+}
+
+//! Gives an array its own pointer array before it is modified.
+/*!
+If other arrays share the pointer array, the items are copied into a new pointer
+array with the copy function of the share.
+*/
+static int darray_own(darray *array) {
+    if (array->share == NULL || array->share->refs == 1) {
+        darray_release(array);
+        return 1;
+    }
+
+    void **item_ptr_arr = malloc(sizeof(void *) * array->cap);
+    if (item_ptr_arr == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
+        return 0;
+    }
+    unary copy = array->share->copy;
+    for (size_t i = 0; i < array->len; i++) {
+        item_ptr_arr[i] = copy(array->item_ptr_arr[i]);
+    }
+    darray_release(array);
+    array->item_ptr_arr = item_ptr_arr;
+    array->map_cap = 0;
+
+    return 1;
+}
+
+#ifdef DARRAY_MMAP
+//! The size in bytes from which pointer arrays are backed by anonymous mappings.
+static size_t map_threshold = DARRAY_MMAP_THRESHOLD;
+#endif
+
+//! Frees a pointer array allocated by `resize_ptr_arr`.
+static void free_ptr_arr(void **item_ptr_arr, size_t map_cap) {
+#ifdef DARRAY_MMAP
+    if (map_cap > 0) {
+        munmap(item_ptr_arr, sizeof(void *) * map_cap);
+        return;
+    }
+#endif
+    free(item_ptr_arr);
+}
+
+//! Reallocates the pointer array of an array for a given capacity.
+/*!
+On Linux, pointer arrays of at least `map_threshold` bytes are backed by an
+anonymous mapping. The mapping grows with `mremap`, which moves page table
+entries instead of copying the pointers, and shrinks by handing the pages past
+the capacity back to the kernel with `madvise`, so growing again is free until
+it outgrows the mapping.
+
+\returns The new pointer array, or `NULL` if unsuccessful, in which case the
+old pointer array is left untouched.
+*/
+static void **resize_ptr_arr(darray *array, size_t cap) {
+    size_t size = sizeof(void *) * cap;
+#ifdef DARRAY_MMAP
+    size_t map_size = sizeof(void *) * array->map_cap;
+    if (size >= map_threshold) {
+        long page = sysconf(_SC_PAGESIZE);
+        size_t page_size = page > 0 ? (size_t) page : 4096;
+        size = (size + page_size - 1) / page_size * page_size;
+        if (size <= map_size) {
+            if (size < map_size) {
+                madvise((char *) array->item_ptr_arr + size, map_size - size,
+                        MADV_DONTNEED);
+            }
+            return array->item_ptr_arr;
+        }
+        void *item_ptr_arr;
+        if (array->map_cap > 0) {
+            item_ptr_arr = mremap(array->item_ptr_arr, map_size, size,
+                                  MREMAP_MAYMOVE);
+        } else {
+            item_ptr_arr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (item_ptr_arr != MAP_FAILED) {
+                memcpy(item_ptr_arr, array->item_ptr_arr,
+                       sizeof(void *) * array->len);
+                free(array->item_ptr_arr);
+            }
+        }
+        if (item_ptr_arr == MAP_FAILED) {
+            return NULL;
+        }
+#ifdef DARRAY_HUGEPAGES
+        madvise(item_ptr_arr, size, MADV_HUGEPAGE);
+#endif
+        array->map_cap = size / sizeof(void *);
+        return item_ptr_arr;
+    }
+    if (array->map_cap > 0) {
+        void **item_ptr_arr = malloc(size);
+        if (item_ptr_arr == NULL) {
+            return NULL;
+        }
+        memcpy(item_ptr_arr, array->item_ptr_arr,
+               sizeof(void *) * (array->len < cap ? array->len : cap));
+        munmap(array->item_ptr_arr, map_size);
+        array->map_cap = 0;
+        return item_ptr_arr;
+    }
+#endif
+    return realloc(array->item_ptr_arr, size);
+}
+
+int darray_set_map_threshold(size_t size) {
+#ifdef DARRAY_MMAP
+    map_threshold = size;
+#else
+    (void) size;
+#endif
+
+    return 1;
+}
+
 //! Changes the capacity of the dynamic array.
 /*!
 \param len The expected number of items stored in the array.
@@ -76,144 +597,579 @@ static int darray_resize(darray *array, size_t len) {
         }
     }
     if (cap != array->cap) {
-        item_ptr_arr = realloc(item_ptr_arr, sizeof(void *) * cap);
+        PROBE2(resize__begin, array->cap, cap);
+        item_ptr_arr = resize_ptr_arr(array, cap);
         if (item_ptr_arr == NULL) {
             darray_errno = DARRAY_EALLOC;
+            PROBE0(alloc__fail);
             return 0;
         }
+        PROBE2(resize__end, array->cap, cap);
         array->item_ptr_arr = item_ptr_arr;
         array->cap = cap;
+        STAT_ADD(array, resizes, 1);
+        STAT_PEAK(array, cap);
     }
+    registry_note(array, len);
 
     return array->cap != 0;
 }
 
-size_t darray_len(darray *array) {
-    if (array == NULL) {
-        return 0;
+//! Makes room for a given number of keys in a secondary index.
+/*!
+The table is kept at most half full. Existing slots are rehashed if the table
+grows.
+
+\param len The expected number of keys in the index.
+\returns 1 if successful, 0 otherwise.
+*/
+static int index_reserve(darray_index *index, size_t len) {
+    size_t cap = index->cap > 0 ? index->cap : 8;
+    while (len * 2 > cap) {
+        cap *= 2;
+    }
+    if (cap == index->cap) {
+        return 1;
     }
-    return array->len;
-}
 
-int darray_foreach(darray *array, consumer fp) {
-    if (array == NULL || fp == NULL) {
-        darray_errno = DARRAY_ENULLS;
+    struct index_slot *slot_arr = malloc(sizeof(struct index_slot) * cap);
+    if (slot_arr == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
         return 0;
     }
-
-    for (size_t i = 0; i < array->len; i++) {
-        fp(array->item_ptr_arr[i]);
+    for (size_t i = 0; i < cap; i++) {
+        slot_arr[i].idx = SIZE_MAX;
     }
+    for (size_t i = 0; i < index->cap; i++) {
+        struct index_slot slot = index->slot_arr[i];
+        if (slot.idx != SIZE_MAX) {
+            size_t j = slot.hash & (cap - 1);
+            while (slot_arr[j].idx != SIZE_MAX) {
+                j = (j + 1) & (cap - 1);
+            }
+            slot_arr[j] = slot;
+        }
+    }
+    free(index->slot_arr);
+    index->slot_arr = slot_arr;
+    index->cap = cap;
 
     return 1;
 }
 
-int darray_aggregate(darray *array, void *resp, aggregate fp) {
-    if (array == NULL || resp == NULL || fp == NULL) {
-        darray_errno = DARRAY_ENULLS;
+//! Adds the item at a given array index to a secondary index.
+static int index_put(darray_index *index, size_t idx) {
+    if (!index_reserve(index, index->len + 1)) {
         return 0;
     }
 
-    for (size_t i = 0; i < array->len; i++) {
-        fp(array->item_ptr_arr[i], resp);
+    size_t mask = index->cap - 1;
+    size_t hash = index->hash(index->key(index->array->item_ptr_arr[idx]));
+    size_t i = hash & mask;
+    while (index->slot_arr[i].idx != SIZE_MAX) {
+        i = (i + 1) & mask;
     }
+    index->slot_arr[i].hash = hash;
+    index->slot_arr[i].idx = idx;
+    index->len++;
 
     return 1;
 }
 
-int darray_append(darray *array, void *item_ptr) {
-    if (array == NULL || item_ptr == NULL) {
-        darray_errno = DARRAY_ENULLS;
-        return 0;
+//! Removes the item at a given array index from a secondary index.
+/*!
+The slots following the removed one are shifted back so that no tombstones are
+needed.
+*/
+static void index_remove(darray_index *index, size_t idx) {
+    size_t mask = index->cap - 1;
+    size_t hash = index->hash(index->key(index->array->item_ptr_arr[idx]));
+    size_t i = hash & mask;
+    while (index->slot_arr[i].idx != idx) {
+        if (index->slot_arr[i].idx == SIZE_MAX) {
+            return;
+        }
+        i = (i + 1) & mask;
     }
 
-    if (!darray_resize(array, array->len + 1)) {
-        return 0;
+    for (size_t j = i;;) {
+        j = (j + 1) & mask;
+        if (index->slot_arr[j].idx == SIZE_MAX) {
+            break;
+        }
+        size_t k = index->slot_arr[j].hash & mask;
+        if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) {
+            continue;
+        }
+        index->slot_arr[i] = index->slot_arr[j];
+        i = j;
     }
+    index->slot_arr[i].idx = SIZE_MAX;
+    index->len--;
+}
 
-    array->item_ptr_arr[array->len] = item_ptr;
-
-    array->len++;
+//! Rebuilds a stale secondary index from its array.
+static int index_rebuild(darray_index *index) {
+    if (!index_reserve(index, index->array->len)) {
+        return 0;
+    }
+    for (size_t i = 0; i < index->cap; i++) {
+        index->slot_arr[i].idx = SIZE_MAX;
+    }
+    index->len = 0;
+    for (size_t i = 0; i < index->array->len; i++) {
+        index_put(index, i);
+    }
+    index->stale = 0;
 
     return 1;
 }
 
-void *darray_get(darray *array, size_t index) {
-    if (array == NULL) {
-        darray_errno = DARRAY_ENULLS;
-        return NULL;
-    }
-    if (index >= array->len) {
-        darray_errno = DARRAY_EINDEX;
-        return NULL;
+//! Returns the position at a given rank in an ordered view.
+static size_t view_pos(const darray_view *view, size_t rank) {
+    return view->wide ? view->pos.wide[rank] : view->pos.narrow[rank];
+}
+
+//! Sets the position at a given rank in an ordered view.
+static void view_set(darray_view *view, size_t rank, size_t pos) {
+    if (view->wide) {
+        view->pos.wide[rank] = pos;
+    } else {
+        view->pos.narrow[rank] = (uint32_t) pos;
     }
+}
 
-    return array->item_ptr_arr[index];
+//! Returns the size of a position in an ordered view.
+static size_t view_width(const darray_view *view) {
+    return view->wide ? sizeof(size_t) : sizeof(uint32_t);
 }
 
-int darray_pop(darray *array, size_t index) {
-    if (array == NULL) {
-        darray_errno = DARRAY_ENULLS;
-        return 0;
-    }
-    if (index >= array->len) {
-        darray_errno = DARRAY_EINDEX;
-        return 0;
+//! Finds the first rank whose item does not compare smaller than a key.
+/*!
+\param upper Non-zero to find the first rank whose item compares bigger than
+the key instead.
+*/
+static size_t view_bound(
+        darray_view *view, const void *key_ptr, comparator fp, int upper) {
+    size_t low = 0;
+    size_t high = view->len;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        int cmp = fp(view->array->item_ptr_arr[view_pos(view, mid)], key_ptr);
+        if (cmp < 0 || (upper && cmp == 0)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
     }
+    return low;
+}
 
-    if (array->item_free != NULL) {
-        array->item_free(array->item_ptr_arr[index]);
+//! Adds the item at a given array index to an ordered view.
+/*!
+The item is placed after all items that compare equal to it, so items with
+equal keys stay in the order of their positions.
+*/
+static int view_put(darray_view *view, size_t idx) {
+    if (!view->wide && idx > UINT32_MAX) {
+        view->stale = 1;
+        return 1;
     }
-    memmove(array->item_ptr_arr + index,
-            array->item_ptr_arr + index + 1,
-            sizeof(void *) * (array->len - index - 1));
-    if (!darray_resize(array, array->len - 1)) {
-        return 0;
+    if (view->len == view->cap) {
+        size_t cap = view->cap > 0 ? view->cap * 2 : 1;
+        void *pos_arr = realloc(view->pos.wide, view_width(view) * cap);
+        if (pos_arr == NULL) {
+            darray_errno = DARRAY_EALLOC;
+            PROBE0(alloc__fail);
+            return 0;
+        }
+        view->pos.wide = pos_arr;
+        view->cap = cap;
     }
 
-    array->len--;
+    void *item_ptr = view->array->item_ptr_arr[idx];
+    size_t rank = view_bound(view, item_ptr, view->cmp, 1);
+    unsigned char *pos_arr = (unsigned char *) view->pos.wide;
+    memmove(pos_arr + view_width(view) * (rank + 1),
+            pos_arr + view_width(view) * rank,
+            view_width(view) * (view->len - rank));
+    view_set(view, rank, idx);
+    view->len++;
 
     return 1;
 }
 
-int darray_pop_range(darray *array, size_t start, size_t end) {
-    if (array == NULL) {
-        darray_errno = DARRAY_ENULLS;
-        return 0;
-    }
-    if (end > array->len) {
-        darray_errno = DARRAY_EINDEX;
-        return 0;
-    }
-    if (start >= end) {
-        return 1;
+//! Removes the item at a given array index from an ordered view.
+static void view_remove(darray_view *view, size_t idx) {
+    for (size_t rank = 0; rank < view->len; rank++) {
+        if (view_pos(view, rank) == idx) {
+            unsigned char *pos_arr = (unsigned char *) view->pos.wide;
+            memmove(pos_arr + view_width(view) * rank,
+                    pos_arr + view_width(view) * (rank + 1),
+                    view_width(view) * (view->len - rank - 1));
+            view->len--;
+            return;
+        }
     }
+}
 
-    if (array->item_free != NULL) {
-        for (size_t i = start; i < end; i++) {
-            array->item_free(array->item_ptr_arr[i]);
+//! Sorts positions by their items using a bottom-up merge sort.
+/*!
+The sort is stable, so items that compare equal stay in the order of their
+positions.
+
+\param pos_arr The positions to sort.
+\param buf A buffer as long as the positions.
+\returns The array containing the sorted positions, either `pos_arr` or
+`buf`.
+*/
+static size_t *view_merge_sort(darray_view *view,
+                               size_t *pos_arr, size_t *buf, size_t len) {
+    void **item_ptr_arr = view->array->item_ptr_arr;
+    for (size_t width = 1; width < len; width *= 2) {
+        for (size_t low = 0; low < len; low += 2 * width) {
+            size_t mid = low + width < len ? low + width : len;
+            size_t high = mid + width < len ? mid + width : len;
+            size_t i = low, j = mid, k = low;
+            while (i < mid && j < high) {
+                if (view->cmp(item_ptr_arr[pos_arr[j]],
+                              item_ptr_arr[pos_arr[i]]) < 0) {
+                    buf[k++] = pos_arr[j++];
+                } else {
+                    buf[k++] = pos_arr[i++];
+                }
+            }
+            while (i < mid) {
+                buf[k++] = pos_arr[i++];
+            }
+            while (j < high) {
+                buf[k++] = pos_arr[j++];
+            }
         }
+        size_t *temp = pos_arr;
+        pos_arr = buf;
+        buf = temp;
     }
-    memmove(array->item_ptr_arr + start,
-            array->item_ptr_arr + end,
-            sizeof(void *) * (array->len - end));
-    if (!darray_resize(array, array->len - (end - start))) {
+    return pos_arr;
+}
+
+//! Rebuilds a stale ordered view from its array.
+static int view_rebuild(darray_view *view) {
+    size_t len = view->array->len;
+    int wide = len > (size_t) UINT32_MAX + 1;
+    size_t width = wide ? sizeof(size_t) : sizeof(uint32_t);
+
+    size_t *scratch = malloc(sizeof(size_t) * (len > 0 ? len * 2 : 1));
+    if (scratch == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
         return 0;
     }
+    if (len > view->cap || wide != view->wide) {
+        void *pos_arr = realloc(view->pos.wide, width * (len > 0 ? len : 1));
+        if (pos_arr == NULL) {
+            free(scratch);
+            darray_errno = DARRAY_EALLOC;
+            PROBE0(alloc__fail);
+            return 0;
+        }
+        view->pos.wide = pos_arr;
+        view->cap = len > 0 ? len : 1;
+        view->wide = wide;
+    }
 
-    array->len -= end - start;
+    for (size_t i = 0; i < len; i++) {
+        scratch[i] = i;
+    }
+    size_t *sorted = view_merge_sort(view, scratch, scratch + len, len);
+    for (size_t i = 0; i < len; i++) {
+        view_set(view, i, sorted[i]);
+    }
+    free(scratch);
+    view->len = len;
+    view->stale = 0;
 
     return 1;
 }
 
-int darray_insert(darray *array, size_t index, void *item_ptr) {
-    if (array == NULL || item_ptr == NULL) {
-        darray_errno = DARRAY_ENULLS;
-        return 0;
+//! Adds the items in a given array index range to all attached structures.
+/*!
+Secondary indices add each item in place. Ordered views add a single item in
+place and are marked stale for more, since each addition moves positions.
+Anything that fails to update is marked stale instead of failing the caller.
+*/
+static void darray_attached_put(darray *array, size_t start, size_t end) {
+    if (start >= end) {
+        return;
     }
-    if (index > array->len) {
-        darray_errno = DARRAY_EINDEX;
-        return 0;
+    for (darray_index *index = array->index; index != NULL;
+            index = index->next) {
+        for (size_t i = start; i < end && !index->stale; i++) {
+            if (!index_put(index, i)) {
+                index->stale = 1;
+            }
+        }
+    }
+    for (darray_view *view = array->view; view != NULL; view = view->next) {
+        if (!view->stale && (end - start > 1 || !view_put(view, start))) {
+            view->stale = 1;
+        }
+    }
+}
+
+//! Removes the item at a given array index from all attached structures.
+static void darray_attached_remove(darray *array, size_t idx) {
+    for (darray_index *index = array->index; index != NULL;
+            index = index->next) {
+        if (!index->stale) {
+            index_remove(index, idx);
+        }
+    }
+    for (darray_view *view = array->view; view != NULL; view = view->next) {
+        if (!view->stale) {
+            view_remove(view, idx);
+        }
+    }
+}
+
+//! Marks all secondary indices and ordered views of an array as stale.
+static void darray_attached_invalidate(darray *array) {
+    for (darray_index *index = array->index; index != NULL;
+            index = index->next) {
+        index->stale = 1;
+    }
+    for (darray_view *view = array->view; view != NULL; view = view->next) {
+        view->stale = 1;
+    }
+}
+
+size_t darray_len(darray *array) {
+    if (array == NULL) {
+        return 0;
+    }
+    return array->len;
+}
+
+size_t darray_capacity(darray *array) {
+    if (array == NULL) {
+        return 0;
+    }
+    return array->cap;
+}
+
+size_t darray_memory_usage(darray *array, sizer fp) {
+    if (array == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    size_t usage = sizeof(darray) + sizeof(void *) * array->cap;
+    for (darray_index *index = array->index; index != NULL;
+            index = index->next) {
+        usage += sizeof(darray_index) + sizeof(struct index_slot) * index->cap;
+    }
+    for (darray_view *view = array->view; view != NULL; view = view->next) {
+        usage += sizeof(darray_view) + view_width(view) * view->cap;
+    }
+    if (fp != NULL) {
+        for (size_t i = 0; i < array->len; i++) {
+            usage += fp(array->item_ptr_arr[i]);
+        }
+    }
+
+    return usage;
+}
+
+int darray_foreach(darray *array, consumer fp) {
+    if (array == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    for (size_t i = 0; i < array->len; i++) {
+        fp(array->item_ptr_arr[i]);
+    }
+
+    return 1;
+}
+
+int darray_foreach_r(darray *array, consumer_r fp, void *ctx) {
+    if (array == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    for (size_t i = 0; i < array->len; i++) {
+        fp(array->item_ptr_arr[i], ctx);
+    }
+
+    return 1;
+}
+
+int darray_aggregate(darray *array, void *resp, aggregate fp) {
+    if (array == NULL || resp == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    for (size_t i = 0; i < array->len; i++) {
+        fp(array->item_ptr_arr[i], resp);
+    }
+
+    return 1;
+}
+
+int darray_aggregate_r(darray *array, void *resp, aggregate_r fp, void *ctx) {
+    if (array == NULL || resp == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    for (size_t i = 0; i < array->len; i++) {
+        fp(array->item_ptr_arr[i], resp, ctx);
+    }
+
+    return 1;
+}
+
+int darray_append(darray *array, void *item_ptr) {
+    if (array == NULL || item_ptr == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (!darray_own(array)) {
+        return 0;
+    }
+
+    if (!darray_resize(array, array->len + 1)) {
+        return 0;
+    }
+
+    array->item_ptr_arr[array->len] = item_ptr;
+
+    array->len++;
+    darray_attached_put(array, array->len - 1, array->len);
+
+    return 1;
+}
+
+void *darray_get(darray *array, size_t index) {
+    if (array == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+    if (index >= array->len) {
+        darray_errno = DARRAY_EINDEX;
+        return NULL;
+    }
+
+    return array->item_ptr_arr[index];
+}
+
+void **darray_data(darray *array) {
+    if (array == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+    if (!darray_own(array)) {
+        return NULL;
+    }
+
+    darray_attached_invalidate(array);
+
+    return array->item_ptr_arr;
+}
+
+void *const *darray_cdata(darray *array) {
+    if (array == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+
+    return array->item_ptr_arr;
+}
+
+int darray_pop(darray *array, size_t index) {
+    if (array == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (index >= array->len) {
+        darray_errno = DARRAY_EINDEX;
+        return 0;
+    }
+    if (!darray_own(array)) {
+        return 0;
+    }
+
+    if (index == array->len - 1) {
+        darray_attached_remove(array, index);
+    } else {
+        darray_attached_invalidate(array);
+    }
+    darray_free_items(array, array->item_ptr_arr + index, 1);
+    memmove(array->item_ptr_arr + index,
+            array->item_ptr_arr + index + 1,
+            sizeof(void *) * (array->len - index - 1));
+    STAT_ADD(array, bytes_moved, sizeof(void *) * (array->len - index - 1));
+    if (!darray_resize(array, array->len - 1)) {
+        return 0;
+    }
+
+    array->len--;
+
+    return 1;
+}
+
+int darray_pop_range(darray *array, size_t start, size_t end) {
+    if (array == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (end > array->len) {
+        darray_errno = DARRAY_EINDEX;
+        return 0;
+    }
+    if (start >= end) {
+        return 1;
+    }
+    if (!darray_own(array)) {
+        return 0;
+    }
+
+    if (end == array->len) {
+        for (size_t i = start; i < end; i++) {
+            darray_attached_remove(array, i);
+        }
+    } else {
+        darray_attached_invalidate(array);
+    }
+    darray_free_items(array, array->item_ptr_arr + start, end - start);
+    memmove(array->item_ptr_arr + start,
+            array->item_ptr_arr + end,
+            sizeof(void *) * (array->len - end));
+    STAT_ADD(array, bytes_moved, sizeof(void *) * (array->len - end));
+    if (!darray_resize(array, array->len - (end - start))) {
+        return 0;
+    }
+
+    array->len -= end - start;
+
+    return 1;
+}
+
+int darray_insert(darray *array, size_t index, void *item_ptr) {
+    if (array == NULL || item_ptr == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (index > array->len) {
+        darray_errno = DARRAY_EINDEX;
+        return 0;
+    }
+    if (!darray_own(array)) {
+        return 0;
     }
 
     if (!darray_resize(array, array->len + 1)) {
@@ -222,10 +1178,16 @@ int darray_insert(darray *array, size_t index, void *item_ptr) {
     memmove(array->item_ptr_arr + index + 1,
             array->item_ptr_arr + index,
             sizeof(void *) * (array->len - index));
+    STAT_ADD(array, bytes_moved, sizeof(void *) * (array->len - index));
 
     array->item_ptr_arr[index] = item_ptr;
 
     array->len++;
+    if (index == array->len - 1) {
+        darray_attached_put(array, index, index + 1);
+    } else {
+        darray_attached_invalidate(array);
+    }
 
     return 1;
 }
@@ -239,11 +1201,34 @@ int darray_search(
 
     for (size_t i = 0; i < array->len; i++) {
         if (fp(array->item_ptr_arr[i], item_ptr) == 0) {
+            STAT_ADD(array, cmp_calls, i + 1);
+            PROBE2(search, i + 1, 1);
+            *idx_ptr = i;
+            return 1;
+        }
+    }
+
+    STAT_ADD(array, cmp_calls, array->len);
+    PROBE2(search, array->len, 0);
+    darray_errno = DARRAY_ENOTIN;
+    return 0;
+}
+
+int darray_search_r(darray *array, predicate_r fp, void *ctx, size_t *idx_ptr) {
+    if (array == NULL || fp == NULL || idx_ptr == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    for (size_t i = 0; i < array->len; i++) {
+        if (fp(array->item_ptr_arr[i], ctx)) {
+            PROBE2(search, i + 1, 1);
             *idx_ptr = i;
             return 1;
         }
     }
 
+    PROBE2(search, array->len, 0);
     darray_errno = DARRAY_ENOTIN;
     return 0;
 }
@@ -257,6 +1242,9 @@ int darray_extend_at(darray *array1, size_t index, darray *array2) {
         darray_errno = DARRAY_EINDEX;
         return 0;
     }
+    if (!darray_own(array1)) {
+        return 0;
+    }
 
     if (!darray_resize(array1, array1->len + array2->len)) {
         return 0;
@@ -264,12 +1252,14 @@ int darray_extend_at(darray *array1, size_t index, darray *array2) {
     memmove(array1->item_ptr_arr + index + array2->len,
             array1->item_ptr_arr + index,
             sizeof(void *) * (array1->len - index));
+    STAT_ADD(array1, bytes_moved, sizeof(void *) * (array1->len - index));
 
     for (size_t i = 0; i < array2->len; i++) {
         array1->item_ptr_arr[index + i] = darray_get(array2, i);
     }
 
     array1->len += array2->len;
+    darray_attached_invalidate(array1);
 
     return 1;
 }
@@ -279,6 +1269,9 @@ int darray_extend(darray *array1, darray *array2) {
         darray_errno = DARRAY_ENULLS;
         return 0;
     }
+    if (!darray_own(array1)) {
+        return 0;
+    }
 
     if (!darray_resize(array1, array1->len + array2->len)) {
         return 0;
@@ -289,6 +1282,7 @@ int darray_extend(darray *array1, darray *array2) {
     }
 
     array1->len += array2->len;
+    darray_attached_put(array1, array1->len - array2->len, array1->len);
 
     return 1;
 }
@@ -298,53 +1292,149 @@ int darray_reverse(darray *array) {
         darray_errno = DARRAY_ENULLS;
         return 0;
     }
+    if (!darray_own(array)) {
+        return 0;
+    }
 
     for (size_t i = 0; i < array->len / 2; i++) {
         void *temp = array->item_ptr_arr[i];
         array->item_ptr_arr[i] = array->item_ptr_arr[array->len - i - 1];
         array->item_ptr_arr[array->len - i - 1] = temp;
     }
+    darray_attached_invalidate(array);
 
     return 1;
 }
 
+static void swap_voidp(void **pp1, void **pp2) {
+    void *temp = *pp1;
+    *pp1 = *pp2;
+    *pp2 = temp;
+}
+
 int darray_unique(darray *array, comparator fp) {
     if (array == NULL || fp == NULL) {
         darray_errno = DARRAY_ENULLS;
         return 0;
     }
+    if (array->len < 2) {
+        return 1;
+    }
+    if (!darray_own(array)) {
+        return 0;
+    }
 
+    // The first item of each run of equal items is swapped down in a single
+    // pass, which gathers the duplicates at the end so they can be freed at
+    // once.
     void **item_ptr_arr = array->item_ptr_arr;
     size_t m = 1;
-    size_t i = 1;
-    for (; i < array->len; i++) {
-        if (fp(item_ptr_arr[i-1], item_ptr_arr[i]) != 0) {
-            if (!darray_pop_range(array, m, i)) {
-                return 0;
-            }
-            i -= i - m;
-            m = i + 1;
+    for (size_t i = 1; i < array->len; i++) {
+        if (fp(item_ptr_arr[m - 1], item_ptr_arr[i]) != 0) {
+            swap_voidp(item_ptr_arr + m++, item_ptr_arr + i);
         }
     }
-    if (!darray_pop_range(array, m, i)) {
-        return 0;
+    STAT_ADD(array, cmp_calls, array->len - 1);
+    if (m == array->len) {
+        return 1;
     }
+    darray_free_items(array, item_ptr_arr + m, array->len - m);
+    array->len = m;
+    darray_attached_invalidate(array);
 
-    return 1;
-}
-
-static void swap_voidp(void **pp1, void **pp2) {
-    void *temp = *pp1;
-    *pp1 = *pp2;
-    *pp2 = temp;
+    return darray_resize(array, m);
 }
 
-static ssize_t partition(void **item_ptr_arr,
-                         ssize_t low, ssize_t high, comparator cmp) {
-    void *pivot = item_ptr_arr[high];
-    ssize_t i = low - 1;
+int darray_remove_if(darray *array, predicate fp) {
+    if (array == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (!darray_own(array)) {
+        return 0;
+    }
 
-    for (ssize_t j = low; j < high; j++) {
+    // Kept items are swapped down in a single pass, which gathers the removed
+    // ones at the end so they can be freed at once.
+    void **item_ptr_arr = array->item_ptr_arr;
+    size_t m = 0;
+    for (size_t i = 0; i < array->len; i++) {
+        if (!fp(item_ptr_arr[i])) {
+            swap_voidp(item_ptr_arr + m++, item_ptr_arr + i);
+        }
+    }
+    if (m == array->len) {
+        return 1;
+    }
+    darray_free_items(array, item_ptr_arr + m, array->len - m);
+    array->len = m;
+    darray_attached_invalidate(array);
+
+    return darray_resize(array, m);
+}
+
+int darray_remove_if_r(darray *array, predicate_r fp, void *ctx) {
+    if (array == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (!darray_own(array)) {
+        return 0;
+    }
+
+    void **item_ptr_arr = array->item_ptr_arr;
+    size_t m = 0;
+    for (size_t i = 0; i < array->len; i++) {
+        if (!fp(item_ptr_arr[i], ctx)) {
+            swap_voidp(item_ptr_arr + m++, item_ptr_arr + i);
+        }
+    }
+    if (m == array->len) {
+        return 1;
+    }
+    darray_free_items(array, item_ptr_arr + m, array->len - m);
+    array->len = m;
+    darray_attached_invalidate(array);
+
+    return darray_resize(array, m);
+}
+
+int darray_partition(darray *array, predicate fp, size_t *index_ptr) {
+    if (array == NULL || fp == NULL || index_ptr == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (!darray_own(array)) {
+        return 0;
+    }
+
+    void **item_ptr_arr = array->item_ptr_arr;
+    size_t i = 0;
+    size_t j = array->len;
+    while (1) {
+        while (i < j && fp(item_ptr_arr[i])) {
+            i++;
+        }
+        while (i < j && !fp(item_ptr_arr[j - 1])) {
+            j--;
+        }
+        if (i == j) {
+            break;
+        }
+        swap_voidp(item_ptr_arr + i++, item_ptr_arr + --j);
+    }
+    *index_ptr = i;
+    darray_attached_invalidate(array);
+
+    return 1;
+}
+
+static ssize_t partition(void **item_ptr_arr,
+                         ssize_t low, ssize_t high, comparator cmp) {
+    void *pivot = item_ptr_arr[high];
+    ssize_t i = low - 1;
+
+    for (ssize_t j = low; j < high; j++) {
         if (cmp(item_ptr_arr[j], pivot) < 0) {
             i++;
             swap_voidp(item_ptr_arr + i, item_ptr_arr + j);
@@ -368,57 +1458,2229 @@ int darray_sort(darray *array, comparator fp) {
         darray_errno = DARRAY_ENULLS;
         return 0;
     }
+    if (!darray_own(array)) {
+        return 0;
+    }
 
+    PROBE1(sort__start, array->len);
+    STAT_CMP_BEGIN(fp);
     if (array->len > 0) {
         darray_qsort(array->item_ptr_arr, 0, array->len - 1, fp);
     }
+    STAT_CMP_END(array, fp);
+    PROBE1(sort__end, array->len);
+    darray_attached_invalidate(array);
 
     return 1;
 }
 
-darray *darray_clone(darray *array, unary fp) {
+//! Partitions items around the last one with a context comparator.
+static ssize_t partition_r(void **item_ptr_arr, ssize_t low, ssize_t high,
+                           comparator_r cmp, void *ctx) {
+    void *pivot = item_ptr_arr[high];
+    ssize_t i = low - 1;
+
+    for (ssize_t j = low; j < high; j++) {
+        if (cmp(item_ptr_arr[j], pivot, ctx) < 0) {
+            i++;
+            swap_voidp(item_ptr_arr + i, item_ptr_arr + j);
+        }
+    }
+    swap_voidp(item_ptr_arr + (i + 1), item_ptr_arr + high);
+    return i + 1;
+}
+
+//! Sorts items in `[low, high]` with a context comparator.
+static void qsort_r_items(void **item_ptr_arr, ssize_t low, ssize_t high,
+                          comparator_r cmp, void *ctx) {
+    if (low < high) {
+        ssize_t pivot_i = partition_r(item_ptr_arr, low, high, cmp, ctx);
+
+        qsort_r_items(item_ptr_arr, low, pivot_i - 1, cmp, ctx);
+        qsort_r_items(item_ptr_arr, pivot_i + 1, high, cmp, ctx);
+    }
+}
+
+int darray_sort_r(darray *array, comparator_r fp, void *ctx) {
+    if (array == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (!darray_own(array)) {
+        return 0;
+    }
+
+    PROBE1(sort__start, array->len);
+    STAT_CMP_R_BEGIN(fp);
+    if (array->len > 0) {
+        qsort_r_items(array->item_ptr_arr, 0, array->len - 1, fp, ctx);
+    }
+    STAT_CMP_R_END(array, fp);
+    PROBE1(sort__end, array->len);
+    darray_attached_invalidate(array);
+
+    return 1;
+}
+
+//! Restores the max-heap property below a given node.
+/*!
+The items in `[0, len)` form a binary max-heap except that the item at index `i`
+may be smaller than its children.
+*/
+static void heap_sift_down(void **item_ptr_arr,
+                           size_t i, size_t len, comparator cmp) {
+    void *item_ptr = item_ptr_arr[i];
+    for (size_t child = 2 * i + 1; child < len; child = 2 * i + 1) {
+        if (child + 1 < len &&
+                cmp(item_ptr_arr[child], item_ptr_arr[child + 1]) < 0) {
+            child++;
+        }
+        if (cmp(item_ptr_arr[child], item_ptr) <= 0) {
+            break;
+        }
+        item_ptr_arr[i] = item_ptr_arr[child];
+        i = child;
+    }
+    item_ptr_arr[i] = item_ptr;
+}
+
+//! Arranges items into a binary max-heap.
+static void heap_make(void **item_ptr_arr, size_t len, comparator cmp) {
+    for (size_t i = len / 2; i > 0; i--) {
+        heap_sift_down(item_ptr_arr, i - 1, len, cmp);
+    }
+}
+
+//! Sorts a binary max-heap in place.
+static void heap_sort(void **item_ptr_arr, size_t len, comparator cmp) {
+    for (size_t i = len; i > 1; i--) {
+        swap_voidp(item_ptr_arr, item_ptr_arr + i - 1);
+        heap_sift_down(item_ptr_arr, 0, i - 1, cmp);
+    }
+}
+
+//! Sorts a short range of items with an insertion sort.
+static void insertion_sort(void **item_ptr_arr, size_t len, comparator cmp) {
+    for (size_t i = 1; i < len; i++) {
+        void *item_ptr = item_ptr_arr[i];
+        size_t j = i;
+        for (; j > 0 && cmp(item_ptr_arr[j - 1], item_ptr) > 0; j--) {
+            item_ptr_arr[j] = item_ptr_arr[j - 1];
+        }
+        item_ptr_arr[j] = item_ptr;
+    }
+}
+
+//! Moves the median of three items to the first of them.
+static void median_to_front(void **item_ptr_arr,
+                            size_t a, size_t b, size_t c, comparator cmp) {
+    if (cmp(item_ptr_arr[b], item_ptr_arr[a]) < 0) {
+        swap_voidp(item_ptr_arr + a, item_ptr_arr + b);
+    }
+    if (cmp(item_ptr_arr[c], item_ptr_arr[b]) < 0) {
+        swap_voidp(item_ptr_arr + b, item_ptr_arr + c);
+        if (cmp(item_ptr_arr[b], item_ptr_arr[a]) < 0) {
+            swap_voidp(item_ptr_arr + a, item_ptr_arr + b);
+        }
+    }
+    swap_voidp(item_ptr_arr + a, item_ptr_arr + b);
+}
+
+//! Places the nth smallest item at index `nth` using introselect.
+/*!
+Quickselect with a median-of-three pivot and a Hoare partition, which splits
+runs of equal items evenly. If the recursion depth exceeds twice the logarithm
+of the length, it falls back to a heap select so the worst case stays
+O(n log n).
+
+\param nth An index in `[0, len)`.
+*/
+static void introselect(void **item_ptr_arr,
+                        size_t len, size_t nth, comparator cmp) {
+    size_t low = 0;
+    size_t high = len;
+    size_t depth = 0;
+    for (size_t n = len; n > 1; n /= 2) {
+        depth += 2;
+    }
+
+    while (high - low > 16) {
+        if (depth-- == 0) {
+            void **sub = item_ptr_arr + low;
+            size_t k = nth - low + 1;
+            heap_make(sub, k, cmp);
+            for (size_t i = k; i < high - low; i++) {
+                if (cmp(sub[i], sub[0]) < 0) {
+                    swap_voidp(sub, sub + i);
+                    heap_sift_down(sub, 0, k, cmp);
+                }
+            }
+            swap_voidp(sub, sub + k - 1);
+            return;
+        }
+
+        median_to_front(item_ptr_arr,
+                        low, low + (high - low) / 2, high - 1, cmp);
+        void *pivot = item_ptr_arr[low];
+        size_t i = low;
+        size_t j = high;
+        while (1) {
+            while (++i < high && cmp(item_ptr_arr[i], pivot) < 0);
+            while (cmp(item_ptr_arr[--j], pivot) > 0);
+            if (i >= j) {
+                break;
+            }
+            swap_voidp(item_ptr_arr + i, item_ptr_arr + j);
+        }
+        swap_voidp(item_ptr_arr + low, item_ptr_arr + j);
+
+        if (nth == j) {
+            return;
+        } else if (nth < j) {
+            high = j;
+        } else {
+            low = j + 1;
+        }
+    }
+    insertion_sort(item_ptr_arr + low, high - low, cmp);
+}
+
+int darray_nth_element(darray *array, size_t index, comparator fp) {
+    if (array == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (index >= array->len) {
+        darray_errno = DARRAY_EINDEX;
+        return 0;
+    }
+    if (!darray_own(array)) {
+        return 0;
+    }
+
+    STAT_CMP_BEGIN(fp);
+    introselect(array->item_ptr_arr, array->len, index, fp);
+    STAT_CMP_END(array, fp);
+    darray_attached_invalidate(array);
+
+    return 1;
+}
+
+int darray_partial_sort(darray *array, size_t k, comparator fp) {
+    if (array == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (k > array->len) {
+        darray_errno = DARRAY_EINDEX;
+        return 0;
+    }
+    if (!darray_own(array)) {
+        return 0;
+    }
+
+    STAT_CMP_BEGIN(fp);
+    if (k > 0) {
+        if (k < array->len) {
+            introselect(array->item_ptr_arr, array->len, k - 1, fp);
+        }
+        heap_make(array->item_ptr_arr, k, fp);
+        heap_sort(array->item_ptr_arr, k, fp);
+    }
+    STAT_CMP_END(array, fp);
+    darray_attached_invalidate(array);
+
+    return 1;
+}
+
+darray *darray_top_k(darray *array, size_t k, comparator fp) {
     if (array == NULL || fp == NULL) {
         darray_errno = DARRAY_ENULLS;
         return NULL;
     }
+    if (k > array->len) {
+        k = array->len;
+    }
 
-    darray *clone = (darray *) malloc(sizeof(darray));
+    darray *top = new_darray(NULL);
+    if (top == NULL) {
+        return NULL;
+    }
+    if (!darray_resize(top, k)) {
+        del_darray(top);
+        return NULL;
+    }
 
-    memcpy(clone, array, sizeof(darray));
+    STAT_CMP_BEGIN(fp);
+    void **heap = top->item_ptr_arr;
+    memcpy(heap, array->item_ptr_arr, sizeof(void *) * k);
+    heap_make(heap, k, fp);
+    for (size_t i = k; i < array->len && k > 0; i++) {
+        if (fp(array->item_ptr_arr[i], heap[0]) < 0) {
+            heap[0] = array->item_ptr_arr[i];
+            heap_sift_down(heap, 0, k, fp);
+        }
+    }
+    heap_sort(heap, k, fp);
+    STAT_CMP_END(array, fp);
+    top->len = k;
 
-    clone->item_ptr_arr = (void **) malloc(sizeof(void *) * clone->cap);
-    for (size_t i = 0; i < clone->len; i++) {
-        clone->item_ptr_arr[i] = fp(array->item_ptr_arr[i]);
+    return top;
+}
+
+//! Moves an item up a tracked binary max-heap until its parent is not smaller.
+static void heap_sift_up_tracked(void **item_ptr_arr, size_t i,
+                                 comparator cmp, tracker track) {
+    void *item_ptr = item_ptr_arr[i];
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (cmp(item_ptr_arr[parent], item_ptr) >= 0) {
+            break;
+        }
+        item_ptr_arr[i] = item_ptr_arr[parent];
+        if (track != NULL) {
+            track(item_ptr_arr[i], i);
+        }
+        i = parent;
     }
+    item_ptr_arr[i] = item_ptr;
+    if (track != NULL) {
+        track(item_ptr, i);
+    }
+}
 
-    return clone;
+//! Moves an item down a tracked binary max-heap until no child is bigger.
+static void heap_sift_down_tracked(void **item_ptr_arr, size_t i, size_t len,
+                                   comparator cmp, tracker track) {
+    void *item_ptr = item_ptr_arr[i];
+    for (size_t child = 2 * i + 1; child < len; child = 2 * i + 1) {
+        if (child + 1 < len &&
+                cmp(item_ptr_arr[child], item_ptr_arr[child + 1]) < 0) {
+            child++;
+        }
+        if (cmp(item_ptr_arr[child], item_ptr) <= 0) {
+            break;
+        }
+        item_ptr_arr[i] = item_ptr_arr[child];
+        if (track != NULL) {
+            track(item_ptr_arr[i], i);
+        }
+        i = child;
+    }
+    item_ptr_arr[i] = item_ptr;
+    if (track != NULL) {
+        track(item_ptr, i);
+    }
 }
 
-int darray_clear(darray *array) {
-    if (array == NULL) {
+int darray_heapify(darray *array, comparator fp, tracker track) {
+    if (array == NULL || fp == NULL) {
         darray_errno = DARRAY_ENULLS;
         return 0;
     }
+    if (!darray_own(array)) {
+        return 0;
+    }
 
-    for (size_t i = 0; i < array->len; i++) {
-        if (array->item_free != NULL) {
-            array->item_free(array->item_ptr_arr[i]);
+    STAT_CMP_BEGIN(fp);
+    if (track != NULL) {
+        for (size_t i = 0; i < array->len; i++) {
+            track(array->item_ptr_arr[i], i);
         }
     }
-    array->len = 0;
+    for (size_t i = array->len / 2; i > 0; i--) {
+        heap_sift_down_tracked(array->item_ptr_arr, i - 1, array->len,
+                               fp, track);
+    }
+    STAT_CMP_END(array, fp);
+    darray_attached_invalidate(array);
 
     return 1;
 }
 
-int del_darray(darray *array) {
-    if (array == NULL) {
+int darray_heap_push(darray *array, void *item_ptr,
+                     comparator fp, tracker track) {
+    if (array == NULL || item_ptr == NULL || fp == NULL) {
         darray_errno = DARRAY_ENULLS;
         return 0;
     }
+    if (!darray_own(array)) {
+        return 0;
+    }
 
-    darray_clear(array);
-    free(array->item_ptr_arr);
-    free(array);
+    if (!darray_resize(array, array->len + 1)) {
+        return 0;
+    }
+    array->item_ptr_arr[array->len++] = item_ptr;
+    STAT_CMP_BEGIN(fp);
+    heap_sift_up_tracked(array->item_ptr_arr, array->len - 1, fp, track);
+    STAT_CMP_END(array, fp);
+    darray_attached_invalidate(array);
+
+    return 1;
+}
+
+int darray_heap_pop(darray *array, comparator fp, tracker track) {
+    if (array == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (array->len == 0) {
+        darray_errno = DARRAY_EINDEX;
+        return 0;
+    }
+    if (!darray_own(array)) {
+        return 0;
+    }
+
+    darray_attached_invalidate(array);
+    void **item_ptr_arr = array->item_ptr_arr;
+    size_t last = array->len - 1;
+    swap_voidp(item_ptr_arr, item_ptr_arr + last);
+    darray_free_items(array, item_ptr_arr + last, 1);
+    if (!darray_resize(array, last)) {
+        return 0;
+    }
+    array->len--;
+    if (array->len > 0) {
+        STAT_CMP_BEGIN(fp);
+        heap_sift_down_tracked(array->item_ptr_arr, 0, array->len, fp, track);
+        STAT_CMP_END(array, fp);
+    }
+
+    return 1;
+}
+
+int darray_heap_update(darray *array, size_t index,
+                       comparator fp, tracker track) {
+    if (array == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (index >= array->len) {
+        darray_errno = DARRAY_EINDEX;
+        return 0;
+    }
+    if (!darray_own(array)) {
+        return 0;
+    }
+
+    void **item_ptr_arr = array->item_ptr_arr;
+    STAT_CMP_BEGIN(fp);
+    if (index > 0 && fp(item_ptr_arr[(index - 1) / 2], item_ptr_arr[index]) < 0) {
+        heap_sift_up_tracked(item_ptr_arr, index, fp, track);
+    } else {
+        heap_sift_down_tracked(item_ptr_arr, index, array->len, fp, track);
+    }
+    STAT_CMP_END(array, fp);
+    darray_attached_invalidate(array);
+
+    return 1;
+}
+
+//! The number of consecutive wins from one side before galloping.
+#define MIN_GALLOP 7
+
+//! The operations that combine two sorted arrays.
+enum set_op {
+    SET_MERGE,
+    SET_UNION,
+    SET_INTERSECTION,
+    SET_DIFFERENCE
+};
+
+//! Finds the first item from an index that does not come before a key.
+/*!
+The search probes exponentially increasing offsets before a binary search, so
+it takes O(log k) comparisons to skip k items. An item comes before the key if
+it compares less than it, or less than or equal to it if `ties` is non-zero.
+*/
+static size_t gallop(void **item_ptr_arr, size_t lo, size_t hi,
+                     const void *key, comparator cmp, int ties) {
+    size_t step = 1;
+    while (lo + step - 1 < hi && cmp(item_ptr_arr[lo + step - 1], key) < ties) {
+        lo += step;
+        step *= 2;
+    }
+    size_t up = lo + step - 1 < hi ? lo + step - 1 : hi;
+    while (lo < up) {
+        size_t mid = lo + (up - lo) / 2;
+        if (cmp(item_ptr_arr[mid], key) < ties) {
+            lo = mid + 1;
+        } else {
+            up = mid;
+        }
+    }
+    return lo;
+}
+
+//! Combines two sorted arrays of pointers and returns the number written.
+static size_t set_combine(void **a, size_t n, void **b, size_t m,
+                          void **out, comparator cmp, enum set_op op) {
+    int keep_a = op != SET_INTERSECTION;
+    int keep_b = op == SET_MERGE || op == SET_UNION;
+    // A merge takes equal items from the first array before the second one.
+    int ties = op == SET_MERGE;
+    size_t i = 0, j = 0, k = 0;
+    size_t a_wins = 0, b_wins = 0;
+
+    while (i < n && j < m) {
+        if (a_wins >= MIN_GALLOP) {
+            size_t end = gallop(a, i, n, b[j], cmp, ties);
+            if (keep_a) {
+                memcpy(out + k, a + i, sizeof(void *) * (end - i));
+                k += end - i;
+            }
+            i = end;
+            a_wins = 0;
+            continue;
+        }
+        if (b_wins >= MIN_GALLOP) {
+            size_t end = gallop(b, j, m, a[i], cmp, 0);
+            if (keep_b) {
+                memcpy(out + k, b + j, sizeof(void *) * (end - j));
+                k += end - j;
+            }
+            j = end;
+            b_wins = 0;
+            continue;
+        }
+
+        int order = cmp(a[i], b[j]);
+        if (order < ties) {
+            if (keep_a) {
+                out[k++] = a[i];
+            }
+            i++;
+            a_wins++;
+            b_wins = 0;
+        } else if (order > 0 || op == SET_MERGE) {
+            if (keep_b) {
+                out[k++] = b[j];
+            }
+            j++;
+            b_wins++;
+            a_wins = 0;
+        } else {
+            if (op != SET_DIFFERENCE) {
+                out[k++] = a[i];
+            }
+            i++;
+            j++;
+            a_wins = b_wins = 0;
+        }
+    }
+    if (keep_a) {
+        memcpy(out + k, a + i, sizeof(void *) * (n - i));
+        k += n - i;
+    }
+    if (keep_b) {
+        memcpy(out + k, b + j, sizeof(void *) * (m - j));
+        k += m - j;
+    }
+
+    return k;
+}
+
+int darray_merge(darray *array1, darray *array2, comparator fp) {
+    if (array1 == NULL || array2 == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (!darray_own(array1)) {
+        return 0;
+    }
+
+    size_t n = array1->len, m = array2->len;
+    void **a = (void **) malloc(sizeof(void *) * (n + 1));
+    if (a == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
+        return 0;
+    }
+    memcpy(a, array1->item_ptr_arr, sizeof(void *) * n);
+    if (!darray_resize(array1, n + m)) {
+        free(a);
+        return 0;
+    }
+    void **b = array2 == array1 ? a : array2->item_ptr_arr;
+
+    STAT_CMP_BEGIN(fp);
+    array1->len = set_combine(a, n, b, m, array1->item_ptr_arr, fp, SET_MERGE);
+    STAT_CMP_END(array1, fp);
+    STAT_ADD(array1, bytes_moved, sizeof(void *) * (n + m));
+    free(a);
+    darray_attached_invalidate(array1);
+
+    return 1;
+}
+
+//! Returns a new array of two sorted arrays combined by a set operation.
+static darray *darray_set_op(darray *array1, darray *array2, comparator fp,
+                             enum set_op op) {
+    if (array1 == NULL || array2 == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+
+    darray *result = new_darray(NULL);
+    if (result == NULL) {
+        return NULL;
+    }
+    if (!darray_resize(result, array1->len + array2->len)) {
+        del_darray(result);
+        return NULL;
+    }
+
+    STAT_CMP_BEGIN(fp);
+    result->len = set_combine(array1->item_ptr_arr, array1->len,
+                              array2->item_ptr_arr, array2->len,
+                              result->item_ptr_arr, fp, op);
+    STAT_CMP_END(array1, fp);
+    if (!darray_resize(result, result->len)) {
+        del_darray(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+darray *darray_set_union(darray *array1, darray *array2, comparator fp) {
+    return darray_set_op(array1, array2, fp, SET_UNION);
+}
+
+darray *darray_set_intersection(darray *array1, darray *array2,
+                                comparator fp) {
+    return darray_set_op(array1, array2, fp, SET_INTERSECTION);
+}
+
+darray *darray_set_difference(darray *array1, darray *array2, comparator fp) {
+    return darray_set_op(array1, array2, fp, SET_DIFFERENCE);
+}
+
+//! Represents an item paired with its sort key.
+struct keyed_item {
+    /*! The sort key of the item. */
+    uint64_t key;
+    /*! Points to the item. */
+    void *item_ptr;
+};
+
+//! Pairs each item of an array with its key.
+/*!
+\returns An allocated array of twice the length of the array, the first half of
+which holds the pairs, or `NULL` if unsuccessful.
+*/
+static struct keyed_item *keyed_items(darray *array, keyer fp) {
+    struct keyed_item *pair_arr =
+        malloc(sizeof(struct keyed_item) * array->len * 2);
+    if (pair_arr == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
+        return NULL;
+    }
+    for (size_t i = 0; i < array->len; i++) {
+        pair_arr[i].key = fp(array->item_ptr_arr[i]);
+        pair_arr[i].item_ptr = array->item_ptr_arr[i];
+    }
+    return pair_arr;
+}
+
+//! Sorts keyed items by their keys using a stable LSD radix sort.
+/*!
+Passes in which all keys have the same digit are skipped.
+
+\param pair_arr The keyed items to sort.
+\param buf A buffer as long as the keyed items.
+\returns The array containing the sorted items, either `pair_arr` or `buf`.
+*/
+static struct keyed_item *radix_sort(struct keyed_item *pair_arr,
+                                     struct keyed_item *buf, size_t len) {
+    size_t count[8][256] = { { 0 } };
+    for (size_t i = 0; i < len; i++) {
+        uint64_t key = pair_arr[i].key;
+        for (int b = 0; b < 8; b++) {
+            count[b][(key >> (8 * b)) & 0xff]++;
+        }
+    }
+
+    for (int b = 0; b < 8; b++) {
+        size_t *bucket = count[b];
+        if (bucket[(pair_arr[0].key >> (8 * b)) & 0xff] == len) {
+            continue;
+        }
+        size_t offset = 0;
+        for (int d = 0; d < 256; d++) {
+            size_t n = bucket[d];
+            bucket[d] = offset;
+            offset += n;
+        }
+        for (size_t i = 0; i < len; i++) {
+            buf[bucket[(pair_arr[i].key >> (8 * b)) & 0xff]++] = pair_arr[i];
+        }
+        struct keyed_item *temp = pair_arr;
+        pair_arr = buf;
+        buf = temp;
+    }
+
+    return pair_arr;
+}
+
+int darray_sort_by_key(darray *array, keyer fp) {
+    if (array == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (array->len < 2) {
+        return 1;
+    }
+    if (!darray_own(array)) {
+        return 0;
+    }
+
+    size_t len = array->len;
+    PROBE1(sort__start, len);
+    struct keyed_item *pair_arr = keyed_items(array, fp);
+    if (pair_arr == NULL) {
+        return 0;
+    }
+    struct keyed_item *sorted = radix_sort(pair_arr, pair_arr + len, len);
+
+    for (size_t i = 0; i < len; i++) {
+        array->item_ptr_arr[i] = sorted[i].item_ptr;
+    }
+    free(pair_arr);
+    PROBE1(sort__end, len);
+    darray_attached_invalidate(array);
+
+    return 1;
+}
+
+int darray_sort_cached(darray *array, keyer prefix, comparator fp) {
+    if (array == NULL || prefix == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (array->len < 2) {
+        return 1;
+    }
+    if (!darray_own(array)) {
+        return 0;
+    }
+
+    size_t len = array->len;
+    PROBE1(sort__start, len);
+    struct keyed_item *pair_arr = keyed_items(array, prefix);
+    if (pair_arr == NULL) {
+        return 0;
+    }
+    struct keyed_item *sorted = radix_sort(pair_arr, pair_arr + len, len);
+
+    void **item_ptr_arr = array->item_ptr_arr;
+    for (size_t i = 0; i < len; i++) {
+        item_ptr_arr[i] = sorted[i].item_ptr;
+    }
+    STAT_CMP_BEGIN(fp);
+    for (size_t start = 0, end = 1; end <= len; end++) {
+        if (end < len && sorted[end].key == sorted[start].key) {
+            continue;
+        }
+        if (end - start <= 16) {
+            insertion_sort(item_ptr_arr + start, end - start, fp);
+        } else {
+            heap_make(item_ptr_arr + start, end - start, fp);
+            heap_sort(item_ptr_arr + start, end - start, fp);
+        }
+        start = end;
+    }
+    STAT_CMP_END(array, fp);
+    free(pair_arr);
+    PROBE1(sort__end, len);
+    darray_attached_invalidate(array);
+
+    return 1;
+}
+
+darray *darray_clone(darray *array, unary fp) {
+    if (array == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+
+    darray *clone = (darray *) malloc(sizeof(darray));
+
+    memcpy(clone, array, sizeof(darray));
+    clone->index = NULL;
+    clone->view = NULL;
+    clone->share = NULL;
+#ifdef DARRAY_STATS
+    memset(&clone->stat, 0, sizeof(darray_stat));
+    STAT_PEAK(clone, clone->cap);
+#endif
+
+    clone->item_ptr_arr = (void **) malloc(sizeof(void *) * clone->cap);
+    clone->map_cap = 0;
+    for (size_t i = 0; i < clone->len; i++) {
+        clone->item_ptr_arr[i] = fp(array->item_ptr_arr[i]);
+    }
+    registry_add(clone);
+
+    return clone;
+}
+
+darray *darray_clone_r(darray *array, unary_r fp, void *ctx) {
+    if (array == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+
+    darray *clone = (darray *) malloc(sizeof(darray));
+    if (clone == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
+        return NULL;
+    }
+    memcpy(clone, array, sizeof(darray));
+    clone->index = NULL;
+    clone->view = NULL;
+    clone->share = NULL;
+#ifdef DARRAY_STATS
+    memset(&clone->stat, 0, sizeof(darray_stat));
+    STAT_PEAK(clone, clone->cap);
+#endif
+
+    clone->item_ptr_arr = (void **) malloc(sizeof(void *) * clone->cap);
+    clone->map_cap = 0;
+    if (clone->item_ptr_arr == NULL) {
+        free(clone);
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
+        return NULL;
+    }
+    for (size_t i = 0; i < clone->len; i++) {
+        clone->item_ptr_arr[i] = fp(array->item_ptr_arr[i], ctx);
+    }
+    registry_add(clone);
+
+    return clone;
+}
+
+darray *darray_clone_cow(darray *array, unary fp) {
+    if (array == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+    if (array->share != NULL && array->share->copy != fp &&
+            !darray_own(array)) {
+        return NULL;
+    }
+
+    darray *clone = (darray *) malloc(sizeof(darray));
+    if (clone == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
+        return NULL;
+    }
+    if (array->share == NULL) {
+        array->share = malloc(sizeof(struct darray_share));
+        if (array->share == NULL) {
+            free(clone);
+            darray_errno = DARRAY_EALLOC;
+            PROBE0(alloc__fail);
+            return NULL;
+        }
+        array->share->refs = 1;
+        array->share->copy = fp;
+    }
+    array->share->refs++;
+
+    memcpy(clone, array, sizeof(darray));
+    clone->index = NULL;
+    clone->view = NULL;
+#ifdef DARRAY_STATS
+    memset(&clone->stat, 0, sizeof(darray_stat));
+    STAT_PEAK(clone, clone->cap);
+#endif
+    registry_add(clone);
+
+    return clone;
+}
+
+int darray_clear(darray *array) {
+    if (array == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    if (array->share != NULL && array->share->refs > 1) {
+        void **item_ptr_arr = malloc(sizeof(void *));
+        if (item_ptr_arr == NULL) {
+            darray_errno = DARRAY_EALLOC;
+            PROBE0(alloc__fail);
+            return 0;
+        }
+        darray_release(array);
+        array->item_ptr_arr = item_ptr_arr;
+        array->cap = 1;
+        array->map_cap = 0;
+    } else {
+        darray_release(array);
+        darray_free_items(array, array->item_ptr_arr, array->len);
+    }
+    array->len = 0;
+    darray_attached_invalidate(array);
+
+    return 1;
+}
+
+int del_darray(darray *array) {
+    if (array == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    while (array->index != NULL) {
+        del_darray_index(array->index);
+    }
+    while (array->view != NULL) {
+        del_darray_view(array->view);
+    }
+    registry_remove(array);
+    if (darray_release(array)) {
+        darray_clear(array);
+        free_ptr_arr(array->item_ptr_arr, array->map_cap);
+    }
+    free(array);
+
+    return 1;
+}
+
+//! Represents the items of a deleted array waiting to be freed.
+struct reclaim_job {
+    /*! Points to the pointer array of the deleted array. */
+    void **item_ptr_arr;
+    /*! The number of items to free. */
+    size_t len;
+    /*! The capacity of the mapping backing the pointer array, if any. */
+    size_t map_cap;
+    /*! Points to the function that frees an item. */
+    consumer item_free;
+    /*! Points to the function that frees a range of items. */
+    bulk_consumer bulk_free;
+    /*! Points to the next job in the queue. */
+    struct reclaim_job *next;
+};
+
+//! Guards the reclaim queue, which is shared between threads.
+static pthread_mutex_t reclaim_lock = PTHREAD_MUTEX_INITIALIZER;
+
+//! Signals the reclaim thread that a job was queued.
+static pthread_cond_t reclaim_queued = PTHREAD_COND_INITIALIZER;
+
+//! Signals waiting threads that every queued job is done.
+static pthread_cond_t reclaim_idle = PTHREAD_COND_INITIALIZER;
+
+//! Points to the first and last jobs in the reclaim queue.
+static struct reclaim_job *reclaim_head, *reclaim_tail;
+
+//! The number of jobs queued or being run.
+static size_t reclaim_pending;
+
+//! Whether the reclaim thread is running.
+static int reclaim_started;
+
+//! Frees the items of queued jobs in the background, forever.
+static void *reclaim_run(void *p) {
+    (void) p;
+    pthread_mutex_lock(&reclaim_lock);
+    while (1) {
+        while (reclaim_head == NULL) {
+            pthread_cond_wait(&reclaim_queued, &reclaim_lock);
+        }
+        struct reclaim_job *job = reclaim_head;
+        reclaim_head = job->next;
+        if (reclaim_head == NULL) {
+            reclaim_tail = NULL;
+        }
+        pthread_mutex_unlock(&reclaim_lock);
+
+        release_items(job->item_ptr_arr, job->len,
+                      job->item_free, job->bulk_free);
+        free_ptr_arr(job->item_ptr_arr, job->map_cap);
+        free(job);
+
+        pthread_mutex_lock(&reclaim_lock);
+        if (--reclaim_pending == 0) {
+            pthread_cond_broadcast(&reclaim_idle);
+        }
+    }
+
+    return NULL;
+}
+
+//! Queues a job for the reclaim thread, starting the thread if needed.
+/*!
+Returns 0 without queuing the job if the thread cannot be started.
+*/
+static int reclaim_queue(struct reclaim_job *job) {
+    pthread_mutex_lock(&reclaim_lock);
+    if (!reclaim_started) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, reclaim_run, NULL) != 0) {
+            pthread_mutex_unlock(&reclaim_lock);
+            return 0;
+        }
+        pthread_detach(thread);
+        reclaim_started = 1;
+    }
+    job->next = NULL;
+    if (reclaim_tail != NULL) {
+        reclaim_tail->next = job;
+    } else {
+        reclaim_head = job;
+    }
+    reclaim_tail = job;
+    reclaim_pending++;
+    pthread_cond_signal(&reclaim_queued);
+    pthread_mutex_unlock(&reclaim_lock);
+
+    return 1;
+}
+
+int del_darray_deferred(darray *array) {
+    if (array == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (array->item_free == NULL || array->len == 0 ||
+            (array->share != NULL && array->share->refs > 1)) {
+        return del_darray(array);
+    }
+
+    struct reclaim_job *job = malloc(sizeof(struct reclaim_job));
+    if (job == NULL) {
+        return del_darray(array);
+    }
+    while (array->index != NULL) {
+        del_darray_index(array->index);
+    }
+    while (array->view != NULL) {
+        del_darray_view(array->view);
+    }
+    darray_release(array);
+    job->item_ptr_arr = array->item_ptr_arr;
+    job->len = array->len;
+    job->map_cap = array->map_cap;
+    job->item_free = array->item_free;
+    job->bulk_free = array->bulk_free;
+    if (!reclaim_queue(job)) {
+        free(job);
+        return del_darray(array);
+    }
+    registry_remove(array);
+    STAT_ADD(array, item_frees, array->len);
+    free(array);
+
+    return 1;
+}
+
+int darray_reclaim_wait() {
+    pthread_mutex_lock(&reclaim_lock);
+    while (reclaim_pending > 0) {
+        pthread_cond_wait(&reclaim_idle, &reclaim_lock);
+    }
+    pthread_mutex_unlock(&reclaim_lock);
+
+    return 1;
+}
+
+darray_index *new_darray_index(
+        darray *array, unary key, hasher hash, comparator cmp) {
+    if (array == NULL || key == NULL || hash == NULL || cmp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+
+    darray_index *index = malloc(sizeof(darray_index));
+    if (index == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
+        return NULL;
+    }
+    index->array = array;
+    index->key = key;
+    index->hash = hash;
+    index->cmp = cmp;
+    index->slot_arr = NULL;
+    index->len = 0;
+    index->cap = 0;
+    index->stale = 1;
+    index->next = array->index;
+    array->index = index;
+
+    return index;
+}
+
+int darray_index_search(
+        darray_index *index, const void *key_ptr, size_t *idx_ptr) {
+    if (index == NULL || key_ptr == NULL || idx_ptr == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (index->stale && !index_rebuild(index)) {
+        return 0;
+    }
+
+    int found = 0;
+    if (index->len > 0) {
+        size_t mask = index->cap - 1;
+        size_t hash = index->hash(key_ptr);
+        for (size_t i = hash & mask; index->slot_arr[i].idx != SIZE_MAX;
+                i = (i + 1) & mask) {
+            struct index_slot slot = index->slot_arr[i];
+            if (slot.hash == hash && (!found || slot.idx < *idx_ptr) &&
+                    index->cmp(index->key(index->array->item_ptr_arr[slot.idx]),
+                               key_ptr) == 0) {
+                *idx_ptr = slot.idx;
+                found = 1;
+            }
+        }
+    }
+
+    if (!found) {
+        darray_errno = DARRAY_ENOTIN;
+    }
+    return found;
+}
+
+int del_darray_index(darray_index *index) {
+    if (index == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    darray_index **pp = &index->array->index;
+    while (*pp != index) {
+        pp = &(*pp)->next;
+    }
+    *pp = index->next;
+    free(index->slot_arr);
+    free(index);
+
+    return 1;
+}
+
+darray_view *new_darray_view(darray *array, comparator fp) {
+    if (array == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+
+    darray_view *view = malloc(sizeof(darray_view));
+    if (view == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
+        return NULL;
+    }
+    view->array = array;
+    view->cmp = fp;
+    view->pos.wide = NULL;
+    view->wide = 0;
+    view->len = 0;
+    view->cap = 0;
+    view->stale = 1;
+    view->next = array->view;
+    array->view = view;
+
+    return view;
+}
+
+void *darray_view_get(darray_view *view, size_t rank) {
+    if (view == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+    if (view->stale && !view_rebuild(view)) {
+        return NULL;
+    }
+    if (rank >= view->len) {
+        darray_errno = DARRAY_EINDEX;
+        return NULL;
+    }
+
+    return view->array->item_ptr_arr[view_pos(view, rank)];
+}
+
+int darray_view_foreach(darray_view *view, consumer fp) {
+    if (view == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (view->stale && !view_rebuild(view)) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < view->len; i++) {
+        fp(view->array->item_ptr_arr[view_pos(view, i)]);
+    }
+
+    return 1;
+}
+
+int darray_view_search(darray_view *view,
+                       const void *item_ptr, comparator fp, size_t *rank_ptr) {
+    if (view == NULL || item_ptr == NULL || fp == NULL || rank_ptr == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (view->stale && !view_rebuild(view)) {
+        return 0;
+    }
+
+    size_t rank = view_bound(view, item_ptr, fp, 0);
+    if (rank == view->len ||
+            fp(view->array->item_ptr_arr[view_pos(view, rank)],
+               item_ptr) != 0) {
+        darray_errno = DARRAY_ENOTIN;
+        return 0;
+    }
+
+    *rank_ptr = rank;
+    return 1;
+}
+
+int darray_view_range(darray_view *view,
+                      const void *low_ptr, const void *high_ptr, comparator fp,
+                      size_t *start_ptr, size_t *end_ptr) {
+    if (view == NULL || low_ptr == NULL || high_ptr == NULL || fp == NULL ||
+            start_ptr == NULL || end_ptr == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (view->stale && !view_rebuild(view)) {
+        return 0;
+    }
+
+    *start_ptr = view_bound(view, low_ptr, fp, 0);
+    *end_ptr = view_bound(view, high_ptr, fp, 1);
+    if (*end_ptr < *start_ptr) {
+        *end_ptr = *start_ptr;
+    }
+
+    return 1;
+}
+
+int del_darray_view(darray_view *view) {
+    if (view == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    darray_view **pp = &view->array->view;
+    while (*pp != view) {
+        pp = &(*pp)->next;
+    }
+    *pp = view->next;
+    free(view->pos.wide);
+    free(view);
+
+    return 1;
+}
+
+//! Represents the kinds of stages of a stream.
+enum stage_kind {
+    STAGE_MAP,
+    STAGE_FILTER,
+    STAGE_TAKE
+};
+
+//! Represents a stage of a stream.
+struct stream_stage {
+    /*! The kind of the stage. */
+    enum stage_kind kind;
+    /*! Points to the function of a map stage. */
+    unary map;
+    /*! Points to the function that frees the results of a map stage. */
+    consumer item_free;
+    /*! Points to the function of a filter stage. */
+    predicate filter;
+    /*! The maximum number of items passing a take stage. */
+    size_t take;
+};
+
+//! Represents a lazy pipeline over the items of an array.
+struct darray_stream {
+    /*! Points to the array the stream reads from. */
+    darray *array;
+    /*! Points to the stages in the order they apply. */
+    struct stream_stage *stage_arr;
+    /*! The number of stages. */
+    size_t len;
+    /*! The capacity of the stage array. */
+    size_t cap;
+    /*! The maximum number of threads a pass may use. */
+    size_t n_threads;
+};
+
+//! Represents a fused pass of a stream over a range of items.
+struct stream_pass {
+    /*! Points to the stream being run. */
+    darray_stream *stream;
+    /*! The index of the first item of the range. */
+    size_t start;
+    /*! The index after the last item of the range. */
+    size_t end;
+    /*! Points to the number of items that passed each take stage. */
+    size_t *taken_arr;
+    /*! Whether a take stage is exhausted, so no more items can pass. */
+    int done;
+    /*! Whether appending a result failed. */
+    int failed;
+    /*! Points to the array collecting results, or `NULL` to aggregate. */
+    darray *out;
+    /*! Points to the aggregate result. */
+    void *resp;
+    /*! Points to the aggregate function. */
+    aggregate fp;
+};
+
+//! Returns the function that frees the results of a stream.
+static consumer stream_item_free(const darray_stream *stream) {
+    for (size_t s = stream->len; s > 0; s--) {
+        if (stream->stage_arr[s - 1].kind == STAGE_MAP) {
+            return stream->stage_arr[s - 1].item_free;
+        }
+    }
+    return NULL;
+}
+
+//! Passes an item through every stage of a stream.
+/*!
+Returns 1 and stores the result if the item makes it through, 0 otherwise. A
+mapped result is freed as soon as it is replaced by a later map or dropped by a
+later stage.
+*/
+static int stream_item(struct stream_pass *pass, void *item_ptr,
+                       void **result_ptr) {
+    const darray_stream *stream = pass->stream;
+    consumer item_free = NULL;
+
+    for (size_t s = 0; s < stream->len; s++) {
+        const struct stream_stage *stage = stream->stage_arr + s;
+        int keep = 1;
+        if (stage->kind == STAGE_MAP) {
+            void *mapped = stage->map(item_ptr);
+            if (item_free != NULL) {
+                item_free(item_ptr);
+            }
+            item_ptr = mapped;
+            item_free = stage->item_free;
+        } else if (stage->kind == STAGE_FILTER) {
+            keep = stage->filter(item_ptr);
+        } else if (pass->taken_arr[s] < stage->take) {
+            if (++pass->taken_arr[s] == stage->take) {
+                pass->done = 1;
+            }
+        } else {
+            keep = 0;
+            pass->done = 1;
+        }
+        if (!keep) {
+            if (item_free != NULL) {
+                item_free(item_ptr);
+            }
+            return 0;
+        }
+    }
+    *result_ptr = item_ptr;
+
+    return 1;
+}
+
+//! Runs a fused pass of a stream over its range of items.
+static void *stream_pass_run(void *p) {
+    struct stream_pass *pass = p;
+    void **item_ptr_arr = pass->stream->array->item_ptr_arr;
+    consumer item_free = stream_item_free(pass->stream);
+
+    for (size_t i = pass->start; i < pass->end && !pass->done; i++) {
+        void *result;
+        if (!stream_item(pass, item_ptr_arr[i], &result)) {
+            continue;
+        }
+        if (pass->out == NULL) {
+            pass->fp(result, pass->resp);
+            if (item_free != NULL) {
+                item_free(result);
+            }
+        } else if (!darray_append(pass->out, result)) {
+            if (item_free != NULL) {
+                item_free(result);
+            }
+            pass->failed = 1;
+            pass->done = 1;
+        }
+    }
+
+    return NULL;
+}
+
+//! Returns the number of threads to split a pass of a stream over.
+/*!
+Take stages depend on the order items arrive in, so streams with one always run
+on the calling thread. Each thread gets at least 1024 items.
+*/
+static size_t stream_threads(const darray_stream *stream) {
+    for (size_t s = 0; s < stream->len; s++) {
+        if (stream->stage_arr[s].kind == STAGE_TAKE) {
+            return 1;
+        }
+    }
+    size_t n = stream->n_threads;
+    if (n > stream->array->len / 1024) {
+        n = stream->array->len / 1024;
+    }
+    return n > 0 ? n : 1;
+}
+
+//! Runs passes over ranges of items, each on its own thread.
+/*!
+The calling thread runs the first pass. If a thread cannot be created, its pass
+is run by the calling thread instead.
+
+\param pass_arr A pointer to an array of passes.
+\param size The size of each pass in bytes.
+\param n The number of passes.
+\param fp A pointer to the function that runs a pass.
+*/
+static void run_passes(void *pass_arr, size_t size, size_t n,
+                       void *(*fp)(void *)) {
+    char *pass_ptr = pass_arr;
+    pthread_t *thread_arr = n > 1 ? malloc(sizeof(pthread_t) * n) : NULL;
+    int *started = n > 1 ? calloc(n, sizeof(int)) : NULL;
+    if (thread_arr != NULL && started != NULL) {
+        for (size_t t = 1; t < n; t++) {
+            started[t] = pthread_create(
+                    thread_arr + t, NULL, fp, pass_ptr + size * t) == 0;
+        }
+    }
+    for (size_t t = 0; t < n; t++) {
+        if (started == NULL || !started[t]) {
+            fp(pass_ptr + size * t);
+        }
+    }
+    if (thread_arr != NULL && started != NULL) {
+        for (size_t t = 1; t < n; t++) {
+            if (started[t]) {
+                pthread_join(thread_arr[t], NULL);
+            }
+        }
+    }
+    free(thread_arr);
+    free(started);
+}
+
+//! Deallocates the passes of a stream and the results they still hold.
+static void stream_passes_free(struct stream_pass *pass_arr, size_t n) {
+    for (size_t t = 0; t < n; t++) {
+        free(pass_arr[t].taken_arr);
+        if (pass_arr[t].out != NULL) {
+            del_darray(pass_arr[t].out);
+        }
+    }
+    free(pass_arr);
+}
+
+//! Allocates the passes of a stream over evenly split ranges of its items.
+static struct stream_pass *stream_passes(darray_stream *stream, size_t n,
+                                         int collect) {
+    struct stream_pass *pass_arr = calloc(n, sizeof(struct stream_pass));
+    if (pass_arr == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
+        return NULL;
+    }
+
+    size_t len = stream->array->len;
+    for (size_t t = 0; t < n; t++) {
+        struct stream_pass *pass = pass_arr + t;
+        pass->stream = stream;
+        pass->start = len * t / n;
+        pass->end = len * (t + 1) / n;
+        pass->taken_arr = calloc(stream->len + 1, sizeof(size_t));
+        if (collect) {
+            pass->out = new_darray(stream_item_free(stream));
+        }
+        if (pass->taken_arr == NULL || (collect && pass->out == NULL)) {
+            stream_passes_free(pass_arr, n);
+            darray_errno = DARRAY_EALLOC;
+            PROBE0(alloc__fail);
+            return NULL;
+        }
+    }
+
+    return pass_arr;
+}
+
+darray_stream *new_darray_stream(darray *array) {
+    if (array == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+
+    darray_stream *stream = malloc(sizeof(darray_stream));
+    if (stream == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
+        return NULL;
+    }
+    stream->array = array;
+    stream->stage_arr = NULL;
+    stream->len = 0;
+    stream->cap = 0;
+    stream->n_threads = 1;
+
+    return stream;
+}
+
+//! Appends a stage to a stream.
+static int stream_push(darray_stream *stream, struct stream_stage stage) {
+    if (stream->len == stream->cap) {
+        size_t cap = stream->cap > 0 ? stream->cap * 2 : 4;
+        struct stream_stage *stage_arr =
+            realloc(stream->stage_arr, sizeof(struct stream_stage) * cap);
+        if (stage_arr == NULL) {
+            darray_errno = DARRAY_EALLOC;
+            PROBE0(alloc__fail);
+            return 0;
+        }
+        stream->stage_arr = stage_arr;
+        stream->cap = cap;
+    }
+    stream->stage_arr[stream->len++] = stage;
+
+    return 1;
+}
+
+int darray_stream_map(darray_stream *stream, unary fp, consumer item_free) {
+    if (stream == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    struct stream_stage stage = {
+        .kind = STAGE_MAP, .map = fp, .item_free = item_free
+    };
+    return stream_push(stream, stage);
+}
+
+int darray_stream_filter(darray_stream *stream, predicate fp) {
+    if (stream == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    struct stream_stage stage = { .kind = STAGE_FILTER, .filter = fp };
+    return stream_push(stream, stage);
+}
+
+int darray_stream_take(darray_stream *stream, size_t n) {
+    if (stream == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    struct stream_stage stage = { .kind = STAGE_TAKE, .take = n };
+    return stream_push(stream, stage);
+}
+
+int darray_stream_set_threads(darray_stream *stream, size_t n) {
+    if (stream == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (n == 0) {
+        darray_errno = DARRAY_EINDEX;
+        return 0;
+    }
+
+    stream->n_threads = n;
+
+    return 1;
+}
+
+darray *darray_stream_collect(darray_stream *stream) {
+    if (stream == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+
+    size_t n = stream_threads(stream);
+    struct stream_pass *pass_arr = stream_passes(stream, n, 1);
+    if (pass_arr == NULL) {
+        return NULL;
+    }
+    run_passes(pass_arr, sizeof(struct stream_pass), n, stream_pass_run);
+
+    // Results of later passes are moved to the first pass in order.
+    int failed = 0;
+    for (size_t t = 0; t < n; t++) {
+        failed |= pass_arr[t].failed;
+    }
+    darray *out = pass_arr[0].out;
+    for (size_t t = 1; t < n && !failed; t++) {
+        if (darray_extend(out, pass_arr[t].out)) {
+            pass_arr[t].out->len = 0;
+        } else {
+            failed = 1;
+        }
+    }
+    if (failed) {
+        darray_errno = DARRAY_EALLOC;
+        stream_passes_free(pass_arr, n);
+        return NULL;
+    }
+    pass_arr[0].out = NULL;
+    stream_passes_free(pass_arr, n);
+
+    return out;
+}
+
+int darray_stream_aggregate(darray_stream *stream, void *resp, aggregate fp) {
+    if (stream == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    struct stream_pass *pass_arr = stream_passes(stream, 1, 0);
+    if (pass_arr == NULL) {
+        return 0;
+    }
+    pass_arr->resp = resp;
+    pass_arr->fp = fp;
+    stream_pass_run(pass_arr);
+    stream_passes_free(pass_arr, 1);
+
+    return 1;
+}
+
+int del_darray_stream(darray_stream *stream) {
+    if (stream == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    free(stream->stage_arr);
+    free(stream);
+
+    return 1;
+}
+
+//! Represents a group found by a pass of `darray_group_by`.
+struct group_entry {
+    /*! The hash value of the key of the group. */
+    size_t hash;
+    /*! Points to the key of the first item in the group. */
+    const void *key_ptr;
+    /*! Points to the result of the group, or `NULL` once it is moved. */
+    void *group;
+};
+
+//! Represents a pass of a grouping over a range of items.
+/*!
+Each pass builds its own table of groups, so passes on different threads share
+nothing until their tables are merged. Hashed groups are kept in the order their
+keys first appear, and are found through an open addressing table of their
+positions. Dense groups are kept directly at their keys.
+*/
+struct group_pass {
+    /*! Points to the array being grouped. */
+    darray *array;
+    /*! The index of the first item of the range. */
+    size_t start;
+    /*! The index after the last item of the range. */
+    size_t end;
+    /*! Points to a function that extracts the key of an item. */
+    unary key;
+    /*! Points to a function that hashes a key. */
+    hasher hash;
+    /*! Points to a function that compares two keys. */
+    comparator cmp;
+    /*! Points to a function that returns the dense key of an item. */
+    keyer dense;
+    /*! The number of dense keys. */
+    size_t range;
+    /*! Points to a function that creates the result of a new group. */
+    unary init;
+    /*! Points to a function that adds an item to the result of its group. */
+    aggregate step;
+    /*! Points to the hashed groups in the order their keys first appear. */
+    struct group_entry *entry_arr;
+    /*! The number of hashed groups. */
+    size_t len;
+    /*! The capacity of the group array. */
+    size_t cap;
+    /*! Points to the positions of hashed groups, or `SIZE_MAX` if empty. */
+    size_t *slot_arr;
+    /*! The number of slots, which is zero or a power of two. */
+    size_t n_slots;
+    /*! Points to the result of each dense key, or `NULL` if it has none. */
+    void **dense_arr;
+    /*! The error of the pass, or 0 if successful. */
+    int err;
+};
+
+//! Makes room for a given number of hashed groups in a pass.
+/*!
+The slot table is kept at most half full, and is rebuilt from the groups if it
+grows.
+
+\returns 1 if successful, 0 otherwise.
+*/
+static int group_reserve(struct group_pass *pass, size_t len) {
+    if (len > pass->cap) {
+        size_t cap = pass->cap > 0 ? pass->cap * 2 : 8;
+        struct group_entry *entry_arr =
+            realloc(pass->entry_arr, sizeof(struct group_entry) * cap);
+        if (entry_arr == NULL) {
+            return 0;
+        }
+        pass->entry_arr = entry_arr;
+        pass->cap = cap;
+    }
+    if (len * 2 <= pass->n_slots) {
+        return 1;
+    }
+
+    size_t n_slots = pass->n_slots > 0 ? pass->n_slots * 2 : 16;
+    size_t *slot_arr = malloc(sizeof(size_t) * n_slots);
+    if (slot_arr == NULL) {
+        return 0;
+    }
+    for (size_t i = 0; i < n_slots; i++) {
+        slot_arr[i] = SIZE_MAX;
+    }
+    for (size_t g = 0; g < pass->len; g++) {
+        size_t i = pass->entry_arr[g].hash & (n_slots - 1);
+        while (slot_arr[i] != SIZE_MAX) {
+            i = (i + 1) & (n_slots - 1);
+        }
+        slot_arr[i] = g;
+    }
+    free(pass->slot_arr);
+    pass->slot_arr = slot_arr;
+    pass->n_slots = n_slots;
+
+    return 1;
+}
+
+//! Returns the slot of a key in a pass, which is empty if it has no group yet.
+static size_t group_slot(const struct group_pass *pass, size_t hash,
+                         const void *key_ptr) {
+    size_t mask = pass->n_slots - 1;
+    size_t i = hash & mask;
+    while (pass->slot_arr[i] != SIZE_MAX) {
+        const struct group_entry *entry = pass->entry_arr + pass->slot_arr[i];
+        if (entry->hash == hash && pass->cmp(entry->key_ptr, key_ptr) == 0) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+//! Adds each item of the range of a pass to the result of its group.
+static void *group_pass_run(void *p) {
+    struct group_pass *pass = p;
+    void **item_ptr_arr = pass->array->item_ptr_arr;
+
+    for (size_t i = pass->start; i < pass->end; i++) {
+        void *item_ptr = item_ptr_arr[i];
+        void *group;
+        if (pass->dense != NULL) {
+            uint64_t k = pass->dense(item_ptr);
+            if (k >= pass->range) {
+                pass->err = DARRAY_EINDEX;
+                break;
+            }
+            group = pass->dense_arr[k];
+            if (group == NULL &&
+                    (group = pass->dense_arr[k] = pass->init(&k)) == NULL) {
+                pass->err = DARRAY_EALLOC;
+                break;
+            }
+        } else {
+            if (!group_reserve(pass, pass->len + 1)) {
+                pass->err = DARRAY_EALLOC;
+                break;
+            }
+            const void *key_ptr = pass->key(item_ptr);
+            size_t hash = pass->hash(key_ptr);
+            size_t s = group_slot(pass, hash, key_ptr);
+            if (pass->slot_arr[s] == SIZE_MAX) {
+                if ((group = pass->init(key_ptr)) == NULL) {
+                    pass->err = DARRAY_EALLOC;
+                    break;
+                }
+                pass->slot_arr[s] = pass->len;
+                pass->entry_arr[pass->len++] = (struct group_entry) {
+                    .hash = hash, .key_ptr = key_ptr, .group = group
+                };
+            } else {
+                group = pass->entry_arr[pass->slot_arr[s]].group;
+            }
+        }
+        pass->step(item_ptr, group);
+    }
+
+    return NULL;
+}
+
+//! Merges the groups of a pass into another pass.
+/*!
+Groups whose keys are new to the other pass are moved to it, in the order their
+keys first appear. The rest are merged into the group with the same key, then
+freed.
+
+\returns 1 if successful, 0 otherwise.
+*/
+static int group_merge(struct group_pass *into, struct group_pass *from,
+                       aggregate merge, consumer group_free) {
+    if (into->dense != NULL) {
+        for (size_t k = 0; k < into->range; k++) {
+            void *group = from->dense_arr[k];
+            if (group == NULL) {
+                continue;
+            }
+            if (into->dense_arr[k] == NULL) {
+                into->dense_arr[k] = group;
+            } else {
+                merge(group, into->dense_arr[k]);
+                if (group_free != NULL) {
+                    group_free(group);
+                }
+            }
+            from->dense_arr[k] = NULL;
+        }
+        return 1;
+    }
+
+    for (size_t g = 0; g < from->len; g++) {
+        struct group_entry *entry = from->entry_arr + g;
+        if (!group_reserve(into, into->len + 1)) {
+            return 0;
+        }
+        size_t s = group_slot(into, entry->hash, entry->key_ptr);
+        if (into->slot_arr[s] == SIZE_MAX) {
+            into->slot_arr[s] = into->len;
+            into->entry_arr[into->len++] = *entry;
+        } else {
+            merge(entry->group, into->entry_arr[into->slot_arr[s]].group);
+            if (group_free != NULL) {
+                group_free(entry->group);
+            }
+        }
+        entry->group = NULL;
+    }
+    return 1;
+}
+
+//! Deallocates the passes of a grouping and the groups they still hold.
+static void group_passes_free(struct group_pass *pass_arr, size_t n,
+                              consumer group_free) {
+    for (size_t t = 0; t < n; t++) {
+        struct group_pass *pass = pass_arr + t;
+        if (group_free != NULL) {
+            for (size_t g = 0; g < pass->len; g++) {
+                if (pass->entry_arr[g].group != NULL) {
+                    group_free(pass->entry_arr[g].group);
+                }
+            }
+            for (size_t k = 0; pass->dense_arr != NULL && k < pass->range;
+                    k++) {
+                if (pass->dense_arr[k] != NULL) {
+                    group_free(pass->dense_arr[k]);
+                }
+            }
+        }
+        free(pass->entry_arr);
+        free(pass->slot_arr);
+        free(pass->dense_arr);
+    }
+    free(pass_arr);
+}
+
+//! Groups the items of an array and collects the results of the groups.
+/*!
+The array is split into evenly sized ranges of at least 1024 items, one per
+thread. Each range is grouped into its own table, and the tables are merged into
+the first one at the end.
+
+\param proto A pointer to a pass with the functions of the grouping set.
+\returns A new array of the results, or `NULL` if unsuccessful.
+*/
+static darray *group_by(const struct group_pass *proto, aggregate merge,
+                        consumer group_free, size_t n_threads) {
+    size_t len = proto->array->len;
+    size_t n = n_threads < len / 1024 ? n_threads : len / 1024;
+    if (n == 0) {
+        n = 1;
+    }
+
+    struct group_pass *pass_arr = calloc(n, sizeof(struct group_pass));
+    if (pass_arr == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
+        return NULL;
+    }
+    int err = 0;
+    for (size_t t = 0; t < n; t++) {
+        pass_arr[t] = *proto;
+        pass_arr[t].start = len * t / n;
+        pass_arr[t].end = len * (t + 1) / n;
+        if (proto->dense != NULL) {
+            pass_arr[t].dense_arr = calloc(proto->range, sizeof(void *));
+            if (pass_arr[t].dense_arr == NULL) {
+                err = DARRAY_EALLOC;
+            }
+        }
+    }
+    if (!err) {
+        run_passes(pass_arr, sizeof(struct group_pass), n, group_pass_run);
+    }
+    for (size_t t = 0; t < n && !err; t++) {
+        err = pass_arr[t].err;
+    }
+    for (size_t t = 1; t < n && !err; t++) {
+        if (!group_merge(pass_arr, pass_arr + t, merge, group_free)) {
+            err = DARRAY_EALLOC;
+        }
+    }
+
+    darray *result = NULL;
+    if (!err) {
+        struct group_pass *pass = pass_arr;
+        size_t n_groups = pass->len;
+        for (size_t k = 0; pass->dense_arr != NULL && k < pass->range; k++) {
+            n_groups += pass->dense_arr[k] != NULL;
+        }
+        result = new_darray(group_free);
+        if (result == NULL || !darray_resize(result, n_groups)) {
+            if (result != NULL) {
+                del_darray(result);
+                result = NULL;
+            }
+            err = DARRAY_EALLOC;
+        } else {
+            for (size_t g = 0; g < pass->len; g++) {
+                result->item_ptr_arr[result->len++] = pass->entry_arr[g].group;
+            }
+            for (size_t k = 0; pass->dense_arr != NULL && k < pass->range;
+                    k++) {
+                if (pass->dense_arr[k] != NULL) {
+                    result->item_ptr_arr[result->len++] = pass->dense_arr[k];
+                }
+            }
+            pass->len = 0;
+            free(pass->dense_arr);
+            pass->dense_arr = NULL;
+        }
+    }
+    group_passes_free(pass_arr, n, group_free);
+
+    if (err) {
+        darray_errno = err;
+        if (err == DARRAY_EALLOC) {
+            PROBE0(alloc__fail);
+        }
+    }
+    return result;
+}
+
+darray *darray_group_by(darray *array, unary key, hasher hash, comparator cmp,
+                        unary init, aggregate step, aggregate merge,
+                        consumer group_free, size_t n_threads) {
+    if (array == NULL || key == NULL || hash == NULL || cmp == NULL ||
+            init == NULL || step == NULL || (merge == NULL && n_threads > 1)) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+    if (n_threads == 0) {
+        darray_errno = DARRAY_EINDEX;
+        return NULL;
+    }
+
+    struct group_pass proto = {
+        .array = array, .key = key, .hash = hash, .cmp = cmp,
+        .init = init, .step = step
+    };
+    return group_by(&proto, merge, group_free, n_threads);
+}
+
+darray *darray_group_by_dense(darray *array, keyer key, size_t range,
+                              unary init, aggregate step, aggregate merge,
+                              consumer group_free, size_t n_threads) {
+    if (array == NULL || key == NULL || init == NULL || step == NULL ||
+            (merge == NULL && n_threads > 1)) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+    if (range == 0 || n_threads == 0) {
+        darray_errno = DARRAY_EINDEX;
+        return NULL;
+    }
+
+    struct group_pass proto = {
+        .array = array, .dense = key, .range = range,
+        .init = init, .step = step
+    };
+    return group_by(&proto, merge, group_free, n_threads);
+}
+
+//! Represents the items of a build side that share a key in a hash join.
+struct join_slot {
+    /*! The hash value of the key. */
+    size_t hash;
+    /*! Points to the key of the first item. */
+    const void *key_ptr;
+    /*! The index of the first item with the key, or `SIZE_MAX` if empty. */
+    size_t head;
+    /*! The index of the last item with the key. */
+    size_t tail;
+};
+
+//! Joins two arrays by probing a hash table of the build side.
+/*!
+Items of the build side with equal keys share one slot and are chained in their
+order, so each probe compares keys once per distinct key it passes.
+
+\param swap Whether the build side is the right array, in which case pairs are
+emitted with their items swapped back.
+*/
+static int hash_join(darray *build, darray *probe, unary build_key,
+                     unary probe_key, hasher hash, comparator cmp, joiner emit,
+                     void *ctx, int swap) {
+    size_t cap = 16;
+    while (cap < build->len * 2) {
+        cap *= 2;
+    }
+    size_t mask = cap - 1;
+    struct join_slot *slot_arr = malloc(sizeof(struct join_slot) * cap);
+    size_t *next_arr = malloc(sizeof(size_t) * (build->len + 1));
+    if (slot_arr == NULL || next_arr == NULL) {
+        free(slot_arr);
+        free(next_arr);
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
+        return 0;
+    }
+    for (size_t s = 0; s < cap; s++) {
+        slot_arr[s].head = SIZE_MAX;
+    }
+
+    for (size_t i = 0; i < build->len; i++) {
+        const void *key_ptr = build_key(build->item_ptr_arr[i]);
+        size_t h = hash(key_ptr);
+        size_t s = h & mask;
+        while (slot_arr[s].head != SIZE_MAX &&
+                (slot_arr[s].hash != h || cmp(slot_arr[s].key_ptr, key_ptr))) {
+            s = (s + 1) & mask;
+        }
+        next_arr[i] = SIZE_MAX;
+        if (slot_arr[s].head == SIZE_MAX) {
+            slot_arr[s].hash = h;
+            slot_arr[s].key_ptr = key_ptr;
+            slot_arr[s].head = i;
+        } else {
+            next_arr[slot_arr[s].tail] = i;
+        }
+        slot_arr[s].tail = i;
+    }
+
+    for (size_t j = 0; j < probe->len; j++) {
+        void *item_ptr = probe->item_ptr_arr[j];
+        const void *key_ptr = probe_key(item_ptr);
+        size_t h = hash(key_ptr);
+        size_t s = h & mask;
+        while (slot_arr[s].head != SIZE_MAX &&
+                (slot_arr[s].hash != h || cmp(slot_arr[s].key_ptr, key_ptr))) {
+            s = (s + 1) & mask;
+        }
+        if (slot_arr[s].head == SIZE_MAX) {
+            continue;
+        }
+        for (size_t i = slot_arr[s].head; i != SIZE_MAX; i = next_arr[i]) {
+            if (swap) {
+                emit(item_ptr, build->item_ptr_arr[i], ctx);
+            } else {
+                emit(build->item_ptr_arr[i], item_ptr, ctx);
+            }
+        }
+    }
+
+    free(slot_arr);
+    free(next_arr);
+
+    return 1;
+}
+
+int darray_hash_join(darray *left, darray *right, unary left_key,
+                     unary right_key, hasher hash, comparator cmp,
+                     joiner emit, void *ctx) {
+    if (left == NULL || right == NULL || left_key == NULL ||
+            right_key == NULL || hash == NULL || cmp == NULL || emit == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    if (left->len <= right->len) {
+        return hash_join(left, right, left_key, right_key, hash, cmp, emit,
+                         ctx, 0);
+    }
+    return hash_join(right, left, right_key, left_key, hash, cmp, emit, ctx,
+                     1);
+}
+
+int darray_merge_join(darray *left, darray *right, unary left_key,
+                      unary right_key, comparator cmp, joiner emit,
+                      void *ctx) {
+    if (left == NULL || right == NULL || left_key == NULL ||
+            right_key == NULL || cmp == NULL || emit == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    size_t i = 0, j = 0;
+    while (i < left->len && j < right->len) {
+        const void *key_ptr = right_key(right->item_ptr_arr[j]);
+        int c = cmp(left_key(left->item_ptr_arr[i]), key_ptr);
+        if (c < 0) {
+            i++;
+        } else if (c > 0) {
+            j++;
+        } else {
+            // The run of right items with the key is emitted with each left
+            // item of the same key.
+            size_t end = j + 1;
+            while (end < right->len &&
+                    cmp(right_key(right->item_ptr_arr[end]), key_ptr) == 0) {
+                end++;
+            }
+            do {
+                for (size_t k = j; k < end; k++) {
+                    emit(left->item_ptr_arr[i], right->item_ptr_arr[k], ctx);
+                }
+                i++;
+            } while (i < left->len &&
+                     cmp(left_key(left->item_ptr_arr[i]), key_ptr) == 0);
+            j = end;
+        }
+    }
+
+    return 1;
+}
+
+int darray_stats(darray *array, darray_stat *stat_ptr) {
+    if (stat_ptr == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+#ifdef DARRAY_STATS
+    if (array != NULL) {
+        *stat_ptr = array->stat;
+    } else {
+        stat_ptr->resizes = atomic_load_explicit(&darray_stat_global.resizes,
+                                                 memory_order_relaxed);
+        stat_ptr->bytes_moved = atomic_load_explicit(
+                &darray_stat_global.bytes_moved, memory_order_relaxed);
+        stat_ptr->cmp_calls = atomic_load_explicit(
+                &darray_stat_global.cmp_calls, memory_order_relaxed);
+        stat_ptr->item_frees = atomic_load_explicit(
+                &darray_stat_global.item_frees, memory_order_relaxed);
+        stat_ptr->peak_cap = atomic_load_explicit(
+                &darray_stat_global.peak_cap, memory_order_relaxed);
+    }
+#else
+    (void) array;
+    memset(stat_ptr, 0, sizeof(darray_stat));
+#endif
+
+    return 1;
+}
+
+#ifdef DARRAY_REGISTRY
+//! Returns the bytes of unused capacity in a registry row.
+static size_t row_wasted(const darray_registry_row *row) {
+    return row->cap > row->len ? sizeof(void *) * (row->cap - row->len) : 0;
+}
+
+//! Finds the live arrays that waste the most capacity.
+/*!
+The caller must hold `registry_lock`.
+*/
+static size_t registry_find(darray_registry_row *row_arr, size_t n) {
+    size_t found = 0;
+    for (darray *array = registry_head; array != NULL; array = array->next) {
+        darray_registry_row row = {
+            .id = array,
+            .len = atomic_load_explicit(&array->reg_len, memory_order_relaxed),
+            .cap = atomic_load_explicit(&array->reg_cap, memory_order_relaxed)
+        };
+        row.wasted = row_wasted(&row);
+        size_t i = found < n ? found++ : n;
+        for (; i > 0 && row_arr[i - 1].wasted < row.wasted; i--) {
+            if (i < n) {
+                row_arr[i] = row_arr[i - 1];
+            }
+        }
+        if (i < n) {
+            row_arr[i] = row;
+        }
+    }
+    return found;
+}
+#endif
+
+size_t darray_registry_top(darray_registry_row *row_arr, size_t n) {
+    if (row_arr == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    size_t found = 0;
+#ifdef DARRAY_REGISTRY
+    pthread_mutex_lock(&registry_lock);
+    found = registry_find(row_arr, n);
+    pthread_mutex_unlock(&registry_lock);
+#else
+    (void) n;
+#endif
+
+    return found;
+}
+
+int darray_registry_dump(FILE *stream, size_t n) {
+    if (stream == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    darray_registry_row *row_arr =
+        malloc(sizeof(darray_registry_row) * (n > 0 ? n : 1));
+    if (row_arr == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        PROBE0(alloc__fail);
+        return 0;
+    }
+    size_t found = darray_registry_top(row_arr, n);
+    fprintf(stream, "%-18s %12s %12s %14s\n",
+            "array", "len", "cap", "wasted bytes");
+    for (size_t i = 0; i < found; i++) {
+        fprintf(stream, "%-18p %12zu %12zu %14zu\n", row_arr[i].id,
+                row_arr[i].len, row_arr[i].cap, row_arr[i].wasted);
+    }
+    free(row_arr);
 
     return 1;
 }
@@ -427,7 +3689,9 @@ static const char *const darray_strerr_list[] = {
     [DARRAY_EALLOC] = "fail to allocate memory",
     [DARRAY_ENULLS] = "invalid NULL argument",
     [DARRAY_EINDEX] = "invalid index",
-    [DARRAY_ENOTIN] = "item does not exist"
+    [DARRAY_ENOTIN] = "item does not exist",
+    [DARRAY_ESHAPE] = "incompatible shape",
+    [DARRAY_EIO] = "fail to read or write a file"
 };
 
 int darray_geterr() {
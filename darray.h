@@ -9,8 +9,14 @@
 #define DARRAY_H
 
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <sys/types.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 //! The consumer function pointer type definition.
 /*!
 A function of this type should take in a pointer to some object and perform
@@ -30,6 +36,30 @@ void print_int(void *p) {
 */
 typedef void (*consumer)(void *item_ptr);
 
+//! The bulk consumer function pointer type definition.
+/*!
+A function of this type should take in an array of pointers to objects and
+consume all of them at once, typically by freeing them. It should not modify
+the array of pointers itself.
+
+\param item_ptr_arr An array of pointers to objects.
+\param n The number of pointers in the array.
+
+\see Typically used with `darray_set_bulk_free`.
+
+An example of a bulk consumer function pointer is a function that returns
+objects to a free list in a single step:
+```
+void node_bulk_free(void **item_ptr_arr, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        ((node *) item_ptr_arr[i])->next = i + 1 < n ? item_ptr_arr[i + 1] : pool;
+    }
+    pool = item_ptr_arr[0];
+}
+```
+*/
+typedef void (*bulk_consumer)(void **item_ptr_arr, size_t n);
+
 //! The aggregate function pointer type definition.
 /*!
 A function of this type should take in a pointer to some object and modifies
@@ -111,9 +141,181 @@ void *identity(const void *p) { return p; }
 */
 typedef void *(*unary)(const void *item_ptr);
 
+//! The hasher function pointer type definition.
+/*!
+A function of this type should take in a pointer to some key and return its
+hash value. Keys that compare equal must have the same hash value. It should not
+modify the key.
+
+\param key_ptr A pointer to some key.
+\returns The hash value of the key.
+
+\see Typically used with `new_darray_index`.
+
+An example of a hasher function pointer is a function that hashes a string with
+the FNV-1a algorithm:
+```
+size_t str_hash(const void *p) {
+    size_t hash = 14695981039346656037u;
+    for (const char *s = p; *s != '\0'; s++) {
+        hash = (hash ^ (unsigned char) *s) * 1099511628211u;
+    }
+    return hash;
+}
+```
+*/
+typedef size_t (*hasher)(const void *key_ptr);
+
+//! The keyer function pointer type definition.
+/*!
+A function of this type should take in a pointer to some object and return an
+unsigned integer key of that object. Objects are ordered by their keys from the
+smallest to the biggest. It should not modify the object.
+
+\param item_ptr A pointer to some object.
+\returns The key of the object.
+
+\see Typically used with `darray_sort_by_key`.
+
+An example of a keyer function pointer is a function that returns a signed
+integer as a key. Flipping the sign bit keeps negative numbers before positive
+ones:
+```
+uint64_t int_key(const void *p) {
+    return (uint64_t) *((int *) p) ^ (UINT64_C(1) << 63);
+}
+```
+*/
+typedef uint64_t (*keyer)(const void *item_ptr);
+
+//! The sizer function pointer type definition.
+/*!
+A function of this type should take in a pointer to some object and return the
+number of bytes allocated for that object and its components. It should not
+modify the object.
+
+\param item_ptr A pointer to some object.
+\returns The number of bytes used by the object.
+
+\see Typically used with `darray_memory_usage`.
+
+An example of a sizer function pointer is a function that returns the size of a
+heap allocated string including its terminator:
+```
+size_t str_size(const void *p) {
+    return strlen(p) + 1;
+}
+```
+*/
+typedef size_t (*sizer)(const void *item_ptr);
+
+//! The predicate function pointer type definition.
+/*!
+A function of this type should take in a pointer to some object and return
+whether the object satisfies some condition. It should not modify the object.
+
+\param item_ptr A pointer to some object.
+\returns A non-zero value if the object satisfies the condition, 0 otherwise.
+
+\see Typically used with `darray_stream_filter`.
+
+An example of a predicate function pointer is a function that checks whether an
+integer is even:
+```
+int is_even(const void *p) {
+    return *((int *) p) % 2 == 0;
+}
+```
+*/
+typedef int (*predicate)(const void *item_ptr);
+
+//! The tracker function pointer type definition.
+/*!
+A function of this type should take in a pointer to some object and the index
+it has just moved to, and record that index somewhere, typically in the object
+itself. It should not modify the ordering of the object.
+
+\param item_ptr A pointer to some object.
+\param index The new index of the object in the array.
+
+\see Typically used with `darray_heap_push` and `darray_heap_update`.
+
+An example of a tracker function pointer is a function that stores the position
+of a task in a ready queue:
+```
+void track_task(void *p, size_t index) {
+    ((task *) p)->pos = index;
+}
+```
+*/
+typedef void (*tracker)(void *item_ptr, size_t index);
+
+//! The joiner function pointer type definition.
+/*!
+A function of this type should take in a pair of objects with equal keys, one
+from each array of a join, and a pointer to some context given by the caller.
+It should not modify the keys of the objects.
+
+\param item_ptr1 A pointer to an object of the left array.
+\param item_ptr2 A pointer to an object of the right array.
+\param ctx A pointer to the context passed to the join.
+
+\see Typically used with `darray_hash_join` and `darray_merge_join`.
+
+An example of a joiner function pointer is a function that prints the courses
+students are enrolled in:
+```
+void print_enrollment(void *p1, void *p2, void *ctx) {
+    fprintf(ctx, "%s %s\n", ((student *) p1)->name, ((course *) p2)->title);
+}
+```
+*/
+typedef void (*joiner)(void *item_ptr1, void *item_ptr2, void *ctx);
+
+//! The context-carrying function pointer type definitions.
+/*!
+Functions of these types behave like their counterparts without the `_r`
+suffix, but take in an extra pointer to some context given by the caller. The
+context makes it possible to parametrize a callback without global state, so
+the same callback can be used by multiple threads at once.
+
+\see Used by `darray_foreach_r`, `darray_aggregate_r`, `darray_search_r`,
+`darray_remove_if_r`, `darray_sort_r` and `darray_clone_r`.
+
+An example of a context comparator that orders students by one of their scores,
+chosen by the caller:
+```
+int score_cmp(const void *p1, const void *p2, void *ctx) {
+    size_t subject = *((size_t *) ctx);
+    int x = ((student *) p1)->scores[subject];
+    int y = ((student *) p2)->scores[subject];
+    return (x > y) - (x < y);
+}
+```
+*/
+typedef void (*consumer_r)(void *item_ptr, void *ctx);
+//! \copydoc consumer_r
+typedef void (*aggregate_r)(const void *item_ptr, void *resp, void *ctx);
+//! \copydoc consumer_r
+typedef int (*comparator_r)(const void *item_ptr1, const void *item_ptr2,
+                            void *ctx);
+//! \copydoc consumer_r
+typedef void *(*unary_r)(const void *item_ptr, void *ctx);
+//! \copydoc consumer_r
+typedef int (*predicate_r)(const void *item_ptr, void *ctx);
+
 //! Represents a dynamic array.
 typedef struct darray darray;
 
+//! Represents a secondary hash index over a dynamic array.
+typedef struct darray_index darray_index;
+
+//! Represents an ordered view of a dynamic array.
+typedef struct darray_view darray_view;
+
+//! Represents a lazy pipeline over the items of a dynamic array.
+typedef struct darray_stream darray_stream;
+
 //! The size of the dynamic array structure.
 /*!
 Use this instead of `sizeof(darray)` because the dynamic array structure
@@ -132,6 +334,10 @@ typedef enum {
     DARRAY_EINDEX,
     /*! Item does not exist. */
     DARRAY_ENOTIN,
+    /*! Incompatible matrix dimensions or entry size. */
+    DARRAY_ESHAPE,
+    /*! Fail to read or write a file. */
+    DARRAY_EIO,
 } darray_error;
 
 //! The error number.
@@ -158,6 +364,22 @@ original array.
 */
 darray *new_darray(consumer item_free);
 
+//! Creates a dynamic array over an existing pointer array.
+/*!
+This function allocates a new dynamic array that takes over a pointer array
+allocated with `malloc`, so an array of known length can be built with a single
+allocation of the right size.
+
+\param item_free A pointer to a function that frees an item.
+\param item_ptr_arr A pointer to an allocated array of at least `len` item
+pointers, and at least one.
+\param len The number of items in the pointer array.
+\returns A new dynamic array object, or `NULL` if unsuccessful, in which case
+the pointer array still belongs to the caller.
+\see To deallocate the dynamic array, use `del_darray`.
+*/
+darray *new_darray_from(consumer item_free, void **item_ptr_arr, size_t len);
+
 //!Sets the free function.
 /*!
 This function sets the function pointer that frees the item if the item pointer
@@ -173,6 +395,22 @@ setting `item_free` to `NULL` and back.
 */
 int darray_set_item_free(darray *array, consumer item_free);
 
+//! Setter for the function that frees a range of items at once.
+/*!
+If set, functions that remove several items, such as `darray_clear`,
+`darray_pop_range`, `darray_remove_if` and `del_darray`, hand all of them to
+this function in a single call instead of calling `item_free` on each.
+
+\param array A pointer to a dynamic array.
+\param bulk_free A pointer to a function that frees a range of items, or `NULL`
+to free items one by one.
+\return 1 if successful, 0 otherwise.
+
+\note The bulk free function is only used while `item_free` is not `NULL`, so
+setting `item_free` to `NULL` still disables de-allocation of items.
+*/
+int darray_set_bulk_free(darray *array, bulk_consumer bulk_free);
+
 //! Getter for the length of the array.
 /*!
 This function returns the number of items in a given array. Returns 0 if the
@@ -184,6 +422,32 @@ argument is `NULL`.
 */
 size_t darray_len(darray *array);
 
+//! Getter for the capacity of the array.
+/*!
+This function returns the number of items a given array can hold before it has
+to grow. Returns 0 if the argument is `NULL`.
+
+\param array A pointer to a dynamic array.
+\returns The capacity of a given array.
+\note This function does not set `darray_errno` even if the argument is `NULL`.
+*/
+size_t darray_capacity(darray *array);
+
+//! Returns the number of bytes of memory used by an array.
+/*!
+This function adds up the memory allocated for the array structure, the full
+capacity of its pointer array, its secondary indices and ordered views, and, if
+a sizer function is given, every item in the array.
+
+\param array A pointer to a dynamic array.
+\param fp A pointer to a function that returns the size of an item, or `NULL`
+to leave items out.
+\returns The number of bytes used, or 0 if unsuccessful.
+
+\note The sizes do not include the overhead of the memory allocator.
+*/
+size_t darray_memory_usage(darray *array, sizer fp);
+
 //! Calls each item in the array with a given function.
 /*!
 This function calls the given function with every object in the array
@@ -195,6 +459,17 @@ sequentially.
 */
 int darray_foreach(darray *array, consumer fp);
 
+//! Calls each item in the array with a given function and context.
+/*!
+The same as `darray_foreach`, except that the context is passed to every call.
+
+\param array A pointer to a dynamic array.
+\param fp A pointer to a function that takes an item and the context.
+\param ctx A pointer to the context.
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_foreach_r(darray *array, consumer_r fp, void *ctx);
+
 //! Aggregates all items into a single result.
 /*!
 This function calls the aggregation function with every item in the array as the
@@ -208,6 +483,19 @@ first argument, and the result pointer as the second argument.
 */
 int darray_aggregate(darray *array, void *resp, aggregate fp);
 
+//! Aggregates all items into a single result with a given context.
+/*!
+The same as `darray_aggregate`, except that the context is passed to every call.
+
+\param array A pointer to a dynamic array.
+\param resp A pointer to the result object.
+\param fp A pointer to a function that takes an item, the result and the
+context.
+\param ctx A pointer to the context.
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_aggregate_r(darray *array, void *resp, aggregate_r fp, void *ctx);
+
 //! Appends an item to the array.
 /*!
 This function appends an item to the end of an array.
@@ -232,6 +520,39 @@ index is out of range.
 */
 void *darray_get(darray *array, size_t index);
 
+//! Gets the pointer array of an array.
+/*!
+This function returns the array of item pointers backing a given array, so that
+the items can be visited or rearranged without a function call per item. If the
+array shares its items with copy-on-write clones, it gets its own copy first.
+
+\param array A pointer to a dynamic array.
+\returns A pointer to the first of `darray_len` item pointers if successful,
+`NULL` otherwise.
+
+\note The returned pointer is invalidated by any function that changes the
+length of the array. Secondary indices and ordered views of the array are marked
+as stale, since the items may be rearranged through the pointer.
+*/
+void **darray_data(darray *array);
+
+//! Gets the pointer array of an array for reading.
+/*!
+This function returns the array of item pointers backing a given array without
+changing the array. Unlike `darray_data`, it does not copy items shared with
+copy-on-write clones and does not mark secondary indices or ordered views as
+stale, so the pointer array must not be written through.
+
+\param array A pointer to a dynamic array.
+\returns A pointer to the first of `darray_len` item pointers if successful,
+`NULL` otherwise.
+
+\note The returned pointer is invalidated by any function that changes the
+array. The items may be shared with copy-on-write clones, so they must not be
+modified through the pointer either.
+*/
+void *const *darray_cdata(darray *array);
+
 //! Pops an item at a given index.
 /*!
 This function pops the item at a given index from an array.
@@ -310,6 +631,32 @@ printf("42 at index %zu.", index);
 int darray_search(
         darray *array, void *item_ptr, comparator fp, size_t *idx_ptr);
 
+//! Searches for the first item in an array that satisfies a predicate.
+/*!
+The predicate is called with an array item and the context, which typically
+holds the key to search for. Stores the index of the first item it accepts in
+the index pointer.
+
+\param array A pointer to a dynamic array.
+\param fp A pointer to a predicate function that takes an item and the
+context.
+\param ctx A pointer to the context.
+\param idx_ptr A pointer to store the index of found item.
+\returns 1 if there is a match, or 0 otherwise.
+
+For example, to find a student with a given id:
+```
+int has_id(const void *p, void *ctx) {
+    return ((student *) p)->id == *((int *) ctx);
+}
+
+int id = 42;
+size_t index;
+darray_search_r(students, has_id, &id, &index);
+```
+*/
+int darray_search_r(darray *array, predicate_r fp, void *ctx, size_t *idx_ptr);
+
 //! Extends another array to the end of a given array.
 /*!
 In the order of their index, append each item in the second array to the end of
@@ -356,6 +703,51 @@ given comparator function. The function performs the above **in place**.
 */
 int darray_unique(darray *array, comparator fp);
 
+//! Removes all items that satisfy a predicate.
+/*!
+The items are removed in a single pass that moves each kept item at most once,
+and the array is resized once at the end. The kept items stay in order. Removed
+items are freed with the free function of the array.
+
+\param array A pointer to a dynamic array.
+\param fp A pointer to a predicate function that selects the items to remove.
+\returns 1 if successful, 0 otherwise.
+
+An example of purging all expired entries of a cache:
+```
+darray_remove_if(cache, entry_is_expired);
+```
+*/
+int darray_remove_if(darray *array, predicate fp);
+
+//! Removes all items that satisfy a predicate with a given context.
+/*!
+The same as `darray_remove_if`, except that the context is passed to every call
+of the predicate, e.g. the current time to purge expired entries.
+
+\param array A pointer to a dynamic array.
+\param fp A pointer to a predicate function that takes an item and the context.
+\param ctx A pointer to the context.
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_remove_if_r(darray *array, predicate_r fp, void *ctx);
+
+//! Partitions the array by a predicate.
+/*!
+The items are reordered **in place** so that the items that satisfy a given
+predicate come before the ones that do not. The index of the first item that
+does not satisfy the predicate is stored in the location given by `index_ptr`.
+
+\param array A pointer to a dynamic array.
+\param fp A pointer to a predicate function.
+\param index_ptr A pointer to the location to store the split index.
+\returns 1 if successful, 0 otherwise.
+
+\note The partition is not stable. The items within each part may not keep
+their relative order.
+*/
+int darray_partition(darray *array, predicate fp, size_t *index_ptr);
+
 //! Sorts a given array.
 /*!
 Sorts all items in the given array **in place** using a quick sort algorithm.
@@ -369,6 +761,266 @@ The sorting algorithm is adopted from [Quick Sort.c] by adwiteeya3 on GitHub.
 */
 int darray_sort(darray *array, comparator fp);
 
+//! Sorts a given array with a context comparator.
+/*!
+The same as `darray_sort`, except that the context is passed to every call of
+the comparator.
+
+\param array A pointer to a dynamic array.
+\param fp A pointer to a function that compares two items given the context.
+\param ctx A pointer to the context.
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_sort_r(darray *array, comparator_r fp, void *ctx);
+
+//! Sorts a given array by an integer key.
+/*!
+Sorts all items in the given array **in place** by the keys returned by a given
+function, using a least significant digit radix sort. The sort is stable, so
+items with equal keys keep their relative order.
+
+Each key is computed only once and stored next to its item, so the items are not
+accessed again while sorting. This is usually several times faster than
+`darray_sort` for large arrays, at the cost of a temporary buffer of four
+pointers per item.
+
+\param array A pointer to a dynamic array.
+\param fp A pointer to a function that returns the key of an item.
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_sort_by_key(darray *array, keyer fp);
+
+//! Sorts a given array using cached key prefixes.
+/*!
+Sorts all items in the given array **in place** like `darray_sort`, but first
+orders them by a compact integer prefix of their keys. The prefixes are computed
+once and sorted in a contiguous buffer, so most comparisons never touch the
+items. The comparator is only called to order items with equal prefixes.
+
+The prefix must agree with the comparator: if the prefix of one item is smaller
+than that of another, the comparator must find the first item smaller as well.
+
+\param array A pointer to a dynamic array.
+\param prefix A pointer to a function that returns the key prefix of an item.
+\param fp A pointer to a function that compares two items in the array.
+\returns 1 if successful, 0 otherwise.
+
+For example, the first eight characters of a string in big-endian order is a
+prefix that agrees with `strcmp`:
+```
+uint64_t name_prefix(const void *p) {
+    const unsigned char *name = (const unsigned char *) ((person *) p)->name;
+    uint64_t key = 0;
+    for (int i = 0; i < 8; i++) {
+        key = key << 8 | *name;
+        name += *name != '\0';
+    }
+    return key;
+}
+
+darray_sort_cached(people, name_prefix, person_cmp_name);
+```
+*/
+int darray_sort_cached(darray *array, keyer prefix, comparator fp);
+
+//! Partially sorts a given array so that one item is in its sorted position.
+/*!
+Rearranges the items **in place** so that the item at the given index is the one
+that would be there if the array were sorted. No item before it compares bigger,
+and no item after it compares smaller. The order of the other items is
+unspecified.
+
+The function uses introselect, which takes linear time on average and
+O(n log n) in the worst case.
+
+\param array A pointer to a dynamic array.
+\param index A valid index in the array.
+\param fp A pointer to a function that compares two items in the array.
+\returns 1 if successful, 0 otherwise.
+
+For example, to find the median of an array:
+```
+darray_nth_element(array, darray_len(array) / 2, integer_comparator);
+int *median = darray_get(array, darray_len(array) / 2);
+```
+*/
+int darray_nth_element(darray *array, size_t index, comparator fp);
+
+//! Sorts the smallest items of a given array.
+/*!
+Rearranges the items **in place** so that the first `k` items are the smallest
+ones of the array in sorted order. The order of the other items is unspecified.
+This takes O(n + k log k) time instead of O(n log n) for `darray_sort`.
+
+\param array A pointer to a dynamic array.
+\param k The number of items to sort, at most the length of the array.
+\param fp A pointer to a function that compares two items in the array.
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_partial_sort(darray *array, size_t k, comparator fp);
+
+//! Returns the smallest items of a given array.
+/*!
+This function returns a new array of the `k` smallest items of a given array in
+sorted order, without modifying the given array. It keeps a heap of `k` items,
+so it takes O(n log k) time and O(k) space. If the array has fewer than `k`
+items, all of them are returned.
+
+\param array A pointer to a dynamic array.
+\param k The number of items to return.
+\param fp A pointer to a function that compares two items in the array.
+\returns A new allocated dynamic array, or `NULL` if unsuccessful.
+
+\note The returned array is a shallow copy and has no free function. To get the
+biggest items instead, use a comparator with the reverse order.
+*/
+darray *darray_top_k(darray *array, size_t k, comparator fp);
+
+//! Rearranges a given array into a binary heap.
+/*!
+This function rearranges the items of a given array in place so that every item
+compares greater than or equal to its children, where the children of the item
+at index `i` are at indices `2i + 1` and `2i + 2`. The biggest item is then at
+index 0. It takes O(n) time.
+
+\param array A pointer to a dynamic array.
+\param fp A pointer to a function that compares two items in the array.
+\param track A pointer to a function that records the index of every item that
+moves, or `NULL` to not track indices.
+\returns 1 if successful, 0 otherwise.
+
+\note To get the smallest item at the root instead, use a comparator with the
+reverse order. The same comparator must be passed to every heap function.
+*/
+int darray_heapify(darray *array, comparator fp, tracker track);
+
+//! Pushes an item onto a binary heap.
+/*!
+This function appends an item to an array that is already a heap and restores
+the heap order in O(log n) time.
+
+\param array A pointer to a dynamic array ordered by `darray_heapify`.
+\param item_ptr A pointer to the item to push.
+\param fp A pointer to a function that compares two items in the array.
+\param track A pointer to a function that records the index of every item that
+moves, or `NULL` to not track indices.
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_heap_push(darray *array, void *item_ptr,
+                     comparator fp, tracker track);
+
+//! Pops the biggest item off a binary heap.
+/*!
+This function removes the item at index 0 of an array that is already a heap
+and restores the heap order in O(log n) time. The removed item is freed with the
+free function of the array.
+
+\param array A pointer to a dynamic array ordered by `darray_heapify`.
+\param fp A pointer to a function that compares two items in the array.
+\param track A pointer to a function that records the index of every item that
+moves, or `NULL` to not track indices.
+\returns 1 if successful, 0 otherwise.
+
+\note To keep the popped item, call `darray_get` with index 0 and set the free
+function to `NULL` before popping.
+*/
+int darray_heap_pop(darray *array, comparator fp, tracker track);
+
+//! Restores the heap order after an item of a binary heap has changed.
+/*!
+This function moves the item at a given index of a heap up or down until the
+heap order holds again, in O(log n) time. Together with a tracker that keeps the
+index of each item, this allows changing the key of any item, e.g. the priority
+of a task in a ready queue, without rebuilding the heap.
+
+\param array A pointer to a dynamic array ordered by `darray_heapify`.
+\param index The index of the item whose ordering has changed.
+\param fp A pointer to a function that compares two items in the array.
+\param track A pointer to a function that records the index of every item that
+moves, or `NULL` to not track indices.
+\returns 1 if successful, 0 otherwise.
+
+An example of raising the priority of a task:
+```
+t->priority++;
+darray_heap_update(ready, t->pos, task_cmp, track_task);
+```
+*/
+int darray_heap_update(darray *array, size_t index,
+                       comparator fp, tracker track);
+
+//! Merges a sorted array into another sorted array.
+/*!
+This function inserts every item of the second array into the first one so that
+the first array stays sorted, in O(n + m) time. Equal items keep their relative
+order, with those from the first array coming first. When one array contributes
+a long run of consecutive items, the run is found by galloping, i.e. an
+exponential search, so merging a few items into a large array takes only
+O(m log n) comparisons.
+
+\param array1 A pointer to a sorted dynamic array to merge into.
+\param array2 A pointer to a sorted dynamic array to merge from.
+\param fp A pointer to a function that compares two items in the arrays.
+\returns 1 if successful, 0 otherwise.
+
+\note Like `darray_extend`, the second array is left unchanged and its items are
+shared with the first array afterwards.
+*/
+int darray_merge(darray *array1, darray *array2, comparator fp);
+
+//! Returns the union of two sorted arrays.
+/*!
+This function returns a new sorted array of the items that are in either array,
+in O(n + m) time. The arrays are treated as multisets, so an item that appears
+`i` times in the first array and `j` times in the second one appears `max(i, j)`
+times in the result. Long runs from one array are skipped by galloping.
+
+\param array1 A pointer to a sorted dynamic array.
+\param array2 A pointer to another sorted dynamic array.
+\param fp A pointer to a function that compares two items in the arrays.
+\returns A new allocated dynamic array, or `NULL` if unsuccessful.
+
+\note The returned array is a shallow copy and has no free function. Of two
+equal items, the one from the first array is kept, and the dropped one remains
+owned by the second array.
+*/
+darray *darray_set_union(darray *array1, darray *array2, comparator fp);
+
+//! Returns the intersection of two sorted arrays.
+/*!
+This function returns a new sorted array of the items of the first array that
+are also in the second one, in O(n + m) time. An item that appears `i` times in
+the first array and `j` times in the second one appears `min(i, j)` times in the
+result. Long runs from one array are skipped by galloping.
+
+\param array1 A pointer to a sorted dynamic array.
+\param array2 A pointer to another sorted dynamic array.
+\param fp A pointer to a function that compares two items in the arrays.
+\returns A new allocated dynamic array, or `NULL` if unsuccessful.
+
+\note The returned array is a shallow copy of items from the first array and has
+no free function.
+*/
+darray *darray_set_intersection(darray *array1, darray *array2,
+                                comparator fp);
+
+//! Returns the difference of two sorted arrays.
+/*!
+This function returns a new sorted array of the items of the first array that
+are not in the second one, in O(n + m) time. An item that appears `i` times in
+the first array and `j` times in the second one appears `max(i - j, 0)` times in
+the result. Long runs from one array are skipped by galloping.
+
+\param array1 A pointer to a sorted dynamic array.
+\param array2 A pointer to another sorted dynamic array.
+\param fp A pointer to a function that compares two items in the arrays.
+\returns A new allocated dynamic array, or `NULL` if unsuccessful.
+
+\note The returned array is a shallow copy of items from the first array and has
+no free function.
+*/
+darray *darray_set_difference(darray *array1, darray *array2, comparator fp);
+
 //! Returns a clone of a given array.
 /*!
 This function calls the clone function on each item in the array and returns
@@ -398,6 +1050,48 @@ clone2 = darray_clone(integer_array, deep);    // creates a deep copy
 */
 darray *darray_clone(darray *array, unary fp);
 
+//! Returns a clone of a given array made with a context copy function.
+/*!
+The same as `darray_clone`, except that the context is passed to every call of
+the copy function, e.g. a memory pool to allocate the copies from.
+
+\param array A pointer to a dynamic array.
+\param fp A pointer to a function that copies an item given the context.
+\param ctx A pointer to the context.
+\returns A pointer to the cloned array, or `NULL` if unsuccessful.
+*/
+darray *darray_clone_r(darray *array, unary_r fp, void *ctx);
+
+//! Returns a copy-on-write clone of a given array.
+/*!
+The clone behaves as if it was made by `darray_clone` with the same clone
+function, but shares the pointer array and the items of the given array instead
+of copying them, so it is made in constant time. The clone function is only
+called when either array is modified while they still share, and then only for
+the array being modified. The array left last takes over the shared items.
+
+\param array A pointer to a dynamic array.
+\param fp A pointer to a function that, given an item of the array, produces a
+clone.
+\returns A pointer to the cloned array, or `NULL` if unsuccessful.
+
+\note Each item is freed exactly once as long as the free functions match the
+clone function, as with `darray_clone`: arrays with a shallow clone function
+should have only one array with a free function among those sharing.
+
+\note Arrays that share a pointer array must not be used from different threads
+at the same time, even to delete one of them.
+
+For example, to take a cheap snapshot of an array for a report:
+```
+darray *snapshot = darray_clone_cow(records, shallow);
+darray_set_item_free(snapshot, NULL);
+print_report(snapshot);
+del_darray(snapshot);
+```
+*/
+darray *darray_clone_cow(darray *array, unary fp);
+
 //! Clears all items from a given array.
 /*!
 This function pops all items from the array and calls the free function on each
@@ -417,6 +1111,556 @@ array structure.
 */
 int del_darray(darray *array);
 
+//! Deallocates a given array and frees its items in the background.
+/*!
+This function deallocates the dynamic array structure right away and hands its
+items to a background thread, which frees them and their pointer array. This
+keeps the cost of freeing millions of items off the calling thread.
+
+\param array A pointer to a dynamic array to deallocate.
+\returns 1 if successful, 0 otherwise.
+
+\note The free functions of the array must be safe to call from another
+thread. If the background thread cannot be started, the items are freed on the
+calling thread as in `del_darray`.
+*/
+int del_darray_deferred(darray *array);
+
+//! Waits for the background thread to free all deferred items.
+/*!
+Call this function before the program exits, or before releasing anything the
+free functions of deferred arrays depend on, e.g. a memory pool.
+
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_reclaim_wait();
+
+//! Creates a secondary hash index over a given array.
+/*!
+The function attaches a new hash index to the array. The index maps the key of
+each item, as extracted by the key function, to the index of that item in the
+array, so that `darray_index_search` finds an item in constant time instead of
+scanning the array like `darray_search`.
+
+The index is updated in place when items are appended to, inserted at or popped
+from the end of the array. Operations that move items around, such as
+`darray_sort` or popping from the middle, mark the index as stale, and it is
+rebuilt on the next search.
+
+\param array A pointer to a dynamic array to index.
+\param key A pointer to a function that returns a pointer to the key of an item.
+\param hash A pointer to a function that hashes a key.
+\param cmp A pointer to a function that compares two keys.
+\returns A new secondary index, or `NULL` if unsuccessful.
+
+\note The index is deallocated along with the array by `del_darray`. Clones of
+the array do not inherit its indices.
+
+For example, to index students by their names:
+```
+void *student_name(const void *p) { return ((student *) p)->name; }
+
+darray_index *by_name = new_darray_index(
+        students, student_name, str_hash, (comparator) strcmp);
+```
+*/
+darray_index *new_darray_index(
+        darray *array, unary key, hasher hash, comparator cmp);
+
+//! Searches for an item with a given key using a secondary index.
+/*!
+Finds the item whose key compares equal to the given key and stores its index in
+the index pointer. If several items have the same key, the smallest index is
+stored, which is the same item `darray_search` would find.
+
+\param index A pointer to a secondary index.
+\param key_ptr A pointer to the key to search for.
+\param idx_ptr A pointer to store the index of found item.
+\returns 1 if there is a match, or 0 otherwise.
+*/
+int darray_index_search(
+        darray_index *index, const void *key_ptr, size_t *idx_ptr);
+
+//! Deallocates a given secondary index.
+/*!
+This function detaches the index from its array and deallocates it. The array
+and its items are not affected.
+
+\param index A pointer to a secondary index to deallocate.
+\returns 1 if successful, 0 otherwise.
+*/
+int del_darray_index(darray_index *index);
+
+//! Creates an ordered view of a given array.
+/*!
+The function attaches a new view to the array. The view orders the items of the
+array by a given comparator without reordering the array itself, so that one
+array can be viewed in several orders at once. Items that compare equal are
+ordered by their index in the array.
+
+The view only stores the position of each item, using 32-bit integers if the
+array is short enough. It takes half the memory of a shallow clone on 64-bit
+machines and is never reordered by `darray_sort`.
+
+A single item appended to the array is inserted into the view in place.
+Operations that move items around mark the view as stale, and it is sorted again
+the next time it is used.
+
+\param array A pointer to a dynamic array to view.
+\param fp A pointer to a function that compares two items in the array.
+\returns A new ordered view, or `NULL` if unsuccessful.
+
+\note The view is deallocated along with the array by `del_darray`. Clones of
+the array do not inherit its views.
+*/
+darray_view *new_darray_view(darray *array, comparator fp);
+
+//! Gets an item in an ordered view using its rank.
+/*!
+This function attempts to return the item at a given rank in the view, that is,
+the item that would be at that index if the array were sorted.
+
+\param view A pointer to an ordered view.
+\param rank A valid rank in the view.
+\returns The item at the given rank if successful, `NULL` otherwise.
+*/
+void *darray_view_get(darray_view *view, size_t rank);
+
+//! Calls each item in an ordered view with a given function.
+/*!
+This function calls the given function with every object in the array in the
+order of the view.
+
+\param view A pointer to an ordered view.
+\param fp A pointer to a consumer function.
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_view_foreach(darray_view *view, consumer fp);
+
+//! Searches for an item in an ordered view with a binary search.
+/*!
+Searches for the first item in the view that compares equal to another object
+and stores its rank in the rank pointer. The comparator is called with an array
+item as the first argument, and the item to compare against as the second
+argument. It must order the items in the same way as the comparator of the view.
+
+\param view A pointer to an ordered view.
+\param item_ptr An object to compare against.
+\param fp A pointer to a function that compares array item against the object.
+\param rank_ptr A pointer to store the rank of found item.
+\returns 1 if there is a match, or 0 otherwise.
+*/
+int darray_view_search(darray_view *view,
+                       const void *item_ptr, comparator fp, size_t *rank_ptr);
+
+//! Finds the ranks of items within a given range in an ordered view.
+/*!
+Stores the rank of the first item that does not compare smaller than the lower
+bound, and the rank after the last item that does not compare bigger than the
+upper bound. The items in between, which may be none, are the ones in the range.
+The comparator is used as in `darray_view_search`.
+
+\param view A pointer to an ordered view.
+\param low_ptr An object as the lower bound (inclusive).
+\param high_ptr An object as the upper bound (inclusive).
+\param fp A pointer to a function that compares array item against a bound.
+\param start_ptr A pointer to store the starting rank (inclusive).
+\param end_ptr A pointer to store the ending rank (exclusive).
+\returns 1 if successful, 0 otherwise.
+
+For example, to list the students who scored between 50 and 80:
+```
+unsigned char low = 50, high = 80;
+size_t start, end;
+darray_view_range(by_score, &low, &high, student_has_score, &start, &end);
+for (size_t i = start; i < end; i++) {
+    print_student(darray_view_get(by_score, i));
+}
+```
+*/
+int darray_view_range(darray_view *view,
+                      const void *low_ptr, const void *high_ptr, comparator fp,
+                      size_t *start_ptr, size_t *end_ptr);
+
+//! Deallocates a given ordered view.
+/*!
+This function detaches the view from its array and deallocates it. The array and
+its items are not affected.
+
+\param view A pointer to an ordered view to deallocate.
+\returns 1 if successful, 0 otherwise.
+*/
+int del_darray_view(darray_view *view);
+
+//! Creates a lazy stream over the items of an array.
+/*!
+A stream is a pipeline of stages, such as maps, filters and takes, that are only
+run when the stream is collected or aggregated. All stages are fused into a
+single pass over the array, so no intermediate arrays are allocated. The same
+stream can be run any number of times.
+
+\param array A pointer to a dynamic array to read items from.
+\returns A pointer to a new stream, or `NULL` if unsuccessful.
+
+\note The array must outlive the stream and must not be modified while the
+stream runs.
+
+An example of the sum of the squares of the positive integers in an array:
+```
+darray_stream *stream = new_darray_stream(numbers);
+darray_stream_filter(stream, is_positive);
+darray_stream_map(stream, new_square, free);
+long long sum = 0;
+darray_stream_aggregate(stream, &sum, int_sum);
+del_darray_stream(stream);
+```
+*/
+darray_stream *new_darray_stream(darray *array);
+
+//! Adds a map stage to a stream.
+/*!
+The stage replaces each item with the result of a given function. If the
+function allocates its result, pass the function that frees it. Results dropped
+by a later stage or replaced by a later map are freed as soon as they are
+dropped.
+
+\param stream A pointer to a stream.
+\param fp A pointer to a function that maps an item.
+\param item_free A pointer to a function that frees a result of `fp`, or `NULL`.
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_stream_map(darray_stream *stream, unary fp, consumer item_free);
+
+//! Adds a filter stage to a stream.
+/*!
+The stage only lets through the items that satisfy a given predicate.
+
+\param stream A pointer to a stream.
+\param fp A pointer to a predicate function.
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_stream_filter(darray_stream *stream, predicate fp);
+
+//! Adds a take stage to a stream.
+/*!
+The stage only lets through the first `n` items that reach it. Once it has, the
+stream stops reading the array.
+
+\param stream A pointer to a stream.
+\param n The maximum number of items to let through.
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_stream_take(darray_stream *stream, size_t n);
+
+//! Sets the number of threads used to collect a stream.
+/*!
+`darray_stream_collect` splits the array into blocks of at least 1024 items and
+runs the fused stages of each block on up to this many threads. The results keep
+their order. By default, a stream runs on the calling thread only.
+
+\param stream A pointer to a stream.
+\param n The maximum number of threads, at least 1.
+\returns 1 if successful, 0 otherwise.
+
+\note With more than one thread, the functions of the stages must be safe to
+call concurrently. Streams with a take stage always run on the calling thread.
+*/
+int darray_stream_set_threads(darray_stream *stream, size_t n);
+
+//! Runs a stream and collects its results into a new array.
+/*!
+The new array frees its items with the free function of the last map stage, so
+it owns the results if they were allocated by the stream, and is shallow
+otherwise.
+
+\param stream A pointer to a stream.
+\returns A pointer to a new array of results, or `NULL` if unsuccessful.
+*/
+darray *darray_stream_collect(darray_stream *stream);
+
+//! Runs a stream and aggregates its results.
+/*!
+Each result is passed to a given aggregate function as soon as it comes out of
+the last stage, then freed with the free function of the last map stage.
+
+\param stream A pointer to a stream.
+\param resp A pointer to the result.
+\param fp A pointer to an aggregate function.
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_stream_aggregate(darray_stream *stream, void *resp, aggregate fp);
+
+//! Deallocates a stream.
+/*!
+The array the stream reads from is not affected.
+
+\param stream A pointer to a stream to deallocate.
+\returns 1 if successful, 0 otherwise.
+*/
+int del_darray_stream(darray_stream *stream);
+
+//! Groups the items of an array by key and aggregates each group.
+/*!
+This function finds the distinct keys of the items with a hash table, creates a
+result for each key with `init`, and adds each item to the result of its key
+with `step`. It takes O(n) expected time.
+
+With more than one thread, the array is split into ranges of at least 1024
+items. Each thread groups its range into its own table, so no locks are taken,
+and the tables are combined at the end by merging the results of equal keys with
+`merge`.
+
+\param array A pointer to a dynamic array.
+\param key A pointer to a function that returns a pointer to the key of an item.
+\param hash A pointer to a function that hashes a key.
+\param cmp A pointer to a function that compares two keys.
+\param init A pointer to a function that, given a pointer to a key, returns a
+new result for its group, or `NULL` if unsuccessful.
+\param step A pointer to a function that adds an item to a result.
+\param merge A pointer to a function that adds a result to another result of
+the same key, or `NULL` if only one thread is used.
+\param group_free A pointer to a function that frees a result, or `NULL`.
+\param n_threads The maximum number of threads, at least 1.
+\returns A new allocated dynamic array of the results in the order their keys
+first appear in the array, or `NULL` if unsuccessful. It frees its items with
+`group_free`.
+
+\note With more than one thread, `key`, `hash`, `cmp`, `init` and `step` must be
+safe to call concurrently. A key pointer passed to `init` points into an item
+and is only valid while the item is, so copy the key into the result if needed.
+
+An example of counting students by name:
+```
+typedef struct {
+    const char *name;
+    size_t count;
+} name_count;
+
+void *new_name_count(const void *p) {
+    name_count *c = malloc(sizeof(name_count));
+    if (c != NULL) {
+        c->name = p;
+        c->count = 0;
+    }
+    return c;
+}
+void count_step(const void *p, void *resp) { ((name_count *) resp)->count++; }
+void count_merge(const void *p, void *resp) {
+    ((name_count *) resp)->count += ((const name_count *) p)->count;
+}
+
+darray *counts = darray_group_by(students, student_name, str_hash,
+                                 (comparator) strcmp, new_name_count,
+                                 count_step, count_merge, free, 4);
+```
+*/
+darray *darray_group_by(darray *array, unary key, hasher hash, comparator cmp,
+                        unary init, aggregate step, aggregate merge,
+                        consumer group_free, size_t n_threads);
+
+//! Groups the items of an array by a small integer key and aggregates each
+//! group.
+/*!
+This function is the dense counterpart of `darray_group_by` for keys that are
+integers from 0 to `range - 1`, such as scores out of 100. The result of each
+key is kept at that key in a table of `range` pointers, so no hashing or key
+comparison is done. Each thread allocates a table of its own.
+
+\param array A pointer to a dynamic array.
+\param key A pointer to a function that returns the key of an item.
+\param range The number of possible keys, at least 1.
+\param init A pointer to a function that, given a pointer to a `uint64_t` key,
+returns a new result for its group, or `NULL` if unsuccessful.
+\param step A pointer to a function that adds an item to a result.
+\param merge A pointer to a function that adds a result to another result of
+the same key, or `NULL` if only one thread is used.
+\param group_free A pointer to a function that frees a result, or `NULL`.
+\param n_threads The maximum number of threads, at least 1.
+\returns A new allocated dynamic array of the results in the order of their
+keys, or `NULL` if unsuccessful. Keys with no items have no result. It frees its
+items with `group_free`.
+
+\note If an item has a key of at least `range`, the function fails with
+`DARRAY_EINDEX`.
+
+An example of a histogram of scores:
+```
+uint64_t student_score(const void *p) { return ((student *) p)->score; }
+
+darray *histogram = darray_group_by_dense(students, student_score, 101,
+                                          new_bucket, bucket_step,
+                                          bucket_merge, free, 4);
+```
+*/
+darray *darray_group_by_dense(darray *array, keyer key, size_t range,
+                              unary init, aggregate step, aggregate merge,
+                              consumer group_free, size_t n_threads);
+
+//! Joins two arrays on equal keys with a hash table.
+/*!
+This function builds a hash table of the keys of the shorter array and probes it
+with each item of the longer one, in O(n + m) expected time. Each pair of items
+with equal keys is passed to a given function as soon as it is found, so the
+pairs are never stored.
+
+Pairs come in the order of the longer array. The items of the shorter array that
+match the same item come in their order.
+
+\param left A pointer to a dynamic array.
+\param right A pointer to another dynamic array.
+\param left_key A pointer to a function that returns a pointer to the key of an
+item of the left array.
+\param right_key A pointer to a function that returns a pointer to the key of an
+item of the right array.
+\param hash A pointer to a function that hashes a key of either array.
+\param cmp A pointer to a function that compares two keys.
+\param emit A pointer to a function that takes a pair of a left item and a right
+item.
+\param ctx A pointer to the context passed to the function.
+\returns 1 if successful, 0 otherwise.
+
+An example of listing the enrollments of students:
+```
+void *student_id(const void *p) { return &((student *) p)->id; }
+void *course_student(const void *p) { return &((course *) p)->student_id; }
+
+darray_hash_join(students, courses, student_id, course_student, id_hash,
+                 id_cmp, print_enrollment, stdout);
+```
+*/
+int darray_hash_join(darray *left, darray *right, unary left_key,
+                     unary right_key, hasher hash, comparator cmp,
+                     joiner emit, void *ctx);
+
+//! Joins two sorted arrays on equal keys.
+/*!
+This function walks both arrays once, in O(n + m) time plus the number of pairs,
+and passes each pair of items with equal keys to a given function. Both arrays
+must be sorted by their keys in ascending order of the same comparator.
+
+Pairs come in the order of their keys. If several items of both arrays share a
+key, each left item is paired with each right item in turn.
+
+\param left A pointer to a sorted dynamic array.
+\param right A pointer to another sorted dynamic array.
+\param left_key A pointer to a function that returns a pointer to the key of an
+item of the left array.
+\param right_key A pointer to a function that returns a pointer to the key of an
+item of the right array.
+\param cmp A pointer to a function that compares two keys.
+\param emit A pointer to a function that takes a pair of a left item and a right
+item.
+\param ctx A pointer to the context passed to the function.
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_merge_join(darray *left, darray *right, unary left_key,
+                      unary right_key, comparator cmp, joiner emit,
+                      void *ctx);
+
+//! Represents the operation counters of a dynamic array.
+/*!
+The counters are only updated if the library is compiled with the
+`DARRAY_STATS` macro defined, for example with `-DDARRAY_STATS`. Otherwise the
+counters cost nothing and always read zero.
+*/
+typedef struct {
+    /*! The number of times the capacity changed. */
+    size_t resizes;
+    /*! The number of bytes moved by `memmove` or `memcpy` to close or open gaps
+    in the array. Swaps are not counted. */
+    size_t bytes_moved;
+    /*! The number of comparator calls made by sorting, searching and merging
+    functions. Predicate calls are not counted. */
+    size_t cmp_calls;
+    /*! The number of times the free function was called on an item. */
+    size_t item_frees;
+    /*! The biggest capacity reached. */
+    size_t peak_cap;
+} darray_stat;
+
+//! Reads the operation counters of an array.
+/*!
+This function copies the counters of a given array since its creation, or the
+counters of all arrays combined if the array is `NULL`. The peak capacity of all
+arrays combined is the biggest capacity reached by any single array.
+
+\param array A pointer to a dynamic array, or `NULL`.
+\param stat_ptr A pointer to store the counters.
+\returns 1 if successful, 0 otherwise.
+
+\note The combined counters are updated atomically, so they count operations on
+every thread. The counters of an array are only exact if it is used by one
+thread at a time.
+*/
+int darray_stats(darray *array, darray_stat *stat_ptr);
+
+//! Represents a live array found in the registry.
+/*!
+The fields are copied while the registry is locked, so a row stays valid after
+the array it describes is deallocated.
+*/
+typedef struct {
+    /*! Identifies the array. It is only meant to be printed or compared, since
+    the array may be deallocated by the time it is read. */
+    const void *id;
+    /*! The length of the array as of its last resize. */
+    size_t len;
+    /*! The capacity of the array as of its last resize. */
+    size_t cap;
+    /*! The number of bytes of unused capacity. */
+    size_t wasted;
+} darray_registry_row;
+
+//! Finds the live arrays that waste the most capacity.
+/*!
+This function stores rows describing up to `n` live arrays in the given buffer,
+ordered by the number of bytes of unused capacity from the most to the least.
+
+The registry of live arrays is only kept if the library is compiled with the
+`DARRAY_REGISTRY` macro defined, for example with `-DDARRAY_REGISTRY`. Otherwise
+no arrays are found.
+
+\param row_arr A pointer to a buffer of at least `n` rows.
+\param n The maximum number of arrays to find.
+\returns The number of rows stored in the buffer.
+
+\note Each array publishes its length and capacity to the registry whenever it
+resizes, so other threads can read them safely. The rows may lag behind changes
+that happen between resizes.
+*/
+size_t darray_registry_top(darray_registry_row *row_arr, size_t n);
+
+//! Prints the live arrays that waste the most capacity.
+/*!
+This function prints a table of up to `n` arrays found by
+`darray_registry_top`, with their length, capacity and bytes of unused
+capacity.
+
+\param stream A stream to print to, e.g. `stderr`.
+\param n The maximum number of arrays to print.
+\returns 1 if successful, 0 otherwise.
+*/
+int darray_registry_dump(FILE *stream, size_t n);
+
+//! Sets the size from which pointer arrays are backed by anonymous mappings.
+/*!
+On Linux, once the pointer array of a dynamic array reaches this many bytes, it
+is moved to an anonymous mapping. From then on, growing the array remaps pages
+instead of copying pointers, and shrinking it returns the unused pages to the
+kernel. By default, the size is 4 MiB, or `DARRAY_MMAP_THRESHOLD` if the library
+is compiled with the macro defined.
+
+Define `DARRAY_HUGEPAGES` to also advise the kernel to back the mappings with
+transparent huge pages, or `DARRAY_NO_MMAP` to always use `realloc`. On other
+systems, this function has no effect.
+
+\param size The size in bytes, or `SIZE_MAX` to never use mappings.
+\returns 1 if successful, 0 otherwise.
+
+\note Only arrays that grow or shrink afterwards are affected.
+*/
+int darray_set_map_threshold(size_t size);
+
 //! Returns and resets the error number.
 /*!
 This function returns the error number. Calling the function resets the error
@@ -436,4 +1680,8 @@ the error number is not set, the function returns a null pointer.
 */
 const char *darray_strerr();
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
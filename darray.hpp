@@ -0,0 +1,363 @@
+/*!
+\file darray.hpp
+\author Edward Ji
+\date 19 Oct 2026
+\brief The header file of C++ wrapper of dynamic array of void pointers.
+*/
+
+#ifndef DARRAY_HPP
+#define DARRAY_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "darray.h"
+
+//! Represents an owning dynamic array of objects of a given type.
+/*!
+This class template wraps a `darray` whose items are objects allocated with
+`new`. The wrapper owns the array: it is moved but never copied, and it deletes
+the array together with its objects when destroyed. Its iterators walk the
+pointer array directly, so standard algorithms run without a function call per
+item.
+
+\tparam T The type of objects in the array.
+
+An example of sorting an array with the parallel standard algorithms:
+```
+DArray<int> numbers;
+numbers.emplace_back(42);
+numbers.emplace_back(7);
+std::sort(std::execution::par, numbers.begin(), numbers.end());
+```
+
+\note Rearranging the items through the iterators moves the objects, not their
+pointers, so the addresses of objects stay with their positions.
+*/
+template <typename T>
+class DArray {
+public:
+    //! Represents a random access iterator over the objects of an array.
+    /*!
+    \tparam U The type of objects the iterator refers to, possibly `const`.
+    */
+    template <typename U>
+    class basic_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = std::remove_cv_t<U>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = U *;
+        using reference = U &;
+
+        basic_iterator() noexcept : item_ptr_ptr_(nullptr) {}
+        explicit basic_iterator(void *const *item_ptr_ptr) noexcept
+            : item_ptr_ptr_(item_ptr_ptr) {}
+
+        //! Converts an iterator into a `const` iterator.
+        operator basic_iterator<const U>() const noexcept {
+            return basic_iterator<const U>(item_ptr_ptr_);
+        }
+
+        reference operator*() const noexcept {
+            return *static_cast<pointer>(*item_ptr_ptr_);
+        }
+        pointer operator->() const noexcept {
+            return static_cast<pointer>(*item_ptr_ptr_);
+        }
+        reference operator[](difference_type n) const noexcept {
+            return *static_cast<pointer>(item_ptr_ptr_[n]);
+        }
+
+        basic_iterator &operator++() noexcept {
+            ++item_ptr_ptr_;
+            return *this;
+        }
+        basic_iterator operator++(int) noexcept {
+            return basic_iterator(item_ptr_ptr_++);
+        }
+        basic_iterator &operator--() noexcept {
+            --item_ptr_ptr_;
+            return *this;
+        }
+        basic_iterator operator--(int) noexcept {
+            return basic_iterator(item_ptr_ptr_--);
+        }
+        basic_iterator &operator+=(difference_type n) noexcept {
+            item_ptr_ptr_ += n;
+            return *this;
+        }
+        basic_iterator &operator-=(difference_type n) noexcept {
+            item_ptr_ptr_ -= n;
+            return *this;
+        }
+
+        friend basic_iterator operator+(basic_iterator it,
+                                        difference_type n) noexcept {
+            return it += n;
+        }
+        friend basic_iterator operator+(difference_type n,
+                                        basic_iterator it) noexcept {
+            return it += n;
+        }
+        friend basic_iterator operator-(basic_iterator it,
+                                        difference_type n) noexcept {
+            return it -= n;
+        }
+        friend difference_type operator-(const basic_iterator &a,
+                                         const basic_iterator &b) noexcept {
+            return a.item_ptr_ptr_ - b.item_ptr_ptr_;
+        }
+
+        friend bool operator==(const basic_iterator &a,
+                               const basic_iterator &b) noexcept {
+            return a.item_ptr_ptr_ == b.item_ptr_ptr_;
+        }
+        friend bool operator!=(const basic_iterator &a,
+                               const basic_iterator &b) noexcept {
+            return a.item_ptr_ptr_ != b.item_ptr_ptr_;
+        }
+        friend bool operator<(const basic_iterator &a,
+                              const basic_iterator &b) noexcept {
+            return a.item_ptr_ptr_ < b.item_ptr_ptr_;
+        }
+        friend bool operator>(const basic_iterator &a,
+                              const basic_iterator &b) noexcept {
+            return a.item_ptr_ptr_ > b.item_ptr_ptr_;
+        }
+        friend bool operator<=(const basic_iterator &a,
+                               const basic_iterator &b) noexcept {
+            return a.item_ptr_ptr_ <= b.item_ptr_ptr_;
+        }
+        friend bool operator>=(const basic_iterator &a,
+                               const basic_iterator &b) noexcept {
+            return a.item_ptr_ptr_ >= b.item_ptr_ptr_;
+        }
+
+    private:
+        /*! Points to the slot of the current item in the pointer array. */
+        void *const *item_ptr_ptr_;
+    };
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T &;
+    using const_reference = const T &;
+    using iterator = basic_iterator<T>;
+    using const_iterator = basic_iterator<const T>;
+
+    //! Creates a new empty array.
+    /*!
+    \throws std::bad_alloc If the array cannot be allocated.
+    */
+    DArray() : array_(new_darray(destroy)) {
+        if (array_ == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+
+    //! Takes ownership of an existing array.
+    /*!
+    \param array A pointer to a dynamic array of `T` objects allocated with
+    `new`. Its free function is replaced so that the objects are deleted.
+    */
+    explicit DArray(darray *array) noexcept : array_(array) {
+        darray_set_item_free(array_, destroy);
+    }
+
+    DArray(const DArray &) = delete;
+    DArray &operator=(const DArray &) = delete;
+
+    DArray(DArray &&other) noexcept : array_(other.array_) {
+        other.array_ = nullptr;
+    }
+
+    DArray &operator=(DArray &&other) noexcept {
+        if (this != &other) {
+            if (array_ != nullptr) {
+                del_darray(array_);
+            }
+            array_ = other.array_;
+            other.array_ = nullptr;
+        }
+        return *this;
+    }
+
+    ~DArray() {
+        if (array_ != nullptr) {
+            del_darray(array_);
+        }
+    }
+
+    //! Returns the wrapped array without giving up ownership.
+    darray *get() const noexcept {
+        return array_;
+    }
+
+    //! Gives up ownership of the wrapped array.
+    /*!
+    \returns A pointer to the wrapped array, which still deletes its objects
+    when passed to `del_darray`.
+    */
+    darray *release() noexcept {
+        darray *array = array_;
+        array_ = nullptr;
+        return array;
+    }
+
+    size_type size() const noexcept {
+        return darray_len(array_);
+    }
+
+    size_type capacity() const noexcept {
+        return darray_capacity(array_);
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    //! Gets an object at a valid index.
+    reference operator[](size_type index) noexcept {
+        return *static_cast<T *>(darray_get(array_, index));
+    }
+
+    const_reference operator[](size_type index) const noexcept {
+        return *static_cast<const T *>(darray_get(array_, index));
+    }
+
+    //! Gets an object after checking the index.
+    /*!
+    \throws std::out_of_range If the index is out of range.
+    */
+    reference at(size_type index) {
+        if (index >= size()) {
+            throw std::out_of_range("DArray::at");
+        }
+        return (*this)[index];
+    }
+
+    const_reference at(size_type index) const {
+        if (index >= size()) {
+            throw std::out_of_range("DArray::at");
+        }
+        return (*this)[index];
+    }
+
+    reference front() noexcept {
+        return (*this)[0];
+    }
+
+    reference back() noexcept {
+        return (*this)[size() - 1];
+    }
+
+    //! Constructs an object in place at the end of the array.
+    /*!
+    \param args The arguments to pass to the constructor of `T`.
+    \returns A reference to the new object.
+    \throws std::bad_alloc If the object or the pointer array cannot be grown.
+    */
+    template <typename... Args>
+    reference emplace_back(Args &&...args) {
+        T *item_ptr = new T(std::forward<Args>(args)...);
+        if (!darray_append(array_, item_ptr)) {
+            delete item_ptr;
+            throw std::bad_alloc();
+        }
+        return *item_ptr;
+    }
+
+    void push_back(const T &item) {
+        emplace_back(item);
+    }
+
+    void push_back(T &&item) {
+        emplace_back(std::move(item));
+    }
+
+    //! Deletes the object at the end of the array.
+    void pop_back() noexcept {
+        darray_pop(array_, size() - 1);
+    }
+
+    //! Deletes all objects in the array.
+    void clear() noexcept {
+        darray_clear(array_);
+    }
+
+    //! Returns an iterator to the first object.
+    /*!
+    If the array shares its objects with copy-on-write clones, it gets its own
+    copy first.
+
+    \throws std::bad_alloc If the objects cannot be copied.
+    */
+    iterator begin() {
+        return iterator(data());
+    }
+
+    //! Returns an iterator past the last object.
+    /*!
+    \throws std::bad_alloc If the objects cannot be copied.
+    */
+    iterator end() {
+        return iterator(data() + size());
+    }
+
+    //! Returns a `const` iterator to the first object.
+    /*!
+    The array is not changed, so objects stay shared with copy-on-write clones.
+    */
+    const_iterator begin() const noexcept {
+        return const_iterator(darray_cdata(array_));
+    }
+
+    //! Returns a `const` iterator past the last object.
+    /*!
+    The array is not changed, so objects stay shared with copy-on-write clones.
+    */
+    const_iterator end() const noexcept {
+        void *const *item_ptr_arr = darray_cdata(array_);
+        if (item_ptr_arr == nullptr) {
+            return const_iterator();
+        }
+        return const_iterator(item_ptr_arr + size());
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    //! Gets the pointer array for writing.
+    /*!
+    \throws std::bad_alloc If the objects cannot be copied.
+    */
+    void **data() {
+        void **item_ptr_arr = darray_data(array_);
+        if (item_ptr_arr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return item_ptr_arr;
+    }
+
+    //! Deletes an object in the array.
+    static void destroy(void *item_ptr) {
+        delete static_cast<T *>(item_ptr);
+    }
+
+    /*! Points to the wrapped array, or `nullptr` once moved from. */
+    darray *array_;
+};
+
+#endif
@@ -4,8 +4,8 @@
 \date 21 Jun 2022
 
 \brief
-A demonstration of representing a matrix with nested dynamic arrays and printing
-it neatly.
+A demonstration of representing a matrix with a dense matrix and printing it
+neatly.
 
 \stdout
 ```
@@ -15,112 +15,79 @@ it neatly.
 ```
 */
 
-#include <limits.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-#include "../darray.h"
+#include "../dmatrix.h"
 
 //! The number of rows in the sample matrix.
 #define N_ROWS 3
 //! The number of columns in the sample matrix.
 #define N_COLS 4
 
-//! The field width when printing out an integer entry.
-static int field_width;
-
-//! Allocates an integer on the heap.
-int *new_int(int x) {
-    int *p = (int *) malloc(sizeof(int));
-    *p = x;
-
-    return p;
-}
-
 /*!
-Assigns the integer at the first pointer if it's larger than that at the
-second pointer.
+Assigns the max integer in the tile if it's larger than the integer at the
+result pointer.
 
-\see This function is of type `aggregate`.
+\see This function is of type `tile_aggregate`.
 */
-void int_max(const void *p1, void *p2) {
-    const int *item = p1;
-    int *resp = p2;
-    if (*item > *resp) {
-        *resp = *item;
-    }
-}
-
-/*!
-Assigns the max integer in the array at the first pointer if it's larger than
-that at the second pointer.
-
-\see This function is of type `aggregate`.
-*/
-void array_max(const void *p1, void *p2) {
-    darray *arr = (darray *) p1;
-    int *resp = p2;
-    int max = INT_MIN;
-    darray_aggregate(arr, &max, int_max);
-    if (max > *resp) {
-        *resp = max;
+void int_max_tile(const void *tile_ptr,
+                  size_t rows, size_t cols, size_t stride, void *resp) {
+    const int *row = tile_ptr;
+    int *max = resp;
+    for (size_t i = 0; i < rows; i++, row += stride) {
+        for (size_t j = 0; j < cols; j++) {
+            if (row[j] > *max) {
+                *max = row[j];
+            }
+        }
     }
 }
 
 /*!
-Prints the integer at a pointer with global field width followed by a space.
-
-\see This function is of type `consumer`.
-*/
-void print_int(void *p) {
-    printf("%*d ", field_width, *((int *) p));
-}
-
-/*!
-Prints the integer array at a pointer in the following format.
+Prints the integer row at a pointer with a given field width in the following
+format.
 ```
 [   71876166  708592740 1483128881  907283241 ]
 ```
-
-\see This function is of type `consumer`.
 */
-void print_arr(void *arr) {
+void print_row(const int *row, size_t cols, int field_width) {
     printf("[ ");
-    darray_foreach((darray *) arr, print_int);
+    for (size_t j = 0; j < cols; j++) {
+        printf("%*d ", field_width, row[j]);
+    }
     printf("]\n");
 }
 
-
 /*!
-Sets the global field width to the number of digits of the max integer in the
-matrix and prints the nested integer array at a pointer.
-
-\see This function is of type `consumer`.
+Finds the number of digits of the max integer in the matrix and prints each row
+with that field width.
 */
-void print_mat(darray *arr) {
+void print_mat(dmatrix *mat) {
     int max = 0;
-    darray_aggregate(arr, &max, array_max);
-    field_width = (int) ceil(log10((double) max));
-    darray_foreach(arr, print_arr);
+    dmatrix_aggregate_tiles(mat, 64, 64, &max, int_max_tile);
+    int field_width = (int) ceil(log10((double) max));
+    for (size_t i = 0; i < dmatrix_rows(mat); i++) {
+        print_row(dmatrix_row(mat, i), dmatrix_cols(mat), field_width);
+    }
 }
 
 int main() {
     srand(42);
 
-    darray *mat = new_darray((consumer) del_darray);
+    dmatrix *mat = new_dmatrix(sizeof(int), 0, N_COLS);
     for (int i = 0; i < N_ROWS; i++) {
-        darray *row = new_darray(free);
+        int row[N_COLS];
         for (int j = 0; j < N_COLS; j++) {
-            int num = rand();
-            darray_append(row, new_int(num));
+            row[j] = rand();
         }
-        darray_append(mat, row);
+        dmatrix_append_row(mat, row);
     }
 
     print_mat(mat);
 
-    del_darray(mat);
+    del_dmatrix(mat);
 
     return 0;
 }
@@ -4,7 +4,11 @@
 \date 27 Jul 2022
 
 \brief
-A demonstration of dynamic array with a more complex structure.
+A demonstration of a columnar table of records with typed arrays.
+
+The id and name columns are looked up through secondary hash indices over
+shallow dynamic arrays that point into the columns, so a search takes constant
+time and its row number is the index of the item found.
 
 \note
 This program is interactive, make and run to try it out.
@@ -15,6 +19,7 @@ This program is interactive, make and run to try it out.
 #include <string.h>
 
 #include "../darray.h"
+#include "../util/dtyped.h"
 
 #define STRINGIFY(x) STRINGIFY2(x)
 #define STRINGIFY2(x) #x
@@ -23,76 +28,83 @@ This program is interactive, make and run to try it out.
 #define SCORE_MAX 100
 #define CSV_NAME "./demo/student.csv"
 
-typedef struct {
-    size_t id;
-    char name[NAME_LEN];
-    unsigned char score; // range 0 - SCORE_MAX
-} student;
-
-student *new_student(unsigned id, const char *name, unsigned char score) {
-    student *stu = malloc(sizeof(student));
+// score ranges 0 - SCORE_MAX
+#define STUDENT_FIELDS(X) X(ulong, id) X(string, name) X(uchar, score)
 
-    stu->id = id;
-    strncpy(stu->name, name, NAME_LEN - 1);
-    stu->score = score;
-
-    return stu;
-}
+MAKE_DTYPE_TABLE(student, STUDENT_FIELDS)
 
-student *student_from_line(char *line) {
-    size_t id;
-    char name[NAME_LEN];
+int student_from_line(char *line, char *name, student_row *row) {
+    unsigned long id;
     unsigned char score;
 
     if (sscanf(line,
-                "%zu,%" STRINGIFY(NAME_LEN) "[^,],%hhu",
+                "%lu,%" STRINGIFY(NAME_LEN) "[^,],%hhu",
                 &id, name, &score) != 3 ||
             score > SCORE_MAX) {
-        return NULL;
+        return 0;
     }
 
-    return new_student(id, name, score);
+    row->id = id;
+    row->name = name;
+    row->score = score;
+    return 1;
 }
 
-void print_student(void *p) {
-    student *stu = p;
-    printf("%08zu %-" STRINGIFY(NAME_LEN) "s %3hhu/" STRINGIFY(SCORE_MAX) "\n",
-            stu->id, stu->name, stu->score);
+void *column_value(const void *p) {
+    return (void *) p;
 }
 
-int student_has_id(const void *p1, const void *p2) {
-    const student *stu = p1;
-    const int *p_id = p2;
+size_t id_hash(const void *p) {
+    unsigned long id = *((const unsigned long *) p);
 
-    return (stu->id > *p_id) - (stu->id < *p_id);
+    return id * 11400714819323198485u;
 }
 
-int student_has_name(const void *p1, const void *p2) {
-    const student *stu = p1;
-    const char *name = p2;
+int id_cmp(const void *p1, const void *p2) {
+    unsigned long id1 = *((const unsigned long *) p1);
+    unsigned long id2 = *((const unsigned long *) p2);
 
-    return strcmp(stu->name, name);
+    return (id1 > id2) - (id1 < id2);
 }
 
-int student_cmp_id(const void *p1, const void *p2) {
-    const student *stu1 = p1;
-    const student *stu2 = p2;
+size_t name_hash(const void *p) {
+    size_t hash = 14695981039346656037u;
+    for (const char *s = p; *s != '\0'; s++) {
+        hash = (hash ^ (unsigned char) *s) * 1099511628211u;
+    }
+
+    return hash;
+}
 
-    return (stu1->id > stu2->id) - (stu1->id < stu2->id);
+int name_cmp(const void *p1, const void *p2) {
+    return strcmp(p1, p2);
 }
 
-int student_cmp_name(const void *p1, const void *p2) {
-    const student *stu1 = p1;
-    const student *stu2 = p2;
+darray *column_keys(student_table *students, int by_name) {
+    size_t len = student_table_len(students);
+    void **item_ptr_arr = malloc(sizeof(void *) * (len > 0 ? len : 1));
+    if (item_ptr_arr == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < len; i++) {
+        item_ptr_arr[i] = by_name ?
+            (void *) dtyped_get(students->name, i) : &students->id->data[i];
+    }
 
-    return strcmp(stu1->name, stu2->name);
+    darray *keys = new_darray_from(NULL, item_ptr_arr, len);
+    if (keys == NULL) {
+        free(item_ptr_arr);
+    }
+    return keys;
 }
 
-void *shallow_cpy(const void *p) {
-    return (void *) p;
+void print_student(student_table *students, size_t index) {
+    student_row row = student_table_get(students, index);
+    printf("%08lu %-" STRINGIFY(NAME_LEN) "s %3hhu/" STRINGIFY(SCORE_MAX) "\n",
+            row.id, row.name, row.score);
 }
 
-darray *read_csv(const char *fname) {
+student_table *read_csv(const char *fname) {
     FILE *csv = fopen(fname, "r");
     if (csv == NULL) {
         perror("fail to read CSV");
@@ -100,14 +112,24 @@ darray *read_csv(const char *fname) {
     }
 
     char buffer[BUF_LEN];
+    char name[NAME_LEN + 1];
     size_t line_no = 1;
-    darray *students = new_darray(free);
+    student_table *students = new_student_table();
+    if (students == NULL) {
+        fputs("fail to create student table\n", stderr);
+        fclose(csv);
+        return NULL;
+    }
     while (fgets(buffer, BUF_LEN, csv) != NULL) {
-        student *stu = student_from_line(buffer);
-        if (stu == NULL) {
+        student_row row;
+        if (!student_from_line(buffer, name, &row)) {
             fprintf(stderr, "fail to parse line %zu\n", line_no);
+        } else if (!student_table_append(students, row)) {
+            fprintf(stderr, "fail to store line %zu\n", line_no);
+            del_student_table(students);
+            fclose(csv);
+            return NULL;
         }
-        darray_append(students, stu);
         line_no++;
     }
     fclose(csv);
@@ -115,11 +137,13 @@ darray *read_csv(const char *fname) {
     return students;
 }
 
-void list(darray *students) {
-    darray_foreach(students, print_student);
+void list(student_table *students, size_t *order) {
+    for (size_t i = 0; i < student_table_len(students); i++) {
+        print_student(students, order == NULL ? i : order[i]);
+    }
 }
 
-void search_id(darray *students) {
+void search_id(student_table *students, darray_index *by_id) {
     printf("<id>: ");
 
     char buffer[BUF_LEN] = { 0 };
@@ -128,22 +152,22 @@ void search_id(darray *students) {
         return;
     }
 
-    int id;
-    if (sscanf(buffer, "%d", &id) != 1) {
+    unsigned long id;
+    if (sscanf(buffer, "%lu", &id) != 1) {
         puts("invalid id");
         return;
     }
 
     size_t idx;
-    if (darray_search(students, &id, student_has_id, &idx) == 0) {
+    if (darray_index_search(by_id, &id, &idx) == 0) {
         puts("not found");
         return;
     }
 
-    print_student(darray_get(students, idx));
+    print_student(students, idx);
 }
 
-void search_name(darray *students) {
+void search_name(student_table *students, darray_index *by_name) {
     char name[NAME_LEN] = { 0 };
     size_t idx;
 
@@ -154,15 +178,16 @@ void search_name(darray *students) {
     }
     name[strcspn(name, "\n")] = '\0';
 
-    if (darray_search(students, &name, student_has_name, &idx) == 0) {
+    if (darray_index_search(by_name, name, &idx) == 0) {
         puts("not found");
         return;
     }
 
-    print_student(darray_get(students, idx));
+    print_student(students, idx);
 }
 
-void search(darray *students) {
+void search(student_table *students,
+            darray_index *by_id, darray_index *by_name) {
     char buffer[BUF_LEN];
     printf("id, name, quit: ");
     if (fgets(buffer, BUF_LEN, stdin) == NULL) {
@@ -170,55 +195,108 @@ void search(darray *students) {
     }
     buffer[strcspn(buffer, "\n")] = '\0';
     if (strcmp(buffer, "id") == 0) {
-        search_id(students);
+        search_id(students, by_id);
     } else if (strcmp(buffer, "name") == 0) {
-        search_name(students);
+        search_name(students, by_name);
     } else {
         puts("invalid option");
         return;
     }
 }
 
-void sort(darray *students) {
+int sort(student_table *students, size_t *order) {
     char buffer[BUF_LEN];
-    printf("id, name, quit: ");
+    printf("id, name, score, quit: ");
     if (fgets(buffer, BUF_LEN, stdin) == NULL) {
-        return;
+        return 0;
     }
     buffer[strcspn(buffer, "\n")] = '\0';
     if (strcmp(buffer, "id") == 0) {
-        darray_sort(students, student_cmp_id);
+        return ulong_array_argsort(students->id, order);
     } else if (strcmp(buffer, "name") == 0) {
-        darray_sort(students, student_cmp_name);
+        return string_array_argsort(students->name, order);
+    } else if (strcmp(buffer, "score") == 0) {
+        return uchar_array_argsort(students->score, order);
     } else {
         puts("invalid option");
+        return 0;
+    }
+}
+
+void filter(student_table *students, size_t *rows) {
+    printf("<min score> <max score>: ");
+
+    char buffer[BUF_LEN] = { 0 };
+    if (fgets(buffer, BUF_LEN, stdin) == NULL) {
+        puts("missing scores");
+        return;
+    }
+
+    unsigned char lo, hi;
+    if (sscanf(buffer, "%hhu %hhu", &lo, &hi) != 2) {
+        puts("invalid scores");
         return;
     }
+
+    size_t n = uchar_array_between(students->score, lo, hi, rows);
+    student_table *chosen = student_table_select(students, rows, n);
+    list(chosen, NULL);
+    printf("%zu students\n", student_table_len(chosen));
+    del_student_table(chosen);
 }
 
 void help() {
     printf("\tlist: show all the students in a table\n"
            "\tsearch: show the first student with matching field value\n"
-           "\tsort: sort students by their values in a certain field\n"
+           "\tsort: list students by their values in a certain field\n"
+           "\tfilter: show the students with scores in a range\n"
            "\tquit: exit the program\n");
 }
 
 int main() {
-    darray *students = read_csv(CSV_NAME);
+    student_table *students = read_csv(CSV_NAME);
+    if (students == NULL) {
+        return 1;
+    }
+    size_t len = student_table_len(students);
+    size_t *rows = malloc(sizeof(size_t) * (len > 0 ? len : 1));
+    size_t *order = malloc(sizeof(size_t) * (len > 0 ? len : 1));
+    darray *ids = column_keys(students, 0);
+    darray *names = column_keys(students, 1);
+    darray_index *by_id = ids == NULL ? NULL :
+        new_darray_index(ids, column_value, id_hash, id_cmp);
+    darray_index *by_name = names == NULL ? NULL :
+        new_darray_index(names, column_value, name_hash, name_cmp);
+    if (rows == NULL || order == NULL || by_id == NULL || by_name == NULL) {
+        fputs("fail to allocate memory\n", stderr);
+        free(order);
+        free(rows);
+        if (ids != NULL) del_darray(ids);
+        if (names != NULL) del_darray(names);
+        del_student_table(students);
+        return 1;
+    }
+    int ordered = 0;
 
     char buffer[BUF_LEN];
     do {
-        printf("list, search, sort, help, quit: ");
+        printf("list, search, sort, filter, help, quit: ");
         if (fgets(buffer, BUF_LEN, stdin) == NULL) {
             break;
         }
         buffer[strcspn(buffer, "\n")] = '\0';
         if (strcmp(buffer, "list") == 0) {
-            list(students);
+            list(students, ordered ? order : NULL);
         } else if (strcmp(buffer, "search") == 0) {
-            search(students);
+            search(students, by_id, by_name);
         } else if (strcmp(buffer, "sort") == 0) {
-            sort(students);
+            if (sort(students, rows)) {
+                memcpy(order, rows,
+                       sizeof(size_t) * student_table_len(students));
+                ordered = 1;
+            }
+        } else if (strcmp(buffer, "filter") == 0) {
+            filter(students, rows);
         } else if (strcmp(buffer, "help") == 0) {
             help();
         } else if (strcmp(buffer, "quit") == 0) {
@@ -228,7 +306,11 @@ int main() {
         }
     } while (1);
 
-    del_darray(students);
+    free(order);
+    free(rows);
+    del_darray(ids);
+    del_darray(names);
+    del_student_table(students);
 
     return 0;
 }
@@ -0,0 +1,619 @@
+/*!
+\file dmatrix.c
+\author Edward Ji
+\date 19 Oct 2026
+\brief The source code of dense matrix with contiguous storage.
+
+\warning Note that some types and functions have no declaration or incomplete
+definition in the header file. The documentation in this source file is targeted
+to maintainers.
+*/
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "dmatrix.h"
+
+//! Represents a dense matrix structure.
+/*!
+Entries are stored row by row in a single buffer. Both the number of rows and
+the number of entries per row have spare capacity, so appending a row or a
+column does not move the other entries most of the time.
+*/
+struct dmatrix {
+    /*! Points to an allocated buffer of entries. */
+    unsigned char *item_arr;
+    /*! The size of an entry in bytes. */
+    size_t item_size;
+    /*! The number of rows. */
+    size_t rows;
+    /*! The number of columns. */
+    size_t cols;
+    /*! The number of rows the buffer can hold. */
+    size_t row_cap;
+    /*! The number of entries each row in the buffer can hold. */
+    size_t stride;
+};
+
+//! Returns a pointer to an entry without checking its indices.
+static unsigned char *entry(dmatrix *mat, size_t row, size_t col) {
+    return mat->item_arr + (row * mat->stride + col) * mat->item_size;
+}
+
+//! Computes the size in bytes of a buffer of entries.
+/*!
+\returns 1 if successful, 0 if the size overflows `size_t`.
+*/
+static int buffer_size(size_t row_cap, size_t stride, size_t item_size,
+                       size_t *size_ptr) {
+    if (stride > 0 && row_cap > SIZE_MAX / stride) {
+        return 0;
+    }
+    size_t entries = row_cap * stride;
+    if (item_size > 0 && entries > SIZE_MAX / item_size) {
+        return 0;
+    }
+    *size_ptr = entries * item_size;
+    return 1;
+}
+
+//! Makes room for a given number of rows and columns.
+/*!
+The capacities are doubled until they are sufficient, or set to the numbers
+requested if doubling would overflow. If the stride changes, the rows are copied
+into a new buffer.
+
+\returns 1 if successful, 0 otherwise.
+*/
+static int dmatrix_reserve(dmatrix *mat, size_t rows, size_t cols) {
+    size_t row_cap = mat->row_cap;
+    size_t stride = mat->stride;
+    while (rows > row_cap) {
+        row_cap = row_cap > SIZE_MAX / 2 ? rows : row_cap * 2;
+    }
+    while (cols > stride) {
+        stride = stride > SIZE_MAX / 2 ? cols : stride * 2;
+    }
+
+    size_t size;
+    if (!buffer_size(row_cap, stride, mat->item_size, &size)) {
+        darray_errno = DARRAY_EALLOC;
+        return 0;
+    }
+    if (stride != mat->stride) {
+        unsigned char *item_arr = malloc(size);
+        if (item_arr == NULL) {
+            darray_errno = DARRAY_EALLOC;
+            return 0;
+        }
+        for (size_t i = 0; i < mat->rows; i++) {
+            memcpy(item_arr + i * stride * mat->item_size,
+                   entry(mat, i, 0),
+                   mat->cols * mat->item_size);
+        }
+        free(mat->item_arr);
+        mat->item_arr = item_arr;
+    } else if (row_cap != mat->row_cap) {
+        unsigned char *item_arr = realloc(mat->item_arr, size);
+        if (item_arr == NULL) {
+            darray_errno = DARRAY_EALLOC;
+            return 0;
+        }
+        mat->item_arr = item_arr;
+    }
+    mat->row_cap = row_cap;
+    mat->stride = stride;
+
+    return 1;
+}
+
+dmatrix *new_dmatrix(size_t item_size, size_t rows, size_t cols) {
+    dmatrix *mat = malloc(sizeof(dmatrix));
+    if (mat == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        return NULL;
+    }
+
+    mat->item_size = item_size;
+    mat->rows = rows;
+    mat->cols = cols;
+    mat->row_cap = rows > 0 ? rows : 1;
+    mat->stride = cols > 0 ? cols : 1;
+    size_t size;
+    if (!buffer_size(mat->row_cap, mat->stride, item_size, &size)) {
+        free(mat);
+        darray_errno = DARRAY_EALLOC;
+        return NULL;
+    }
+    mat->item_arr = calloc(mat->row_cap * mat->stride, item_size);
+    if (mat->item_arr == NULL) {
+        free(mat);
+        darray_errno = DARRAY_EALLOC;
+        return NULL;
+    }
+
+    return mat;
+}
+
+size_t dmatrix_rows(dmatrix *mat) {
+    if (mat == NULL) {
+        return 0;
+    }
+    return mat->rows;
+}
+
+size_t dmatrix_cols(dmatrix *mat) {
+    if (mat == NULL) {
+        return 0;
+    }
+    return mat->cols;
+}
+
+size_t dmatrix_stride(dmatrix *mat) {
+    if (mat == NULL) {
+        return 0;
+    }
+    return mat->stride;
+}
+
+void *dmatrix_get(dmatrix *mat, size_t row, size_t col) {
+    if (mat == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+    if (row >= mat->rows || col >= mat->cols) {
+        darray_errno = DARRAY_EINDEX;
+        return NULL;
+    }
+
+    return entry(mat, row, col);
+}
+
+void *dmatrix_row(dmatrix *mat, size_t row) {
+    if (mat == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+    if (row >= mat->rows) {
+        darray_errno = DARRAY_EINDEX;
+        return NULL;
+    }
+
+    return entry(mat, row, 0);
+}
+
+darray *dmatrix_row_view(dmatrix *mat, size_t row) {
+    unsigned char *row_ptr = dmatrix_row(mat, row);
+    if (row_ptr == NULL) {
+        return NULL;
+    }
+
+    void **item_ptr_arr =
+        malloc(sizeof(void *) * (mat->cols > 0 ? mat->cols : 1));
+    if (item_ptr_arr == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        return NULL;
+    }
+    for (size_t j = 0; j < mat->cols; j++) {
+        item_ptr_arr[j] = row_ptr + j * mat->item_size;
+    }
+
+    darray *view = new_darray_from(NULL, item_ptr_arr, mat->cols);
+    if (view == NULL) {
+        free(item_ptr_arr);
+    }
+    return view;
+}
+
+int dmatrix_append_row(dmatrix *mat, const void *row_ptr) {
+    if (mat == NULL || row_ptr == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    if (!dmatrix_reserve(mat, mat->rows + 1, mat->cols)) {
+        return 0;
+    }
+    memcpy(entry(mat, mat->rows, 0), row_ptr, mat->cols * mat->item_size);
+
+    mat->rows++;
+
+    return 1;
+}
+
+int dmatrix_append_col(dmatrix *mat, const void *col_ptr) {
+    if (mat == NULL || col_ptr == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    if (!dmatrix_reserve(mat, mat->rows, mat->cols + 1)) {
+        return 0;
+    }
+    const unsigned char *item_ptr = col_ptr;
+    for (size_t i = 0; i < mat->rows; i++) {
+        memcpy(entry(mat, i, mat->cols),
+               item_ptr + i * mat->item_size,
+               mat->item_size);
+    }
+
+    mat->cols++;
+
+    return 1;
+}
+
+int dmatrix_pop_row(dmatrix *mat, size_t row) {
+    if (mat == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (row >= mat->rows) {
+        darray_errno = DARRAY_EINDEX;
+        return 0;
+    }
+
+    memmove(entry(mat, row, 0),
+            entry(mat, row + 1, 0),
+            (mat->rows - row - 1) * mat->stride * mat->item_size);
+
+    mat->rows--;
+
+    return 1;
+}
+
+int dmatrix_pop_col(dmatrix *mat, size_t col) {
+    if (mat == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (col >= mat->cols) {
+        darray_errno = DARRAY_EINDEX;
+        return 0;
+    }
+
+    for (size_t i = 0; i < mat->rows; i++) {
+        memmove(entry(mat, i, col),
+                entry(mat, i, col + 1),
+                (mat->cols - col - 1) * mat->item_size);
+    }
+
+    mat->cols--;
+
+    return 1;
+}
+
+int dmatrix_aggregate(dmatrix *mat, void *resp, aggregate fp) {
+    if (mat == NULL || resp == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    for (size_t i = 0; i < mat->rows; i++) {
+        for (size_t j = 0; j < mat->cols; j++) {
+            fp(entry(mat, i, j), resp);
+        }
+    }
+
+    return 1;
+}
+
+int dmatrix_aggregate_tiles(dmatrix *mat, size_t tile_rows, size_t tile_cols,
+                            void *resp, tile_aggregate fp) {
+    if (mat == NULL || resp == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (tile_rows == 0 || tile_cols == 0) {
+        darray_errno = DARRAY_EINDEX;
+        return 0;
+    }
+
+    for (size_t i = 0; i < mat->rows; i += tile_rows) {
+        size_t rows = mat->rows - i < tile_rows ? mat->rows - i : tile_rows;
+        for (size_t j = 0; j < mat->cols; j += tile_cols) {
+            size_t cols = mat->cols - j < tile_cols ? mat->cols - j : tile_cols;
+            fp(entry(mat, i, j), rows, cols, mat->stride, resp);
+        }
+    }
+
+    return 1;
+}
+
+//! The number of rows and columns in a tile of `dmatrix_transpose`.
+#define BLOCK_T 32
+//! The length of the shared dimension in a block of the matrix product.
+#define BLOCK_K 128
+//! The number of columns in a block of the matrix product.
+#define BLOCK_J 256
+//! The number of entry operations below which a thread is not worth creating.
+#define THREAD_WORK (1 << 16)
+
+//! The maximum number of threads used by the kernels, 0 if not set.
+static size_t n_threads;
+
+//! Represents the operands of a matrix kernel.
+struct kernel_task {
+    /*! Points to the first operand. */
+    dmatrix *mat1;
+    /*! Points to the second operand, if any. */
+    dmatrix *mat2;
+    /*! Points to the result matrix, if any. */
+    dmatrix *out;
+    /*! Points to the vector operand, if any. */
+    const void *vec;
+    /*! Points to the result vector, if any. */
+    void *vec_out;
+    /*! Points to the function to map entries with, if any. */
+    void (*fp)(void);
+};
+
+//! Represents a block of rows processed by one thread.
+struct row_block {
+    /*! Points to a function that processes rows in `[start, end)`. */
+    void (*work)(void *ctx, size_t start, size_t end);
+    /*! Points to the operands of the kernel. */
+    void *ctx;
+    /*! The first row of the block. */
+    size_t start;
+    /*! The row after the last row of the block. */
+    size_t end;
+};
+
+static void *row_block_run(void *p) {
+    struct row_block *block = p;
+    block->work(block->ctx, block->start, block->end);
+    return NULL;
+}
+
+//! Splits rows into blocks and processes them on multiple threads.
+/*!
+Each thread gets at least `THREAD_WORK` entry operations, so small kernels run
+on the calling thread without paying for thread creation. The calling thread
+processes the first block. If a thread cannot be created, its block is processed
+by the calling thread instead.
+
+\param rows The number of rows to process.
+\param row_work The number of entry operations per row.
+*/
+static void parallel_rows(size_t rows, size_t row_work,
+                          void (*work)(void *ctx, size_t start, size_t end),
+                          void *ctx) {
+    size_t n = n_threads;
+    if (n == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        n = online > 0 ? (size_t) online : 1;
+    }
+    size_t total = row_work > 0 && rows > SIZE_MAX / row_work ?
+        SIZE_MAX : rows * row_work;
+    if (n > total / THREAD_WORK) {
+        n = total / THREAD_WORK;
+    }
+    if (n > rows) {
+        n = rows;
+    }
+    if (n <= 1) {
+        work(ctx, 0, rows);
+        return;
+    }
+
+    struct row_block *block_arr = malloc(sizeof(struct row_block) * n);
+    pthread_t *thread_arr = malloc(sizeof(pthread_t) * n);
+    int *started = calloc(n, sizeof(int));
+    if (block_arr == NULL || thread_arr == NULL || started == NULL) {
+        free(block_arr);
+        free(thread_arr);
+        free(started);
+        work(ctx, 0, rows);
+        return;
+    }
+    for (size_t t = 0; t < n; t++) {
+        block_arr[t].work = work;
+        block_arr[t].ctx = ctx;
+        block_arr[t].start = rows * t / n;
+        block_arr[t].end = rows * (t + 1) / n;
+    }
+    for (size_t t = 1; t < n; t++) {
+        started[t] = pthread_create(
+                thread_arr + t, NULL, row_block_run, block_arr + t) == 0;
+    }
+    for (size_t t = 0; t < n; t++) {
+        if (!started[t]) {
+            row_block_run(block_arr + t);
+        }
+    }
+    for (size_t t = 1; t < n; t++) {
+        if (started[t]) {
+            pthread_join(thread_arr[t], NULL);
+        }
+    }
+    free(block_arr);
+    free(thread_arr);
+    free(started);
+}
+
+int dmatrix_set_threads(size_t n) {
+    if (n == 0) {
+        darray_errno = DARRAY_EINDEX;
+        return 0;
+    }
+
+    n_threads = n;
+
+    return 1;
+}
+
+//! Copies a transposed tile of entries of a given type.
+#define TRANSPOSE_TILE(type) do {                                              \
+    for (size_t i = i_start; i < i_end; i++) {                                 \
+        type *out_row = (type *) entry(task->out, i, 0);                       \
+        for (size_t j = j_start; j < j_end; j++) {                             \
+            out_row[j] = *((type *) entry(task->mat1, j, i));                  \
+        }                                                                      \
+    }                                                                          \
+} while (0)
+
+static void transpose_rows(void *ctx, size_t start, size_t end) {
+    struct kernel_task *task = ctx;
+    size_t item_size = task->mat1->item_size;
+    for (size_t i_start = start; i_start < end; i_start += BLOCK_T) {
+        size_t i_end = end - i_start < BLOCK_T ? end : i_start + BLOCK_T;
+        for (size_t j_start = 0; j_start < task->out->cols;
+                j_start += BLOCK_T) {
+            size_t j_end = task->out->cols - j_start < BLOCK_T ?
+                task->out->cols : j_start + BLOCK_T;
+            if (item_size == sizeof(uint32_t)) {
+                TRANSPOSE_TILE(uint32_t);
+            } else if (item_size == sizeof(uint64_t)) {
+                TRANSPOSE_TILE(uint64_t);
+            } else {
+                for (size_t i = i_start; i < i_end; i++) {
+                    for (size_t j = j_start; j < j_end; j++) {
+                        memcpy(entry(task->out, i, j),
+                               entry(task->mat1, j, i),
+                               item_size);
+                    }
+                }
+            }
+        }
+    }
+}
+
+dmatrix *dmatrix_transpose(dmatrix *mat) {
+    if (mat == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+
+    dmatrix *trans = new_dmatrix(mat->item_size, mat->cols, mat->rows);
+    if (trans == NULL) {
+        return NULL;
+    }
+    struct kernel_task task = { .mat1 = mat, .out = trans };
+    parallel_rows(trans->rows, trans->cols, transpose_rows, &task);
+
+    return trans;
+}
+
+//! Generates the matrix kernels for entries of a given type.
+#define MAKE_DMATRIX_KERNELS(type, alph)                                       \
+static void mul_##alph##_rows(void *ctx, size_t start, size_t end) {           \
+    struct kernel_task *task = ctx;                                            \
+    size_t n = task->mat1->cols;                                               \
+    size_t m = task->mat2->cols;                                               \
+    for (size_t kk = 0; kk < n; kk += BLOCK_K) {                               \
+        size_t k_end = n - kk < BLOCK_K ? n : kk + BLOCK_K;                    \
+        for (size_t jj = 0; jj < m; jj += BLOCK_J) {                           \
+            size_t j_len = m - jj < BLOCK_J ? m - jj : BLOCK_J;                \
+            for (size_t i = start; i < end; i++) {                             \
+                type *restrict out_row = (type *) entry(task->out, i, jj);     \
+                const type *mat1_row = (const type *) entry(task->mat1, i, 0); \
+                for (size_t k = kk; k < k_end; k++) {                          \
+                    type x = mat1_row[k];                                      \
+                    const type *restrict mat2_row =                            \
+                        (const type *) entry(task->mat2, k, jj);               \
+                    for (size_t j = 0; j < j_len; j++) {                       \
+                        out_row[j] += x * mat2_row[j];                         \
+                    }                                                          \
+                }                                                              \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+dmatrix *dmatrix_mul_##alph(dmatrix *mat1, dmatrix *mat2) {                    \
+    if (mat1 == NULL || mat2 == NULL) {                                        \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return NULL;                                                           \
+    }                                                                          \
+    if (mat1->item_size != sizeof(type) || mat2->item_size != sizeof(type) ||  \
+            mat1->cols != mat2->rows) {                                        \
+        darray_errno = DARRAY_ESHAPE;                                          \
+        return NULL;                                                           \
+    }                                                                          \
+                                                                               \
+    dmatrix *prod = new_dmatrix(sizeof(type), mat1->rows, mat2->cols);         \
+    if (prod == NULL) {                                                        \
+        return NULL;                                                           \
+    }                                                                          \
+    struct kernel_task task = { .mat1 = mat1, .mat2 = mat2, .out = prod };     \
+    parallel_rows(prod->rows, mat1->cols * prod->cols, mul_##alph##_rows,      \
+                  &task);                                                      \
+                                                                               \
+    return prod;                                                               \
+}                                                                              \
+                                                                               \
+static void mul_vec_##alph##_rows(void *ctx, size_t start, size_t end) {       \
+    struct kernel_task *task = ctx;                                            \
+    const type *vec = task->vec;                                               \
+    type *out = task->vec_out;                                                 \
+    for (size_t i = start; i < end; i++) {                                     \
+        const type *row = (const type *) entry(task->mat1, i, 0);              \
+        type sum = 0;                                                          \
+        for (size_t j = 0; j < task->mat1->cols; j++) {                        \
+            sum += row[j] * vec[j];                                            \
+        }                                                                      \
+        out[i] = sum;                                                          \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+int dmatrix_mul_vec_##alph(dmatrix *mat, const type *vec, type *out) {         \
+    if (mat == NULL || vec == NULL || out == NULL) {                           \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    if (mat->item_size != sizeof(type)) {                                      \
+        darray_errno = DARRAY_ESHAPE;                                          \
+        return 0;                                                              \
+    }                                                                          \
+                                                                               \
+    struct kernel_task task = { .mat1 = mat, .vec = vec, .vec_out = out };     \
+    parallel_rows(mat->rows, mat->cols, mul_vec_##alph##_rows, &task);         \
+                                                                               \
+    return 1;                                                                  \
+}                                                                              \
+                                                                               \
+static void map_##alph##_rows(void *ctx, size_t start, size_t end) {           \
+    struct kernel_task *task = ctx;                                            \
+    type (*fp)(type) = (type (*)(type)) task->fp;                              \
+    for (size_t i = start; i < end; i++) {                                     \
+        type *row = (type *) entry(task->mat1, i, 0);                          \
+        for (size_t j = 0; j < task->mat1->cols; j++) {                        \
+            row[j] = fp(row[j]);                                               \
+        }                                                                      \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+int dmatrix_map_##alph(dmatrix *mat, type (*fp)(type)) {                       \
+    if (mat == NULL || fp == NULL) {                                           \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    if (mat->item_size != sizeof(type)) {                                      \
+        darray_errno = DARRAY_ESHAPE;                                          \
+        return 0;                                                              \
+    }                                                                          \
+                                                                               \
+    struct kernel_task task = { .mat1 = mat, .fp = (void (*)(void)) fp };      \
+    parallel_rows(mat->rows, mat->cols, map_##alph##_rows, &task);             \
+                                                                               \
+    return 1;                                                                  \
+}
+
+MAKE_DMATRIX_KERNELS(double, double)
+MAKE_DMATRIX_KERNELS(float, float)
+MAKE_DMATRIX_KERNELS(int, int)
+
+int del_dmatrix(dmatrix *mat) {
+    if (mat == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    free(mat->item_arr);
+    free(mat);
+
+    return 1;
+}
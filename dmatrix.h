@@ -0,0 +1,288 @@
+/*!
+\file dmatrix.h
+\author Edward Ji
+\date 19 Oct 2026
+\brief The header file of dense matrix with contiguous storage.
+*/
+
+#ifndef DMATRIX_H
+#define DMATRIX_H
+
+#include <stddef.h>
+
+#include "darray.h"
+
+//! The tile aggregate function pointer type definition.
+/*!
+A function of this type should take in a pointer to the first entry of a
+rectangular tile of a matrix and modify the result given by the last pointer.
+The entries of each row in the tile are contiguous, and consecutive rows are
+`stride` entries apart. The function should not modify the tile.
+
+\param tile_ptr A pointer to the top left entry of the tile.
+\param rows The number of rows in the tile.
+\param cols The number of columns in the tile.
+\param stride The number of entries between the starts of two rows.
+\param resp A pointer to the result.
+
+\see Typically used with `dmatrix_aggregate_tiles`.
+
+An example of a tile aggregate function pointer is a function that finds the
+maximum integer in a tile:
+```
+void int_max_tile(const void *tile_ptr,
+                  size_t rows, size_t cols, size_t stride, void *resp) {
+    const int *row = tile_ptr;
+    int *max = resp;
+    for (size_t i = 0; i < rows; i++, row += stride) {
+        for (size_t j = 0; j < cols; j++) {
+            *max = row[j] > *max ? row[j] : *max;
+        }
+    }
+}
+```
+*/
+typedef void (*tile_aggregate)(const void *tile_ptr,
+                               size_t rows, size_t cols, size_t stride,
+                               void *resp);
+
+//! Represents a dense matrix.
+typedef struct dmatrix dmatrix;
+
+//! Creates a new dense matrix.
+/*!
+The function allocates a new matrix whose entries are stored by value in a
+single row-major buffer. All entries are initialized to zero bytes. Unlike a
+dynamic array of dynamic arrays, no entry is allocated on its own.
+
+\param item_size The size of an entry in bytes, e.g. `sizeof(int)`.
+\param rows The initial number of rows.
+\param cols The initial number of columns.
+\returns A new dense matrix, or `NULL` if unsuccessful.
+\see To deallocate the matrix, use `del_dmatrix`.
+*/
+dmatrix *new_dmatrix(size_t item_size, size_t rows, size_t cols);
+
+//! Getter for the number of rows of the matrix.
+/*!
+\param mat A pointer to a dense matrix.
+\returns The number of rows, or 0 if the argument is `NULL`.
+\note This function does not set `darray_errno` even if the argument is `NULL`.
+*/
+size_t dmatrix_rows(dmatrix *mat);
+
+//! Getter for the number of columns of the matrix.
+/*!
+\param mat A pointer to a dense matrix.
+\returns The number of columns, or 0 if the argument is `NULL`.
+\note This function does not set `darray_errno` even if the argument is `NULL`.
+*/
+size_t dmatrix_cols(dmatrix *mat);
+
+//! Getter for the distance between the starts of two rows.
+/*!
+Rows may be padded to make room for more columns, so the entry at row `i` and
+column `j` is `i * stride + j` entries after the first one.
+
+\param mat A pointer to a dense matrix.
+\returns The number of entries between two rows, or 0 if the argument is
+`NULL`.
+\note This function does not set `darray_errno` even if the argument is `NULL`.
+*/
+size_t dmatrix_stride(dmatrix *mat);
+
+//! Gets an entry in a matrix.
+/*!
+\param mat A pointer to a dense matrix.
+\param row A valid row index.
+\param col A valid column index.
+\returns A pointer to the entry if successful, `NULL` otherwise.
+\warning The pointer is invalidated when rows or columns are appended or popped.
+*/
+void *dmatrix_get(dmatrix *mat, size_t row, size_t col);
+
+//! Gets a row in a matrix.
+/*!
+The entries of a row are contiguous, so the returned pointer can be indexed like
+an ordinary C array of `dmatrix_cols` entries.
+
+\param mat A pointer to a dense matrix.
+\param row A valid row index.
+\returns A pointer to the first entry of the row if successful, `NULL`
+otherwise.
+\warning The pointer is invalidated when rows or columns are appended or popped.
+*/
+void *dmatrix_row(dmatrix *mat, size_t row);
+
+//! Returns a dynamic array viewing a row in a matrix.
+/*!
+The items of the returned array point to the entries of the row in place, so
+dynamic array functions that read items, such as `darray_search` and
+`darray_aggregate`, and functions that modify items in place, such as
+`darray_foreach`, see and change the row without copying entries. Functions
+that rearrange, insert or remove items, such as `darray_sort`, `darray_insert`
+and `darray_pop`, only change the pointers of the view and leave the row as it
+is.
+
+\param mat A pointer to a dense matrix.
+\param row A valid row index.
+\returns A new allocated dynamic array with no free function, or `NULL` if
+unsuccessful.
+\warning The view is invalidated when rows or columns are appended or popped.
+*/
+darray *dmatrix_row_view(dmatrix *mat, size_t row);
+
+//! Appends a row to the matrix.
+/*!
+\param mat A pointer to a dense matrix.
+\param row_ptr A pointer to as many entries as there are columns to copy.
+\returns 1 if successful, 0 otherwise.
+*/
+int dmatrix_append_row(dmatrix *mat, const void *row_ptr);
+
+//! Appends a column to the matrix.
+/*!
+\param mat A pointer to a dense matrix.
+\param col_ptr A pointer to as many entries as there are rows to copy.
+\returns 1 if successful, 0 otherwise.
+*/
+int dmatrix_append_col(dmatrix *mat, const void *col_ptr);
+
+//! Pops a row at a given index.
+/*!
+\param mat A pointer to a dense matrix.
+\param row A valid row index.
+\returns 1 if successful, 0 otherwise.
+*/
+int dmatrix_pop_row(dmatrix *mat, size_t row);
+
+//! Pops a column at a given index.
+/*!
+\param mat A pointer to a dense matrix.
+\param col A valid column index.
+\returns 1 if successful, 0 otherwise.
+*/
+int dmatrix_pop_col(dmatrix *mat, size_t col);
+
+//! Aggregates all entries into a single result.
+/*!
+This function calls the aggregation function with every entry in row-major
+order as the first argument, and the result pointer as the second argument.
+
+\param mat A pointer to a dense matrix.
+\param resp A pointer to the result object.
+\param fp A pointer to an aggregate function.
+\returns 1 if successful, 0 otherwise.
+*/
+int dmatrix_aggregate(dmatrix *mat, void *resp, aggregate fp);
+
+//! Aggregates all entries tile by tile into a single result.
+/*!
+This function splits the matrix into tiles of at most the given size and calls
+the aggregation function once per tile, row of tiles by row of tiles. Choosing
+tiles that fit in the cache keeps the work on each tile cache resident, and
+calling the function once per tile lets it use a tight loop over entries.
+
+\param mat A pointer to a dense matrix.
+\param tile_rows The maximum number of rows in a tile.
+\param tile_cols The maximum number of columns in a tile.
+\param resp A pointer to the result object.
+\param fp A pointer to a tile aggregate function.
+\returns 1 if successful, 0 otherwise.
+*/
+int dmatrix_aggregate_tiles(dmatrix *mat, size_t tile_rows, size_t tile_cols,
+                            void *resp, tile_aggregate fp);
+
+//! Sets the number of threads used by the matrix kernels.
+/*!
+The kernels split the rows of their result into blocks and process the blocks on
+up to this many threads. By default, it is the number of online processors.
+
+\param n The maximum number of threads, at least 1.
+\returns 1 if successful, 0 otherwise.
+*/
+int dmatrix_set_threads(size_t n);
+
+//! Returns the transpose of a given matrix.
+/*!
+The transpose is copied tile by tile so that both the reads and the writes stay
+within a few cache lines at a time.
+
+\param mat A pointer to a dense matrix.
+\returns A new dense matrix, or `NULL` if unsuccessful.
+*/
+dmatrix *dmatrix_transpose(dmatrix *mat);
+
+//! Multiplies two matrices of `double` entries.
+/*!
+The product is computed with cache blocking over the shared dimension and the
+columns of the result, with an inner loop over contiguous entries that the
+compiler can vectorize. Blocks of rows run on separate threads.
+
+Functions with the `_float` and `_int` suffixes do the same for `float` and
+`int` entries.
+
+\param mat1 A pointer to a dense matrix with `n` columns.
+\param mat2 A pointer to a dense matrix with `n` rows.
+\returns A new dense matrix, or `NULL` if unsuccessful.
+
+\note The function fails with `DARRAY_ESHAPE` if the dimensions do not match or
+the entries are not of the expected size.
+*/
+dmatrix *dmatrix_mul_double(dmatrix *mat1, dmatrix *mat2);
+
+//! Multiplies two matrices of `float` entries.
+/*! \see `dmatrix_mul_double` */
+dmatrix *dmatrix_mul_float(dmatrix *mat1, dmatrix *mat2);
+
+//! Multiplies two matrices of `int` entries.
+/*! \see `dmatrix_mul_double` */
+dmatrix *dmatrix_mul_int(dmatrix *mat1, dmatrix *mat2);
+
+//! Multiplies a matrix of `double` entries by a vector.
+/*!
+Functions with the `_float` and `_int` suffixes do the same for `float` and
+`int` entries.
+
+\param mat A pointer to a dense matrix.
+\param vec A pointer to as many entries as there are columns.
+\param out A pointer to store as many entries as there are rows.
+\returns 1 if successful, 0 otherwise.
+*/
+int dmatrix_mul_vec_double(dmatrix *mat, const double *vec, double *out);
+
+//! Multiplies a matrix of `float` entries by a vector.
+/*! \see `dmatrix_mul_vec_double` */
+int dmatrix_mul_vec_float(dmatrix *mat, const float *vec, float *out);
+
+//! Multiplies a matrix of `int` entries by a vector.
+/*! \see `dmatrix_mul_vec_double` */
+int dmatrix_mul_vec_int(dmatrix *mat, const int *vec, int *out);
+
+//! Replaces every `double` entry of a matrix with a function of it.
+/*!
+Functions with the `_float` and `_int` suffixes do the same for `float` and
+`int` entries.
+
+\param mat A pointer to a dense matrix.
+\param fp A pointer to a function that maps an entry to its new value.
+\returns 1 if successful, 0 otherwise.
+*/
+int dmatrix_map_double(dmatrix *mat, double (*fp)(double));
+
+//! Replaces every `float` entry of a matrix with a function of it.
+/*! \see `dmatrix_map_double` */
+int dmatrix_map_float(dmatrix *mat, float (*fp)(float));
+
+//! Replaces every `int` entry of a matrix with a function of it.
+/*! \see `dmatrix_map_double` */
+int dmatrix_map_int(dmatrix *mat, int (*fp)(int));
+
+//! Deallocates a given matrix.
+/*!
+\param mat A pointer to a dense matrix to deallocate.
+\returns 1 if successful, 0 otherwise.
+*/
+int del_dmatrix(dmatrix *mat);
+
+#endif
@@ -0,0 +1,212 @@
+/*!
+\file dseg.c
+\author Edward Ji
+\date 19 Oct 2026
+\brief The source code of segmented array with stable item slots.
+
+\warning Note that some types and functions have no declaration or incomplete
+definition in the header file. The documentation in this source file is targeted
+to maintainers.
+*/
+
+#include <stdlib.h>
+
+#include "dseg.h"
+
+//! The base two logarithm of the size of the first block.
+#define FIRST_BITS 4
+
+//! The size of the first block.
+#define FIRST_SIZE ((size_t) 1 << FIRST_BITS)
+
+//! The maximum number of blocks, enough for any index.
+#define MAX_BLOCKS (sizeof(size_t) * 8 - FIRST_BITS)
+
+//! Represents a segmented array structure.
+/*!
+Block `b` holds `FIRST_SIZE << b` slots, so the first `b` blocks together hold
+`FIRST_SIZE * (2^b - 1)` slots. Adding `FIRST_SIZE` to an index therefore gives
+a number whose highest set bit picks the block and whose other bits are the
+offset within it.
+*/
+struct dseg {
+    /*! Points to the allocated blocks of item pointers. */
+    void **block_arr[MAX_BLOCKS];
+    /*! The number of allocated blocks. */
+    size_t blocks;
+    /*! The number of items stored in the array. */
+    size_t len;
+    /*! Points to a function that frees an item in the array. */
+    consumer item_free;
+};
+
+//! Returns the index of the highest set bit of a non-zero number.
+static unsigned high_bit(size_t x) {
+#if defined(__GNUC__)
+    return (unsigned) (sizeof(unsigned long long) * 8 - 1 -
+                       __builtin_clzll((unsigned long long) x));
+#else
+    unsigned bit = 0;
+    while (x >>= 1) {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+//! Returns the number of slots in the first given number of blocks.
+static size_t blocks_cap(size_t blocks) {
+    return FIRST_SIZE * (((size_t) 1 << blocks) - 1);
+}
+
+//! Returns a pointer to the slot of an index without checking it.
+static void **slot(dseg *seg, size_t index) {
+    size_t pos = index + FIRST_SIZE;
+    unsigned bit = high_bit(pos);
+    return seg->block_arr[bit - FIRST_BITS] + (pos ^ ((size_t) 1 << bit));
+}
+
+dseg *new_dseg(consumer item_free) {
+    dseg *seg = malloc(sizeof(dseg));
+    if (seg == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        return NULL;
+    }
+    seg->blocks = 0;
+    seg->len = 0;
+    seg->item_free = item_free;
+
+    return seg;
+}
+
+size_t dseg_len(dseg *seg) {
+    if (seg == NULL) {
+        return 0;
+    }
+    return seg->len;
+}
+
+int dseg_append(dseg *seg, void *item_ptr) {
+    if (seg == NULL || item_ptr == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    if (seg->len == blocks_cap(seg->blocks)) {
+        if (seg->blocks == MAX_BLOCKS) {
+            darray_errno = DARRAY_EALLOC;
+            return 0;
+        }
+        void **block = malloc(sizeof(void *) * (FIRST_SIZE << seg->blocks));
+        if (block == NULL) {
+            darray_errno = DARRAY_EALLOC;
+            return 0;
+        }
+        seg->block_arr[seg->blocks++] = block;
+    }
+    *slot(seg, seg->len++) = item_ptr;
+
+    return 1;
+}
+
+void *dseg_get(dseg *seg, size_t index) {
+    void **item_slot = dseg_slot(seg, index);
+    return item_slot == NULL ? NULL : *item_slot;
+}
+
+void **dseg_slot(dseg *seg, size_t index) {
+    if (seg == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+    if (index >= seg->len) {
+        darray_errno = DARRAY_EINDEX;
+        return NULL;
+    }
+
+    return slot(seg, index);
+}
+
+int dseg_pop(dseg *seg) {
+    if (seg == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (seg->len == 0) {
+        darray_errno = DARRAY_EINDEX;
+        return 0;
+    }
+
+    seg->len--;
+    if (seg->item_free != NULL) {
+        seg->item_free(*slot(seg, seg->len));
+    }
+    // The last block is kept until the one before it is also empty.
+    if (seg->blocks >= 2 && seg->len <= blocks_cap(seg->blocks - 2)) {
+        free(seg->block_arr[--seg->blocks]);
+    }
+
+    return 1;
+}
+
+int dseg_foreach(dseg *seg, consumer fp) {
+    if (seg == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    size_t remain = seg->len;
+    for (size_t b = 0; remain > 0; b++) {
+        size_t n = FIRST_SIZE << b;
+        n = n < remain ? n : remain;
+        for (size_t i = 0; i < n; i++) {
+            fp(seg->block_arr[b][i]);
+        }
+        remain -= n;
+    }
+
+    return 1;
+}
+
+darray *dseg_to_darray(dseg *seg) {
+    if (seg == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+
+    darray *array = new_darray(NULL);
+    if (array == NULL) {
+        return NULL;
+    }
+    size_t remain = seg->len;
+    for (size_t b = 0; remain > 0; b++) {
+        size_t n = FIRST_SIZE << b;
+        n = n < remain ? n : remain;
+        for (size_t i = 0; i < n; i++) {
+            if (!darray_append(array, seg->block_arr[b][i])) {
+                del_darray(array);
+                return NULL;
+            }
+        }
+        remain -= n;
+    }
+
+    return array;
+}
+
+int del_dseg(dseg *seg) {
+    if (seg == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    if (seg->item_free != NULL) {
+        dseg_foreach(seg, seg->item_free);
+    }
+    for (size_t b = 0; b < seg->blocks; b++) {
+        free(seg->block_arr[b]);
+    }
+    free(seg);
+
+    return 1;
+}
@@ -0,0 +1,109 @@
+/*!
+\file dseg.h
+\author Edward Ji
+\date 19 Oct 2026
+\brief The header file of segmented array with stable item slots.
+*/
+
+#ifndef DSEG_H
+#define DSEG_H
+
+#include <stddef.h>
+
+#include "darray.h"
+
+//! Represents a segmented array.
+/*!
+A segmented array stores item pointers in blocks whose sizes are powers of two,
+found through a small fixed directory. Growing the array allocates a new block
+and never moves the slots that are already in use, so appending has no latency
+spikes and slot addresses stay valid until their items are popped.
+*/
+typedef struct dseg dseg;
+
+//! Creates a new segmented array.
+/*!
+\param item_free A pointer to a function that frees an item, or `NULL`.
+\returns A new segmented array, or `NULL` if unsuccessful.
+\see To deallocate the array, use `del_dseg`.
+*/
+dseg *new_dseg(consumer item_free);
+
+//! Getter for the length of the segmented array.
+/*!
+\param seg A pointer to a segmented array.
+\returns The number of items, or 0 if the argument is `NULL`.
+\note This function does not set `darray_errno` even if the argument is `NULL`.
+*/
+size_t dseg_len(dseg *seg);
+
+//! Appends an item to the segmented array.
+/*!
+When the last block is full, a new block as big as all the previous blocks
+combined is allocated. The existing slots are not copied.
+
+\param seg A pointer to a segmented array.
+\param item_ptr A pointer to an item.
+\returns 1 if successful, 0 otherwise.
+*/
+int dseg_append(dseg *seg, void *item_ptr);
+
+//! Gets an item in the segmented array.
+/*!
+The slot of an item is found in constant time with a couple of bit operations.
+
+\param seg A pointer to a segmented array.
+\param index A valid index.
+\returns The item pointer if successful, `NULL` otherwise.
+*/
+void *dseg_get(dseg *seg, size_t index);
+
+//! Gets the slot of an item in the segmented array.
+/*!
+\param seg A pointer to a segmented array.
+\param index A valid index.
+\returns A pointer to the slot holding the item pointer if successful, `NULL`
+otherwise.
+\note The slot stays at the same address when items are appended. It is only
+invalidated when its item is popped.
+*/
+void **dseg_slot(dseg *seg, size_t index);
+
+//! Pops the last item of the segmented array.
+/*!
+The item is freed with the free function of the array. A block is deallocated
+once the array shrinks well below its start, so popping and appending around a
+block boundary does not keep allocating it.
+
+\param seg A pointer to a segmented array.
+\returns 1 if successful, 0 otherwise.
+*/
+int dseg_pop(dseg *seg);
+
+//! Calls each item in the segmented array with a given function.
+/*!
+\param seg A pointer to a segmented array.
+\param fp A pointer to a function that takes an item.
+\returns 1 if successful, 0 otherwise.
+*/
+int dseg_foreach(dseg *seg, consumer fp);
+
+//! Returns a dynamic array of the items in the segmented array.
+/*!
+The item pointers are copied block by block into a new array, so all the
+dynamic array functions can operate on them.
+
+\param seg A pointer to a segmented array.
+\returns A new allocated dynamic array with no free function, or `NULL` if
+unsuccessful.
+*/
+darray *dseg_to_darray(dseg *seg);
+
+//! Deallocates a given segmented array.
+/*!
+\param seg A pointer to a segmented array to deallocate.
+\returns 1 if successful, 0 otherwise.
+*/
+int del_dseg(dseg *seg);
+
+#endif
@@ -0,0 +1,793 @@
+/*!
+\file dsort.c
+\author Edward Ji
+\date 19 Oct 2026
+\brief The source code of external merge sort for items that exceed memory.
+
+\warning Note that some types and functions have no declaration or incomplete
+definition in the header file. The documentation in this source file is targeted
+to maintainers.
+*/
+
+#include <stdlib.h>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "dsort.h"
+
+#ifndef DSORT_IO_BUFFER
+//! The default maximum size in bytes of the buffer of each run file.
+#define DSORT_IO_BUFFER ((size_t) 1 << 20)
+#endif
+
+#ifndef DSORT_FANIN
+//! The default maximum number of runs merged at once.
+#define DSORT_FANIN 16
+#endif
+
+//! The minimum size in bytes of the buffer of each run file.
+#define IO_BUFFER_MIN ((size_t) 4096)
+
+//! The number of items the merge thread hands over to the caller at once.
+#define BATCH_LEN 4096
+
+//! Represents a sorted run spilled to a temporary file.
+/*!
+A run only keeps a descriptor of its file, which is removed once the descriptor
+is closed. Streams and their I/O buffers are only allocated while the run is
+written or merged.
+*/
+struct dsort_run {
+    /*! The descriptor of the temporary file. */
+    int fd;
+    /*! The number of items written to the file. */
+    size_t len;
+    /*! The number of merge passes the items of the run went through. */
+    size_t level;
+};
+
+//! Represents an external sorter structure.
+struct dsort {
+    /*! Points to the items kept in memory, which the array owns. */
+    darray *buffer;
+    /*! Points to the runs spilled to temporary files. */
+    darray *run_arr;
+    /*! The number of bytes of items and I/O buffers to keep in memory. */
+    size_t budget;
+    /*! The number of bytes of items to keep in memory, which leaves room for
+    the I/O buffer of the run being spilled. */
+    size_t limit;
+    /*! The size in bytes of the I/O buffers used to spill and merge runs. */
+    size_t io_size;
+    /*! The number of bytes of items currently in memory. */
+    size_t used;
+    /*! The number of items pushed and not yet drained. */
+    size_t len;
+    /*! Points to a function that compares two items. */
+    comparator cmp;
+    /*! Points to a function that returns the size of an item, or `NULL`. */
+    sizer size;
+    /*! Points to a function that writes an item to a run file. */
+    serializer write;
+    /*! Points to a function that reads an item from a run file. */
+    deserializer read;
+    /*! Points to a function that frees an item. */
+    consumer item_free;
+};
+
+//! Represents the position of a merge in a run.
+struct merge_cursor {
+    /*! Points to the stream of the run, or `NULL` for the items in memory. */
+    FILE *file;
+    /*! The number of items in the run that are not read yet. */
+    size_t left;
+    /*! Points to the smallest item of the run that is not merged yet. */
+    void *head;
+};
+
+//! Represents a k-way merge of the runs of a sorter.
+/*!
+A merge takes the runs from a given index to the last one, and optionally the
+items kept in memory.
+
+When the merge runs in a background thread, the merged items are handed over in
+two alternating batches. The thread fills one batch while the caller consumes
+the other, so reading the run files overlaps with consuming the items.
+*/
+struct dsort_merge {
+    /*! Points to the sorter whose runs are merged. */
+    dsort *sorter;
+    /*! The index of the first run to merge. */
+    size_t first;
+    /*! Non-zero if the items kept in memory are merged too. */
+    int memory;
+    /*! Points to the streams of the runs, in the order of the runs. */
+    FILE **file_arr;
+    /*! Points to the I/O buffers of the streams. */
+    char *io_buf;
+    /*! Points to a binary min-heap of cursors ordered by their head items. */
+    struct merge_cursor *cursor_arr;
+    /*! The index of the next item to merge from memory. */
+    size_t next;
+    /*! Points to a function that takes the merged items. */
+    consumer_r fp;
+    /*! Points to the context passed to the function. */
+    void *ctx;
+    /*! Non-zero if the merge runs in a background thread. */
+    int threaded;
+    /*! Non-zero if an item cannot be read from a run file. */
+    int failed;
+    /*! Non-zero once the background thread has handed over every batch. */
+    int done;
+    /*! Guards the batches and the flags shared with the background thread. */
+    pthread_mutex_t lock;
+    /*! Signals that a batch has been filled or consumed. */
+    pthread_cond_t cond;
+    /*! Points to the two batches of merged items. */
+    void **batch_arr[2];
+    /*! The number of items in each batch. */
+    size_t batch_len[2];
+    /*! Non-zero for each batch that is ready to be consumed. */
+    int filled[2];
+    /*! The index of the batch being filled. */
+    int fill;
+};
+
+//! Represents a run being written to a temporary file.
+struct run_writer {
+    /*! Points to the sorter the run belongs to. */
+    dsort *sorter;
+    /*! Points to the temporary file. */
+    FILE *file;
+    /*! Points to the I/O buffer of the file. */
+    char *io_buf;
+    /*! The number of items written to the file. */
+    size_t len;
+    /*! Non-zero if an item cannot be written. */
+    int failed;
+};
+
+//! Closes and deallocates a run.
+static void run_free(void *run_ptr) {
+    struct dsort_run *run = run_ptr;
+    close(run->fd);
+    free(run);
+}
+
+//! Splits a number of bytes into I/O buffers for a given number of runs.
+static size_t io_size(size_t bytes, size_t n) {
+    size_t size = bytes / (n > 0 ? n : 1);
+    if (size < IO_BUFFER_MIN) {
+        size = IO_BUFFER_MIN;
+    }
+    if (size > DSORT_IO_BUFFER) {
+        size = DSORT_IO_BUFFER;
+    }
+    return size;
+}
+
+//! Starts writing a new run to a temporary file.
+/*!
+\returns 1 if successful, 0 otherwise.
+*/
+static int writer_open(struct run_writer *writer, dsort *sorter,
+                       size_t io_size) {
+    writer->sorter = sorter;
+    writer->len = 0;
+    writer->failed = 0;
+    writer->io_buf = malloc(io_size);
+    if (writer->io_buf == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        return 0;
+    }
+    writer->file = tmpfile();
+    if (writer->file == NULL) {
+        free(writer->io_buf);
+        darray_errno = DARRAY_EIO;
+        return 0;
+    }
+    setvbuf(writer->file, writer->io_buf, _IOFBF, io_size);
+
+    return 1;
+}
+
+//! Writes an item to a run.
+static void writer_put(struct run_writer *writer, const void *item_ptr) {
+    if (writer->failed) {
+        return;
+    }
+    if (writer->sorter->write(item_ptr, writer->file)) {
+        writer->len++;
+    } else {
+        writer->failed = 1;
+    }
+}
+
+//! Finishes writing a run and releases its stream and I/O buffer.
+/*!
+The run keeps a duplicate of the descriptor of the file, which keeps the removed
+temporary file alive after its stream is closed.
+
+\param level The number of merge passes the items went through.
+\returns A new run if every item is written, `NULL` otherwise.
+*/
+static struct dsort_run *writer_close(struct run_writer *writer,
+                                      size_t level) {
+    int fd = -1;
+    if (!writer->failed && fflush(writer->file) == 0) {
+        fd = dup(fileno(writer->file));
+    }
+    fclose(writer->file);
+    free(writer->io_buf);
+    if (fd < 0) {
+        darray_errno = DARRAY_EIO;
+        return NULL;
+    }
+
+    struct dsort_run *run = malloc(sizeof(struct dsort_run));
+    if (run == NULL) {
+        close(fd);
+        darray_errno = DARRAY_EALLOC;
+        return NULL;
+    }
+    run->fd = fd;
+    run->len = writer->len;
+    run->level = level;
+
+    return run;
+}
+
+//! Returns the number of bytes an item counts against the budget.
+static size_t item_bytes(dsort *sorter, const void *item_ptr) {
+    size_t bytes = sizeof(void *);
+    if (sorter->size != NULL) {
+        bytes += sorter->size(item_ptr);
+    }
+    return bytes;
+}
+
+static int dsort_merge_runs(dsort *sorter, size_t first);
+
+//! Merges the last runs as long as `DSORT_FANIN` of them share a level.
+/*!
+Runs are merged like the digits of a counter in base `DSORT_FANIN`, so each item
+is merged O(log n) times for n runs, and at most `DSORT_FANIN - 1` runs of each
+level are kept open.
+
+\returns 1 if successful, 0 otherwise.
+*/
+static int dsort_cascade(dsort *sorter) {
+    size_t len = darray_len(sorter->run_arr);
+    while (len >= DSORT_FANIN) {
+        struct dsort_run *first = darray_get(sorter->run_arr,
+                                             len - DSORT_FANIN);
+        struct dsort_run *last = darray_get(sorter->run_arr, len - 1);
+        if (first->level != last->level) {
+            break;
+        }
+        if (!dsort_merge_runs(sorter, len - DSORT_FANIN)) {
+            return 0;
+        }
+        len = darray_len(sorter->run_arr);
+    }
+
+    return 1;
+}
+
+//! Sorts the items in memory, writes them to a new run and frees them.
+/*!
+The run is only attached to the sorter once all items are written, so the items
+stay in memory if writing fails.
+*/
+static int dsort_spill(dsort *sorter) {
+    darray *buffer = sorter->buffer;
+    size_t len = darray_len(buffer);
+    if (!darray_partial_sort(buffer, len, sorter->cmp)) {
+        return 0;
+    }
+
+    struct run_writer writer;
+    if (!writer_open(&writer, sorter, sorter->io_size)) {
+        return 0;
+    }
+    for (size_t i = 0; i < len; i++) {
+        writer_put(&writer, darray_get(buffer, i));
+    }
+    struct dsort_run *run = writer_close(&writer, 0);
+    if (run == NULL) {
+        return 0;
+    }
+    if (!darray_append(sorter->run_arr, run)) {
+        run_free(run);
+        return 0;
+    }
+    darray_clear(buffer);
+    sorter->used = 0;
+
+    return dsort_cascade(sorter);
+}
+
+dsort *new_dsort(size_t budget, comparator fp, sizer size,
+                 serializer write, deserializer read, consumer item_free) {
+    if (fp == NULL || write == NULL || read == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+
+    dsort *sorter = malloc(sizeof(dsort));
+    if (sorter == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        return NULL;
+    }
+    sorter->buffer = new_darray(item_free);
+    sorter->run_arr = new_darray(run_free);
+    if (sorter->buffer == NULL || sorter->run_arr == NULL) {
+        del_darray(sorter->buffer);
+        del_darray(sorter->run_arr);
+        free(sorter);
+        return NULL;
+    }
+    sorter->budget = budget;
+    sorter->io_size = io_size(budget, DSORT_FANIN + 1);
+    sorter->limit = sorter->io_size <= budget / 2 ?
+        budget - sorter->io_size : budget;
+    sorter->used = 0;
+    sorter->len = 0;
+    sorter->cmp = fp;
+    sorter->size = size;
+    sorter->write = write;
+    sorter->read = read;
+    sorter->item_free = item_free;
+
+    return sorter;
+}
+
+size_t dsort_len(dsort *sorter) {
+    if (sorter == NULL) {
+        return 0;
+    }
+    return sorter->len;
+}
+
+size_t dsort_runs(dsort *sorter) {
+    if (sorter == NULL) {
+        return 0;
+    }
+    return darray_len(sorter->run_arr);
+}
+
+int dsort_push(dsort *sorter, void *item_ptr) {
+    if (sorter == NULL || item_ptr == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    size_t bytes = item_bytes(sorter, item_ptr);
+    if (darray_len(sorter->buffer) > 0 &&
+            sorter->used + bytes > sorter->limit) {
+        if (!dsort_spill(sorter)) {
+            return 0;
+        }
+    }
+    if (!darray_append(sorter->buffer, item_ptr)) {
+        return 0;
+    }
+    sorter->used += bytes;
+    sorter->len++;
+
+    return 1;
+}
+
+//! Reads the next item of a run into the head of its cursor.
+/*!
+\returns 1 if an item is read, 0 if the run is exhausted or fails to be read.
+*/
+static int cursor_next(struct dsort_merge *merge, struct merge_cursor *cursor) {
+    if (cursor->left == 0) {
+        return 0;
+    }
+    if (cursor->file == NULL) {
+        cursor->head = darray_get(merge->sorter->buffer, merge->next++);
+    } else {
+        cursor->head = merge->sorter->read(cursor->file);
+        if (cursor->head == NULL) {
+            merge->failed = 1;
+            return 0;
+        }
+    }
+    cursor->left--;
+
+    return 1;
+}
+
+//! Moves a cursor down the heap until no child has a smaller head.
+static void cursor_sift_down(struct merge_cursor *cursor_arr, size_t i,
+                             size_t len, comparator cmp) {
+    struct merge_cursor cursor = cursor_arr[i];
+    for (size_t child = 2 * i + 1; child < len; child = 2 * i + 1) {
+        if (child + 1 < len &&
+                cmp(cursor_arr[child + 1].head, cursor_arr[child].head) < 0) {
+            child++;
+        }
+        if (cmp(cursor_arr[child].head, cursor.head) >= 0) {
+            break;
+        }
+        cursor_arr[i] = cursor_arr[child];
+        i = child;
+    }
+    cursor_arr[i] = cursor;
+}
+
+//! Hands over the batch being filled and waits for the other one to be free.
+static void merge_publish(struct dsort_merge *merge) {
+    pthread_mutex_lock(&merge->lock);
+    merge->filled[merge->fill] = 1;
+    pthread_cond_broadcast(&merge->cond);
+    merge->fill ^= 1;
+    while (merge->filled[merge->fill]) {
+        pthread_cond_wait(&merge->cond, &merge->lock);
+    }
+    pthread_mutex_unlock(&merge->lock);
+    merge->batch_len[merge->fill] = 0;
+}
+
+//! Passes a merged item on, either directly or through a batch.
+static void merge_emit(struct dsort_merge *merge, void *item_ptr) {
+    if (!merge->threaded) {
+        merge->fp(item_ptr, merge->ctx);
+        return;
+    }
+    int fill = merge->fill;
+    merge->batch_arr[fill][merge->batch_len[fill]++] = item_ptr;
+    if (merge->batch_len[fill] == BATCH_LEN) {
+        merge_publish(merge);
+    }
+}
+
+//! Opens the streams of the runs of a merge with buffers of a given size.
+/*!
+The runs are read through duplicates of their descriptors, so they stay intact
+if the merge fails.
+
+\returns 1 if successful, 0 otherwise.
+*/
+static int merge_open(struct dsort_merge *merge, size_t io_size) {
+    size_t n = darray_len(merge->sorter->run_arr) - merge->first;
+    merge->file_arr = calloc(n + 1, sizeof(FILE *));
+    merge->io_buf = malloc(io_size * (n > 0 ? n : 1));
+    merge->cursor_arr = malloc(sizeof(struct merge_cursor) * (n + 1));
+    if (merge->file_arr == NULL || merge->io_buf == NULL ||
+            merge->cursor_arr == NULL) {
+        free(merge->file_arr);
+        free(merge->io_buf);
+        free(merge->cursor_arr);
+        darray_errno = DARRAY_EALLOC;
+        return 0;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        struct dsort_run *run = darray_get(merge->sorter->run_arr,
+                                           merge->first + i);
+        int fd = dup(run->fd);
+        FILE *file = fd >= 0 ? fdopen(fd, "rb") : NULL;
+        if (file == NULL) {
+            if (fd >= 0) {
+                close(fd);
+            }
+            for (size_t j = 0; j < i; j++) {
+                fclose(merge->file_arr[j]);
+            }
+            free(merge->file_arr);
+            free(merge->io_buf);
+            free(merge->cursor_arr);
+            darray_errno = DARRAY_EIO;
+            return 0;
+        }
+        setvbuf(file, merge->io_buf + i * io_size, _IOFBF, io_size);
+        rewind(file);
+        merge->file_arr[i] = file;
+    }
+
+    return 1;
+}
+
+//! Closes the streams of a merge and frees its buffers.
+static void merge_close(struct dsort_merge *merge) {
+    for (FILE **file_ptr = merge->file_arr; *file_ptr != NULL; file_ptr++) {
+        fclose(*file_ptr);
+    }
+    free(merge->file_arr);
+    free(merge->io_buf);
+    free(merge->cursor_arr);
+}
+
+//! Merges the runs of a merge in order.
+static void merge_produce(struct dsort_merge *merge) {
+    dsort *sorter = merge->sorter;
+    struct merge_cursor *cursor_arr = merge->cursor_arr;
+    size_t heap_len = 0;
+
+    for (size_t i = merge->first; i < darray_len(sorter->run_arr); i++) {
+        struct dsort_run *run = darray_get(sorter->run_arr, i);
+        struct merge_cursor cursor = {
+            merge->file_arr[i - merge->first], run->len, NULL
+        };
+        if (cursor_next(merge, &cursor)) {
+            cursor_arr[heap_len++] = cursor;
+        }
+    }
+    struct merge_cursor memory = {
+        NULL, merge->memory ? darray_len(sorter->buffer) : 0, NULL
+    };
+    if (cursor_next(merge, &memory)) {
+        cursor_arr[heap_len++] = memory;
+    }
+    for (size_t i = heap_len / 2; i > 0; i--) {
+        cursor_sift_down(cursor_arr, i - 1, heap_len, sorter->cmp);
+    }
+
+    while (heap_len > 0 && !merge->failed) {
+        merge_emit(merge, cursor_arr[0].head);
+        if (!cursor_next(merge, cursor_arr)) {
+            cursor_arr[0] = cursor_arr[--heap_len];
+        }
+        cursor_sift_down(cursor_arr, 0, heap_len, sorter->cmp);
+    }
+    for (size_t i = 0; i < heap_len; i++) {
+        if (sorter->item_free != NULL) {
+            sorter->item_free(cursor_arr[i].head);
+        }
+    }
+
+    if (merge->threaded) {
+        if (merge->batch_len[merge->fill] > 0) {
+            merge_publish(merge);
+        }
+        pthread_mutex_lock(&merge->lock);
+        merge->done = 1;
+        pthread_cond_broadcast(&merge->cond);
+        pthread_mutex_unlock(&merge->lock);
+    }
+}
+
+//! Runs a merge in a background thread.
+static void *merge_run(void *merge_ptr) {
+    merge_produce(merge_ptr);
+    return NULL;
+}
+
+//! Consumes the batches handed over by the background thread of a merge.
+static void merge_consume(struct dsort_merge *merge) {
+    for (int batch = 0; ; batch ^= 1) {
+        pthread_mutex_lock(&merge->lock);
+        while (!merge->filled[batch] && !merge->done) {
+            pthread_cond_wait(&merge->cond, &merge->lock);
+        }
+        if (!merge->filled[batch]) {
+            pthread_mutex_unlock(&merge->lock);
+            break;
+        }
+        pthread_mutex_unlock(&merge->lock);
+
+        for (size_t i = 0; i < merge->batch_len[batch]; i++) {
+            merge->fp(merge->batch_arr[batch][i], merge->ctx);
+        }
+
+        pthread_mutex_lock(&merge->lock);
+        merge->filled[batch] = 0;
+        pthread_cond_broadcast(&merge->cond);
+        pthread_mutex_unlock(&merge->lock);
+    }
+}
+
+//! Writes a merged item to a run and frees it.
+static void merge_write(void *item_ptr, void *writer_ptr) {
+    struct run_writer *writer = writer_ptr;
+    writer_put(writer, item_ptr);
+    if (writer->sorter->item_free != NULL) {
+        writer->sorter->item_free(item_ptr);
+    }
+}
+
+//! Merges the runs from a given index to the last one into a single run.
+/*!
+The merge uses an I/O buffer for each run and one for the merged run, which
+share the bytes of the budget not taken by items in memory. If the merge fails,
+the runs are left as they are.
+
+\returns 1 if successful, 0 otherwise.
+*/
+static int dsort_merge_runs(dsort *sorter, size_t first) {
+    size_t avail = sorter->budget > sorter->used ?
+        sorter->budget - sorter->used : 0;
+    size_t size = io_size(avail, darray_len(sorter->run_arr) - first + 1);
+    struct dsort_run *run = darray_get(sorter->run_arr, first);
+    size_t level = run->level + 1;
+
+    struct run_writer writer;
+    if (!writer_open(&writer, sorter, size)) {
+        return 0;
+    }
+    struct dsort_merge merge = {
+        .sorter = sorter,
+        .first = first,
+        .memory = 0,
+        .fp = merge_write,
+        .ctx = &writer,
+        .threaded = 0
+    };
+    if (!merge_open(&merge, size)) {
+        darray_error error = darray_errno;
+        writer.failed = 1;
+        writer_close(&writer, level);
+        darray_errno = error;
+        return 0;
+    }
+    merge_produce(&merge);
+    merge_close(&merge);
+    run = writer_close(&writer, level);
+    if (run == NULL || merge.failed) {
+        if (run != NULL) {
+            run_free(run);
+        }
+        darray_errno = DARRAY_EIO;
+        return 0;
+    }
+
+    if (!darray_pop_range(sorter->run_arr, first,
+                          darray_len(sorter->run_arr)) ||
+            !darray_append(sorter->run_arr, run)) {
+        run_free(run);
+        return 0;
+    }
+
+    return 1;
+}
+
+//! Frees the items and runs left in a sorter.
+static void dsort_reset(dsort *sorter) {
+    darray_clear(sorter->buffer);
+    darray_clear(sorter->run_arr);
+    sorter->used = 0;
+    sorter->len = 0;
+}
+
+int dsort_drain_r(dsort *sorter, consumer_r fp, void *ctx) {
+    if (sorter == NULL || fp == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    darray *buffer = sorter->buffer;
+    if (!darray_partial_sort(buffer, darray_len(buffer), sorter->cmp)) {
+        return 0;
+    }
+    // The smallest runs are merged ahead so the final merge reads at most
+    // `DSORT_FANIN` run files at once.
+    while (darray_len(sorter->run_arr) > DSORT_FANIN) {
+        if (!dsort_merge_runs(sorter,
+                              darray_len(sorter->run_arr) - DSORT_FANIN)) {
+            dsort_reset(sorter);
+            return 0;
+        }
+    }
+
+    size_t runs = darray_len(sorter->run_arr);
+    size_t avail = sorter->budget > sorter->used ?
+        sorter->budget - sorter->used : 0;
+    struct dsort_merge merge = {
+        .sorter = sorter,
+        .first = 0,
+        .memory = 1,
+        .fp = fp,
+        .ctx = ctx,
+        .threaded = runs > 0
+    };
+    if (!merge_open(&merge, io_size(avail, runs))) {
+        dsort_reset(sorter);
+        return 0;
+    }
+
+    pthread_t thread;
+    if (merge.threaded) {
+        merge.batch_arr[0] = malloc(sizeof(void *) * BATCH_LEN * 2);
+        merge.batch_arr[1] = merge.batch_arr[0] + BATCH_LEN;
+        pthread_mutex_init(&merge.lock, NULL);
+        pthread_cond_init(&merge.cond, NULL);
+        // Without a background thread, the merge hands items over directly.
+        if (merge.batch_arr[0] == NULL ||
+                pthread_create(&thread, NULL, merge_run, &merge) != 0) {
+            merge.threaded = 0;
+        }
+    }
+    if (merge.threaded) {
+        merge_consume(&merge);
+        pthread_join(thread, NULL);
+    } else {
+        merge_produce(&merge);
+    }
+    if (runs > 0) {
+        pthread_cond_destroy(&merge.cond);
+        pthread_mutex_destroy(&merge.lock);
+        free(merge.batch_arr[0]);
+    }
+    merge_close(&merge);
+
+    // The merged items belong to the function now, and the items that are left
+    // after a failure are freed.
+    for (size_t i = merge.next; i < darray_len(buffer); i++) {
+        if (sorter->item_free != NULL) {
+            sorter->item_free(darray_get(buffer, i));
+        }
+    }
+    darray_set_item_free(buffer, NULL);
+    darray_clear(buffer);
+    darray_set_item_free(buffer, sorter->item_free);
+    darray_clear(sorter->run_arr);
+    sorter->used = 0;
+    sorter->len = 0;
+
+    if (merge.failed) {
+        darray_errno = DARRAY_EIO;
+        return 0;
+    }
+
+    return 1;
+}
+
+//! Represents the destination of the items collected from a sorter.
+struct collector {
+    /*! Points to the array to append the items to. */
+    darray *array;
+    /*! Points to a function that frees an item that cannot be appended. */
+    consumer item_free;
+    /*! Non-zero if an item cannot be appended. */
+    int failed;
+};
+
+//! Appends an item to the array of a collector.
+static void collect_item(void *item_ptr, void *collector_ptr) {
+    struct collector *collector = collector_ptr;
+    if (collector->failed || !darray_append(collector->array, item_ptr)) {
+        collector->failed = 1;
+        if (collector->item_free != NULL) {
+            collector->item_free(item_ptr);
+        }
+    }
+}
+
+darray *dsort_collect(dsort *sorter) {
+    if (sorter == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+
+    struct collector collector = {
+        .array = new_darray(sorter->item_free),
+        .item_free = sorter->item_free,
+        .failed = 0
+    };
+    if (collector.array == NULL) {
+        return NULL;
+    }
+    if (!dsort_drain_r(sorter, collect_item, &collector) || collector.failed) {
+        del_darray(collector.array);
+        return NULL;
+    }
+
+    return collector.array;
+}
+
+int del_dsort(dsort *sorter) {
+    if (sorter == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+
+    del_darray(sorter->buffer);
+    del_darray(sorter->run_arr);
+    free(sorter);
+
+    return 1;
+}
@@ -0,0 +1,169 @@
+/*!
+\file dsort.h
+\author Edward Ji
+\date 19 Oct 2026
+\brief The header file of external merge sort for items that exceed memory.
+*/
+
+#ifndef DSORT_H
+#define DSORT_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "darray.h"
+
+//! The serializer function pointer type definition.
+/*!
+A function of this type should take in a pointer to some object and write it to
+a given stream, such that a matching deserializer can read it back. It should
+not modify the object.
+
+\param item_ptr A pointer to some object.
+\param stream A stream opened for writing.
+\returns 1 if successful, 0 otherwise.
+
+\see Typically used with `new_dsort`.
+
+An example of a serializer function pointer is a function that writes an
+integer in binary:
+```
+int write_int(const void *p, FILE *stream) {
+    return fwrite(p, sizeof(int), 1, stream) == 1;
+}
+```
+*/
+typedef int (*serializer)(const void *item_ptr, FILE *stream);
+
+//! The deserializer function pointer type definition.
+/*!
+A function of this type should read an object written by a matching serializer
+from a given stream and return a pointer to a new object.
+
+\param stream A stream opened for reading.
+\returns A pointer to a new object, or `NULL` if unsuccessful.
+
+\see Typically used with `new_dsort`.
+
+An example of a deserializer function pointer is a function that reads an
+integer in binary:
+```
+void *read_int(FILE *stream) {
+    int *p = malloc(sizeof(int));
+    if (p != NULL && fread(p, sizeof(int), 1, stream) != 1) {
+        free(p);
+        p = NULL;
+    }
+    return p;
+}
+```
+*/
+typedef void *(*deserializer)(FILE *stream);
+
+//! Represents an external sorter.
+/*!
+An external sorter keeps pushed items in a dynamic array until they reach a
+memory budget. It then sorts them and spills them as a run to a temporary file.
+Whenever `DSORT_FANIN` runs, 16 by default, have been merged the same number of
+times, they are merged into one, so the number of open run files grows with the
+logarithm of the number of spills. Draining the sorter merges the remaining runs
+with a heap of their smallest items. The final merge is done by a background
+thread that reads ahead while the caller consumes the sorted items.
+*/
+typedef struct dsort dsort;
+
+//! Creates a new external sorter.
+/*!
+Run files are read and written through I/O buffers of up to `DSORT_IO_BUFFER`
+bytes, 1 MiB by default, so that runs are accessed in large sequential blocks.
+The buffers are only allocated while runs are written or merged, and count
+against the budget: they share the bytes not taken by items, but are never
+smaller than 4 KiB, so very small budgets are exceeded by the buffers.
+
+\param budget The number of bytes of items and I/O buffers to keep in memory.
+\param fp A pointer to a function that compares two items.
+\param size A pointer to a function that returns the size of an item in bytes,
+or `NULL` to only count the item pointers against the budget.
+\param write A pointer to a function that writes an item to a run file.
+\param read A pointer to a function that reads an item from a run file.
+\param item_free A pointer to a function that frees an item, or `NULL`.
+\returns A new external sorter, or `NULL` if unsuccessful.
+\see To deallocate the sorter, use `del_dsort`.
+
+\note Runs are sorted with `darray_partial_sort`, which never takes more than
+O(n log n) time even if the items are pushed in order.
+*/
+dsort *new_dsort(size_t budget, comparator fp, sizer size,
+                 serializer write, deserializer read, consumer item_free);
+
+//! Getter for the number of items pushed to the sorter.
+/*!
+\param sorter A pointer to an external sorter.
+\returns The number of items pushed and not yet drained, or 0 if the argument is
+`NULL`.
+\note This function does not set `darray_errno` even if the argument is `NULL`.
+*/
+size_t dsort_len(dsort *sorter);
+
+//! Getter for the number of runs spilled to temporary files.
+/*!
+\param sorter A pointer to an external sorter.
+\returns The number of runs, or 0 if the argument is `NULL`.
+\note This function does not set `darray_errno` even if the argument is `NULL`.
+*/
+size_t dsort_runs(dsort *sorter);
+
+//! Pushes an item to the sorter.
+/*!
+The sorter takes ownership of the item. If the item does not fit in the memory
+budget, the items in memory are sorted, written to a new run file and freed
+first.
+
+\param sorter A pointer to an external sorter.
+\param item_ptr A pointer to an item.
+\returns 1 if successful, 0 otherwise.
+*/
+int dsort_push(dsort *sorter, void *item_ptr);
+
+//! Calls each pushed item in sorted order with a given function.
+/*!
+The function receives ownership of each item and is responsible for freeing it.
+Afterwards, the sorter is empty and can be reused.
+
+\param sorter A pointer to an external sorter.
+\param fp A pointer to a function that takes an item.
+\param ctx A pointer to the context passed to the function.
+\returns 1 if successful, 0 otherwise.
+
+An example of writing sorted records to a file:
+```
+void print_record(void *p, void *ctx) {
+    fprintf(ctx, "%s\n", ((record *) p)->line);
+    free(p);
+}
+
+dsort_drain_r(sorter, print_record, out);
+```
+*/
+int dsort_drain_r(dsort *sorter, consumer_r fp, void *ctx);
+
+//! Returns a dynamic array of the pushed items in sorted order.
+/*!
+Afterwards, the sorter is empty and can be reused.
+
+\param sorter A pointer to an external sorter.
+\returns A new allocated dynamic array that owns the items with the free
+function of the sorter, or `NULL` if unsuccessful.
+*/
+darray *dsort_collect(dsort *sorter);
+
+//! Deallocates a given external sorter.
+/*!
+The items that are not drained are freed, and the run files are removed.
+
+\param sorter A pointer to an external sorter to deallocate.
+\returns 1 if successful, 0 otherwise.
+*/
+int del_dsort(dsort *sorter);
+
+#endif
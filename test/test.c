@@ -1,6 +1,10 @@
 #include <stdlib.h>
 
 #include "../darray.h"
+#include "../dmatrix.h"
+#include "../dseg.h"
+#include "../dsort.h"
+#include "../util/dtyped.h"
 #include "minunit.h"
 
 #define DARRAY_ASSERT_MATCH(arr, ...) do { \
@@ -21,8 +25,31 @@
     } \
 } while (0)
 
+#define DMATRIX_ASSERT_MATCH(mat, n_rows, n_cols, ...) do { \
+    const int mat##_[] = {__VA_ARGS__}; \
+    mu_assert_int_eq(n_rows, dmatrix_rows(mat)); \
+    mu_assert_int_eq(n_cols, dmatrix_cols(mat)); \
+    for (size_t i = 0; i < n_rows; i++) { \
+        for (size_t j = 0; j < n_cols; j++) { \
+            int *intp = dmatrix_get(mat, i, j); \
+            mu_assert_int_eq(mat##_[i * n_cols + j], *intp); \
+        } \
+    } \
+} while (0)
+
 static darray *arr = NULL;
 
+static dmatrix *mat = NULL;
+
+static dseg *seg = NULL;
+static dsort *sorter = NULL;
+
+static int_array *ints = NULL;
+
+#define PERSON_FIELDS(X) X(ulong, id) X(string, name) X(uchar, score)
+
+MAKE_DTYPE_TABLE(person, PERSON_FIELDS)
+
 static long long sum = 0;
 
 int *new_int(int x) {
@@ -53,6 +80,20 @@ void add_int_static(void *intp) {
 
 void *int_cpy(const void *p) { return (void *) p; }
 
+int int_cmp_desc(const void *p1, const void *p2) {
+    return int_cmp(p2, p1);
+}
+
+uint64_t int_key(const void *p) {
+    return (uint64_t) *((const int *) p) ^ (UINT64_C(1) << 63);
+}
+
+uint64_t int_half_key(const void *p) {
+    return (uint64_t) (*((const int *) p) / 2);
+}
+
+size_t int_hash(const void *p) { return (size_t) *((const int *) p); }
+
 void *int_cpy_deep(const void *p) {
     int *cpy = malloc(sizeof(int));
     *cpy = *((int *) p);
@@ -143,10 +184,70 @@ MU_TEST(test_darray_setup) {
     }
 }
 
+MU_TEST(test_new_darray_from) {
+    void **item_ptr_arr = malloc(sizeof(void *) * 3);
+    for (int i = 0; i < 3; i++) {
+        item_ptr_arr[i] = new_int(i);
+    }
+    darray *arr2 = new_darray_from(free, item_ptr_arr, 3);
+    mu_assert_int_eq(3, darray_capacity(arr2));
+    mu_assert_int_eq(1, darray_append(arr2, new_int(3)));
+    DARRAY_ASSERT_MATCH(arr2, 0, 1, 2, 3);
+    del_darray(arr2);
+
+    mu_check(new_darray_from(free, NULL, 0) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
 MU_TEST(test_darray_len) {
     mu_assert_int_eq(5, darray_len(arr));
 }
 
+size_t int_size(const void *p) { return sizeof(int); }
+
+MU_TEST(test_darray_capacity) {
+    mu_assert_int_eq(8, darray_capacity(arr));
+    mu_assert_int_eq(0, darray_capacity(NULL));
+}
+
+MU_TEST(test_darray_memory_usage) {
+    size_t usage = sizeof_darray + 8 * sizeof(void *);
+    mu_assert_int_eq(usage, darray_memory_usage(arr, NULL));
+    mu_assert_int_eq(usage + 5 * sizeof(int), darray_memory_usage(arr, int_size));
+}
+
+MU_TEST(test_darray_memory_usage_e) {
+    mu_assert_int_eq(0, darray_memory_usage(NULL, int_size));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST(test_darray_registry_top) {
+    darray *arr2 = new_darray(NULL);
+    darray_registry_row top[2];
+    DARRAY_APPEND_INTS(arr2, 0, 1, 2, 3, 4, 5, 6, 7, 8);
+    darray_set_item_free(arr2, free);
+#ifdef DARRAY_REGISTRY
+    mu_assert_int_eq(2, darray_registry_top(top, 2));
+    mu_check(top[0].id == arr2);
+    mu_assert_int_eq(9, top[0].len);
+    mu_assert_int_eq(16, top[0].cap);
+    mu_assert_int_eq(7 * sizeof(void *), top[0].wasted);
+    mu_check(top[1].id == arr);
+#else
+    mu_assert_int_eq(0, darray_registry_top(top, 2));
+#endif
+    mu_assert_int_eq(0, darray_registry_top(top, 0));
+    del_darray(arr2);
+}
+
+MU_TEST(test_darray_registry_e) {
+    mu_assert_int_eq(0, darray_registry_top(NULL, 1));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_registry_dump(NULL, 1));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
 MU_TEST(test_darray_foreach) {
     add_int_static(NULL);
     mu_assert_int_eq(1, darray_foreach(arr, add_int_static));
@@ -411,6 +512,141 @@ MU_TEST(test_darray_reverse_e) {
     mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
 }
 
+int int_is_even(const void *p) { return *((const int *) p) % 2 == 0; }
+
+MU_TEST(test_darray_remove_if) {
+    mu_assert_int_eq(1, darray_remove_if(arr, int_is_even));
+    DARRAY_ASSERT_MATCH(arr, 1, 3);
+    mu_assert_int_eq(4, darray_capacity(arr));
+    mu_assert_int_eq(1, darray_remove_if(arr, int_is_even));
+    DARRAY_ASSERT_MATCH(arr, 1, 3);
+}
+
+MU_TEST(test_darray_remove_if_index) {
+    darray_index *index = new_darray_index(arr, int_cpy, int_hash, int_cmp);
+    int val = 3;
+    size_t i = -1;
+    mu_assert_int_eq(1, darray_remove_if(arr, int_is_even));
+    mu_assert_int_eq(1, darray_index_search(index, &val, &i));
+    mu_assert_int_eq(1, i);
+}
+
+MU_TEST(test_darray_remove_if_e) {
+    mu_assert_int_eq(0, darray_remove_if(NULL, int_is_even));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_remove_if(arr, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST(test_darray_partition) {
+    size_t index = -1;
+    mu_assert_int_eq(1, darray_partition(arr, int_is_even, &index));
+    mu_assert_int_eq(3, index);
+    for (size_t i = 0; i < darray_len(arr); i++) {
+        mu_check(int_is_even(darray_get(arr, i)) == (i < index));
+    }
+    darray_sort(arr, int_cmp);
+    DARRAY_ASSERT_MATCH(arr, 0, 1, 2, 3, 4);
+}
+
+MU_TEST(test_darray_partition_e) {
+    size_t index;
+    mu_assert_int_eq(0, darray_partition(NULL, int_is_even, &index));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_partition(arr, int_is_even, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+void add_int_ctx(void *intp, void *ctx) { *((int *) ctx) += *((int *) intp); }
+
+void add_int_scaled(const void *intp, void *resp, void *ctx) {
+    *((long long *) resp) += *((const int *) intp) * *((int *) ctx);
+}
+
+int int_cmp_dir(const void *p1, const void *p2, void *ctx) {
+    return int_cmp(p1, p2) * *((int *) ctx);
+}
+
+int int_eq_ctx(const void *p, void *ctx) {
+    return *((const int *) p) == *((int *) ctx);
+}
+
+int int_lt_ctx(const void *p, void *ctx) {
+    return *((const int *) p) < *((int *) ctx);
+}
+
+void *int_add_ctx(const void *p, void *ctx) {
+    return new_int(*((const int *) p) + *((int *) ctx));
+}
+
+MU_TEST(test_darray_foreach_r) {
+    int sum = 0;
+    mu_assert_int_eq(1, darray_foreach_r(arr, add_int_ctx, &sum));
+    mu_assert_int_eq(0 + 1 + 2 + 3 + 4, sum);
+}
+
+MU_TEST(test_darray_aggregate_r) {
+    long long res = 0;
+    int scale = 3;
+    mu_assert_int_eq(1, darray_aggregate_r(arr, &res, add_int_scaled, &scale));
+    mu_check(res == (0 + 1 + 2 + 3 + 4) * 3);
+}
+
+MU_TEST(test_darray_search_r) {
+    int val = 3;
+    size_t idx = -1;
+    mu_assert_int_eq(1, darray_search_r(arr, int_eq_ctx, &val, &idx));
+    mu_assert_int_eq(3, idx);
+    val = 5;
+    mu_assert_int_eq(0, darray_search_r(arr, int_eq_ctx, &val, &idx));
+    mu_assert_int_eq(DARRAY_ENOTIN, darray_geterr());
+}
+
+MU_TEST(test_darray_remove_if_r) {
+    int val = 2;
+    mu_assert_int_eq(1, darray_remove_if_r(arr, int_lt_ctx, &val));
+    DARRAY_ASSERT_MATCH(arr, 2, 3, 4);
+}
+
+MU_TEST(test_darray_sort_r) {
+    int dir = -1;
+    mu_assert_int_eq(1, darray_sort_r(arr, int_cmp_dir, &dir));
+    DARRAY_ASSERT_MATCH(arr, 4, 3, 2, 1, 0);
+    dir = 1;
+    mu_assert_int_eq(1, darray_sort_r(arr, int_cmp_dir, &dir));
+    DARRAY_ASSERT_MATCH(arr, 0, 1, 2, 3, 4);
+}
+
+MU_TEST(test_darray_clone_r) {
+    int val = 10;
+    darray *clone = darray_clone_r(arr, int_add_ctx, &val);
+    DARRAY_ASSERT_MATCH(clone, 10, 11, 12, 13, 14);
+    del_darray(clone);
+}
+
+MU_TEST(test_darray_r_e) {
+    size_t idx;
+    mu_assert_int_eq(0, darray_foreach_r(NULL, add_int_ctx, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_aggregate_r(arr, NULL, add_int_scaled, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_search_r(arr, NULL, NULL, &idx));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_remove_if_r(arr, NULL, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_sort_r(NULL, int_cmp_dir, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_check(darray_clone_r(arr, NULL, NULL) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
 MU_TEST(test_darray_unique_1) {
     darray *arr2 = new_darray(free);
     DARRAY_APPEND_INTS(arr2, 0, 0, 0, 1);
@@ -459,6 +695,338 @@ MU_TEST(test_darray_sort_e) {
     mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
 }
 
+MU_TEST(test_darray_sort_by_key_1) {
+    darray *arr2 = new_darray(free);
+    DARRAY_APPEND_INTS(arr2, 3, -1, 70000, 0, -70000, 2, 1);
+    mu_assert_int_eq(1, darray_sort_by_key(arr2, int_key));
+    DARRAY_ASSERT_MATCH(arr2, -70000, -1, 0, 1, 2, 3, 70000);
+    del_darray(arr2);
+}
+
+MU_TEST(test_darray_sort_by_key_2) {
+    darray *arr2 = new_darray(free);
+    DARRAY_APPEND_INTS(arr2, 5, 1, 4, 0, 3, 2);
+    mu_assert_int_eq(1, darray_sort_by_key(arr2, int_half_key));
+    DARRAY_ASSERT_MATCH(arr2, 1, 0, 3, 2, 5, 4);
+    del_darray(arr2);
+}
+
+MU_TEST(test_darray_sort_by_key_e) {
+    mu_assert_int_eq(0, darray_sort_by_key(NULL, int_key));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_sort_by_key(arr, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+uint64_t zero_key(const void *p) { return 0; }
+
+MU_TEST(test_darray_sort_cached_1) {
+    darray *arr2 = new_darray(free);
+    DARRAY_APPEND_INTS(arr2, 5, 1, 4, 0, 3, 2);
+    mu_assert_int_eq(1, darray_sort_cached(arr2, int_half_key, int_cmp));
+    DARRAY_ASSERT_MATCH(arr2, 0, 1, 2, 3, 4, 5);
+    del_darray(arr2);
+}
+
+MU_TEST(test_darray_sort_cached_2) {
+    darray *arr2 = new_darray(free);
+    DARRAY_APPEND_INTS(arr2, 9, 3, 7, 1, 8, 2, 6, 4, 0, 5,
+                             19, 13, 17, 11, 18, 12, 16, 14, 10, 15);
+    mu_assert_int_eq(1, darray_sort_cached(arr2, zero_key, int_cmp));
+    DARRAY_ASSERT_MATCH(arr2, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+                              10, 11, 12, 13, 14, 15, 16, 17, 18, 19);
+    del_darray(arr2);
+}
+
+MU_TEST(test_darray_sort_cached_e) {
+    mu_assert_int_eq(0, darray_sort_cached(NULL, int_key, int_cmp));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_sort_cached(arr, NULL, int_cmp));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_sort_cached(arr, int_key, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST(test_darray_nth_element_1) {
+    mu_assert_int_eq(1, darray_reverse(arr));
+    mu_assert_int_eq(1, darray_nth_element(arr, 1, int_cmp));
+    mu_assert_int_eq(1, *((int *) darray_get(arr, 1)));
+}
+
+MU_TEST(test_darray_nth_element_2) {
+    darray *arr2 = new_darray(free);
+    srand(42);
+    for (int i = 0; i < 1000; i++) {
+        darray_append(arr2, new_int(rand() % 50));
+    }
+    for (size_t n = 0; n < 1000; n += 111) {
+        mu_assert_int_eq(1, darray_nth_element(arr2, n, int_cmp));
+        int *nth = darray_get(arr2, n);
+        for (size_t i = 0; i < 1000; i++) {
+            int c = int_cmp(darray_get(arr2, i), nth);
+            mu_check(i < n ? c <= 0 : c >= 0);
+        }
+    }
+    del_darray(arr2);
+}
+
+MU_TEST(test_darray_nth_element_e) {
+    mu_assert_int_eq(0, darray_nth_element(NULL, 0, int_cmp));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_nth_element(arr, 5, int_cmp));
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+}
+
+MU_TEST(test_darray_partial_sort) {
+    darray *arr2 = new_darray(free);
+    DARRAY_APPEND_INTS(arr2, 5, 3, 9, 1, 3, 7, 0, 8, 2, 6, 4,
+                             19, 13, 11, 17, 12, 10, 15, 14, 16, 18);
+    mu_assert_int_eq(1, darray_partial_sort(arr2, 4, int_cmp));
+    for (int i = 0; i < 4; i++) {
+        mu_assert_int_eq(i, *((int *) darray_get(arr2, i)));
+    }
+    mu_assert_int_eq(21, darray_len(arr2));
+    mu_assert_int_eq(1, darray_partial_sort(arr2, 21, int_cmp));
+    DARRAY_ASSERT_MATCH(arr2, 0, 1, 2, 3, 3, 4, 5, 6, 7, 8, 9,
+                              10, 11, 12, 13, 14, 15, 16, 17, 18, 19);
+    del_darray(arr2);
+}
+
+MU_TEST(test_darray_partial_sort_e) {
+    mu_assert_int_eq(0, darray_partial_sort(arr, 1, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_partial_sort(arr, 6, int_cmp));
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+}
+
+MU_TEST(test_darray_top_k_1) {
+    darray *arr2 = darray_top_k(arr, 3, int_cmp_desc);
+    DARRAY_ASSERT_MATCH(arr2, 4, 3, 2);
+    DARRAY_ASSERT_MATCH(arr, 0, 1, 2, 3, 4);
+    del_darray(arr2);
+}
+
+MU_TEST(test_darray_top_k_2) {
+    darray *arr2 = darray_top_k(arr, 10, int_cmp_desc);
+    DARRAY_ASSERT_MATCH(arr2, 4, 3, 2, 1, 0);
+    del_darray(arr2);
+    arr2 = darray_top_k(arr, 0, int_cmp_desc);
+    DARRAY_ASSERT_MATCH(arr2);
+    del_darray(arr2);
+}
+
+MU_TEST(test_darray_top_k_e) {
+    mu_check(darray_top_k(NULL, 1, int_cmp) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_check(darray_top_k(arr, 1, NULL) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+typedef struct {
+    int priority;
+    size_t pos;
+} task;
+
+int task_cmp(const void *p1, const void *p2) {
+    return ((task *) p1)->priority - ((task *) p2)->priority;
+}
+
+void task_track(void *p, size_t index) {
+    ((task *) p)->pos = index;
+}
+
+MU_TEST(test_darray_heapify) {
+    darray_reverse(arr);
+    darray_append(arr, new_int(7));
+    darray_append(arr, new_int(5));
+    mu_assert_int_eq(1, darray_heapify(arr, int_cmp, NULL));
+    mu_assert_int_eq(7, *(int *) darray_get(arr, 0));
+    for (size_t i = 1; i < darray_len(arr); i++) {
+        mu_check(int_cmp(darray_get(arr, (i - 1) / 2), darray_get(arr, i)) >= 0);
+    }
+}
+
+MU_TEST(test_darray_heap_push_pop) {
+    darray *heap = new_darray(free);
+    int ints[] = {3, 9, 1, 4, 1, 5, 9, 2, 6};
+    for (size_t i = 0; i < sizeof(ints) / sizeof(int); i++) {
+        mu_assert_int_eq(1, darray_heap_push(heap, new_int(ints[i]), int_cmp_desc, NULL));
+    }
+    int expected[] = {1, 1, 2, 3, 4, 5, 6, 9, 9};
+    for (size_t i = 0; i < sizeof(expected) / sizeof(int); i++) {
+        mu_assert_int_eq(expected[i], *(int *) darray_get(heap, 0));
+        mu_assert_int_eq(1, darray_heap_pop(heap, int_cmp_desc, NULL));
+    }
+    mu_assert_int_eq(0, darray_len(heap));
+    del_darray(heap);
+}
+
+MU_TEST(test_darray_heap_update) {
+    task tasks[8];
+    darray *heap = new_darray(NULL);
+    for (int i = 0; i < 8; i++) {
+        tasks[i].priority = i * 10;
+        darray_append(heap, tasks + i);
+    }
+    mu_assert_int_eq(1, darray_heapify(heap, task_cmp, task_track));
+    for (int i = 0; i < 8; i++) {
+        mu_check(darray_get(heap, tasks[i].pos) == tasks + i);
+    }
+
+    tasks[2].priority = 100;
+    mu_assert_int_eq(1, darray_heap_update(heap, tasks[2].pos, task_cmp, task_track));
+    mu_check(darray_get(heap, 0) == tasks + 2);
+    mu_assert_int_eq(0, tasks[2].pos);
+
+    tasks[2].priority = -1;
+    mu_assert_int_eq(1, darray_heap_update(heap, tasks[2].pos, task_cmp, task_track));
+    mu_check(darray_get(heap, 0) == tasks + 7);
+    mu_assert_int_eq(0, tasks[7].pos);
+
+    int prev = 100;
+    while (darray_len(heap) > 0) {
+        for (int i = 0; i < 8; i++) {
+            if (tasks[i].pos < darray_len(heap)) {
+                mu_check(darray_get(heap, tasks[i].pos) == tasks + i);
+            }
+        }
+        task *top = darray_get(heap, 0);
+        mu_check(top->priority <= prev);
+        prev = top->priority;
+        top->pos = SIZE_MAX;
+        mu_assert_int_eq(1, darray_heap_pop(heap, task_cmp, task_track));
+    }
+    mu_assert_int_eq(-1, prev);
+    del_darray(heap);
+}
+
+MU_TEST(test_darray_heap_e) {
+    mu_assert_int_eq(0, darray_heapify(NULL, int_cmp, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+    mu_assert_int_eq(0, darray_heapify(arr, NULL, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_heap_push(arr, NULL, int_cmp, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_heap_update(arr, 5, int_cmp, NULL));
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+
+    darray *heap = new_darray(NULL);
+    mu_assert_int_eq(0, darray_heap_pop(heap, int_cmp, NULL));
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+    del_darray(heap);
+}
+
+MU_TEST(test_darray_merge_1) {
+    darray *arr2 = new_darray(free);
+    DARRAY_APPEND_INTS(arr2, -1, 2, 2, 7);
+    mu_assert_int_eq(1, darray_merge(arr, arr2, int_cmp));
+    darray_set_item_free(arr2, NULL);
+    del_darray(arr2);
+    DARRAY_ASSERT_MATCH(arr, -1, 0, 1, 2, 2, 2, 3, 4, 7);
+}
+
+MU_TEST(test_darray_merge_2) {
+    darray *arr2 = new_darray(free);
+    for (int i = 0; i < 100; i++) {
+        darray_append(arr2, new_int(i < 50 ? i - 50 : i + 50));
+    }
+    darray_append(arr, new_int(5));
+    mu_assert_int_eq(1, darray_merge(arr2, arr, int_cmp));
+    darray_set_item_free(arr, NULL);
+    mu_assert_int_eq(106, darray_len(arr2));
+    for (size_t i = 1; i < darray_len(arr2); i++) {
+        mu_check(int_cmp(darray_get(arr2, i - 1), darray_get(arr2, i)) <= 0);
+    }
+    mu_assert_int_eq(-1, *(int *) darray_get(arr2, 49));
+    mu_assert_int_eq(0, *(int *) darray_get(arr2, 50));
+    mu_assert_int_eq(5, *(int *) darray_get(arr2, 55));
+    mu_assert_int_eq(100, *(int *) darray_get(arr2, 56));
+    del_darray(arr2);
+}
+
+MU_TEST(test_darray_merge_self) {
+    mu_assert_int_eq(1, darray_merge(arr, arr, int_cmp));
+    mu_assert_int_eq(10, darray_len(arr));
+    for (size_t i = 0; i < 10; i++) {
+        mu_assert_int_eq(i / 2, *(int *) darray_get(arr, i));
+    }
+    mu_check(darray_get(arr, 0) == darray_get(arr, 1));
+    for (size_t i = 0; i < 10; i += 2) {
+        free(darray_get(arr, i));
+    }
+    darray_set_item_free(arr, NULL);
+}
+
+MU_TEST(test_darray_set_ops) {
+    darray *arr2 = new_darray(free);
+    DARRAY_APPEND_INTS(arr2, 1, 1, 3, 5, 6);
+    darray_append(arr, new_int(4));
+
+    darray *result = darray_set_union(arr, arr2, int_cmp);
+    DARRAY_ASSERT_MATCH(result, 0, 1, 1, 2, 3, 4, 4, 5, 6);
+    mu_check(darray_get(result, 0) == darray_get(arr, 0));
+    mu_check(darray_get(result, 1) == darray_get(arr, 1));
+    mu_check(darray_get(result, 2) == darray_get(arr2, 1));
+    del_darray(result);
+
+    result = darray_set_intersection(arr, arr2, int_cmp);
+    DARRAY_ASSERT_MATCH(result, 1, 3);
+    mu_check(darray_get(result, 1) == darray_get(arr, 3));
+    del_darray(result);
+
+    result = darray_set_difference(arr, arr2, int_cmp);
+    DARRAY_ASSERT_MATCH(result, 0, 2, 4, 4);
+    del_darray(result);
+
+    result = darray_set_difference(arr2, arr, int_cmp);
+    DARRAY_ASSERT_MATCH(result, 1, 5, 6);
+    del_darray(result);
+
+    del_darray(arr2);
+}
+
+MU_TEST(test_darray_set_ops_gallop) {
+    darray *arr2 = new_darray(free);
+    for (int i = 0; i < 1000; i++) {
+        darray_append(arr2, new_int(i * 2));
+    }
+    darray *result = darray_set_intersection(arr, arr2, int_cmp);
+    DARRAY_ASSERT_MATCH(result, 0, 2, 4);
+    del_darray(result);
+    result = darray_set_union(arr2, arr, int_cmp);
+    mu_assert_int_eq(1002, darray_len(result));
+    mu_assert_int_eq(3, *(int *) darray_get(result, 3));
+    mu_assert_int_eq(1998, *(int *) darray_get(result, 1001));
+    del_darray(result);
+    result = darray_set_difference(arr2, arr, int_cmp);
+    mu_assert_int_eq(997, darray_len(result));
+    mu_assert_int_eq(6, *(int *) darray_get(result, 0));
+    del_darray(result);
+    del_darray(arr2);
+}
+
+MU_TEST(test_darray_set_ops_e) {
+    mu_assert_int_eq(0, darray_merge(NULL, arr, int_cmp));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+    mu_assert_int_eq(0, darray_merge(arr, arr, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_check(darray_set_union(arr, NULL, int_cmp) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+    mu_check(darray_set_intersection(NULL, arr, int_cmp) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+    mu_check(darray_set_difference(arr, arr, NULL) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
 MU_TEST(test_darray_clone_1) {
     darray *arr2 = darray_clone(arr, int_cpy);
     darray_set_item_free(arr2, NULL);
@@ -480,27 +1048,709 @@ MU_TEST(test_darray_clone_e) {
     mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
 }
 
-MU_TEST(test_darray_clear) {
-    darray_clear(arr);
-    DARRAY_ASSERT_MATCH(arr);
+MU_TEST(test_darray_clone_cow) {
+    darray *clone = darray_clone_cow(arr, int_cpy_deep);
+    mu_check(darray_get(clone, 2) == darray_get(arr, 2));
+    mu_assert_int_eq(1, darray_pop(clone, 0));
+    DARRAY_ASSERT_MATCH(clone, 1, 2, 3, 4);
+    DARRAY_ASSERT_MATCH(arr, 0, 1, 2, 3, 4);
+    mu_check(darray_get(clone, 1) != darray_get(arr, 2));
+    del_darray(clone);
 }
 
-MU_TEST(test_darray_clear_e) {
-    mu_assert_int_eq(0, darray_clear(NULL));
+MU_TEST(test_darray_clone_cow_source) {
+    darray *clone1 = darray_clone_cow(arr, int_cpy_deep);
+    darray *clone2 = darray_clone_cow(arr, int_cpy_deep);
+    mu_assert_int_eq(1, darray_sort(arr, int_cmp_desc));
+    DARRAY_ASSERT_MATCH(arr, 4, 3, 2, 1, 0);
+    DARRAY_ASSERT_MATCH(clone1, 0, 1, 2, 3, 4);
+    mu_check(darray_get(clone1, 0) == darray_get(clone2, 0));
+    mu_assert_int_eq(1, darray_clear(clone1));
+    DARRAY_ASSERT_MATCH(clone2, 0, 1, 2, 3, 4);
+    DARRAY_APPEND_INTS(clone1, 5);
+    DARRAY_ASSERT_MATCH(clone1, 5);
+    del_darray(clone1);
+    mu_assert_int_eq(1, darray_append(clone2, new_int(5)));
+    DARRAY_ASSERT_MATCH(clone2, 0, 1, 2, 3, 4, 5);
+    del_darray(clone2);
+}
+
+MU_TEST(test_darray_clone_cow_snapshot) {
+    darray *snapshot = darray_clone_cow(arr, int_cpy);
+    darray_set_item_free(snapshot, NULL);
+    DARRAY_ASSERT_MATCH(snapshot, 0, 1, 2, 3, 4);
+    del_darray(snapshot);
+
+    darray *clone = darray_clone_cow(arr, int_cpy_deep);
+    del_darray(arr);
+    DARRAY_ASSERT_MATCH(clone, 0, 1, 2, 3, 4);
+    arr = clone;
+}
+
+MU_TEST(test_darray_clone_cow_unique) {
+    darray *source = new_darray(free);
+    DARRAY_APPEND_INTS(source, 1, 1, 2, 2, 3, 3, 4);
+    darray *clone = darray_clone_cow(source, int_cpy_deep);
+    mu_assert_int_eq(1, darray_unique(clone, int_cmp));
+    DARRAY_ASSERT_MATCH(clone, 1, 2, 3, 4);
+    DARRAY_ASSERT_MATCH(source, 1, 1, 2, 2, 3, 3, 4);
+    del_darray(clone);
+
+    clone = darray_clone_cow(source, int_cpy_deep);
+    mu_assert_int_eq(1, darray_remove_if(clone, int_is_even));
+    DARRAY_ASSERT_MATCH(clone, 1, 1, 3, 3);
+    DARRAY_ASSERT_MATCH(source, 1, 1, 2, 2, 3, 3, 4);
+    del_darray(clone);
+    del_darray(source);
+}
+
+MU_TEST(test_darray_clone_cow_e) {
+    mu_check(darray_clone_cow(NULL, int_cpy) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_check(darray_clone_cow(arr, NULL) == NULL);
     mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
 }
 
-MU_TEST_SUITE(darray_test_suite) {
-    MU_SUITE_CONFIGURE(&darray_test_setup, &darray_test_teardown);
+MU_TEST(test_darray_data) {
+    void **item_ptr_arr = darray_data(arr);
+    for (size_t i = 0; i < 5; i++) {
+        mu_check(item_ptr_arr[i] == darray_get(arr, i));
+    }
 
-    MU_RUN_TEST(test_darray_setup);
-    MU_RUN_TEST(test_darray_len);
-    MU_RUN_TEST(test_darray_foreach);
-    MU_RUN_TEST(test_darray_foreach_e);
-    MU_RUN_TEST(test_darray_aggregate);
-    MU_RUN_TEST(test_darray_aggregate_e);
-    MU_RUN_TEST(test_darray_pop_1);
-    MU_RUN_TEST(test_darray_pop_2);
+    darray *clone = darray_clone_cow(arr, int_cpy_deep);
+    item_ptr_arr = darray_data(clone);
+    mu_check(item_ptr_arr[0] != darray_get(arr, 0));
+    void *temp = item_ptr_arr[0];
+    item_ptr_arr[0] = item_ptr_arr[4];
+    item_ptr_arr[4] = temp;
+    DARRAY_ASSERT_MATCH(clone, 4, 1, 2, 3, 0);
+    DARRAY_ASSERT_MATCH(arr, 0, 1, 2, 3, 4);
+    del_darray(clone);
+
+    mu_check(darray_data(NULL) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST(test_darray_cdata) {
+    darray *clone = darray_clone_cow(arr, int_cpy_deep);
+    void *const *item_ptr_arr = darray_cdata(clone);
+    for (size_t i = 0; i < 5; i++) {
+        mu_check(item_ptr_arr[i] == darray_get(arr, i));
+    }
+    mu_check(darray_cdata(arr) == item_ptr_arr);
+    del_darray(clone);
+
+    mu_check(darray_cdata(NULL) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST(test_darray_map_threshold) {
+    mu_assert_int_eq(1, darray_set_map_threshold(4096));
+    for (int i = 5; i < 20000; i++) {
+        darray_append(arr, new_int(i));
+    }
+    darray *clone = darray_clone_cow(arr, int_cpy_deep);
+    mu_assert_int_eq(1, darray_pop_range(arr, 10, 20000));
+    DARRAY_ASSERT_MATCH(arr, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9);
+    for (int i = 0; i < 20000; i++) {
+        mu_assert_int_eq(i, *((int *) darray_get(clone, i)));
+    }
+    mu_assert_int_eq(1, darray_pop_range(clone, 1000, 20000));
+    mu_assert_int_eq(999, *((int *) darray_get(clone, 999)));
+    mu_assert_int_eq(1, del_darray_deferred(clone));
+    mu_assert_int_eq(1, darray_reclaim_wait());
+    darray_set_map_threshold((size_t) 4 << 20);
+}
+
+MU_TEST(test_darray_clear) {
+    darray_clear(arr);
+    DARRAY_ASSERT_MATCH(arr);
+}
+
+MU_TEST(test_darray_clear_e) {
+    mu_assert_int_eq(0, darray_clear(NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+size_t bulk_calls, bulk_items;
+
+void int_bulk_free(void **item_ptr_arr, size_t n) {
+    bulk_calls++;
+    bulk_items += n;
+    for (size_t i = 0; i < n; i++) {
+        free(item_ptr_arr[i]);
+    }
+}
+
+MU_TEST(test_darray_bulk_free) {
+    bulk_calls = bulk_items = 0;
+    mu_assert_int_eq(1, darray_set_bulk_free(arr, int_bulk_free));
+    mu_assert_int_eq(1, darray_pop_range(arr, 1, 3));
+    mu_assert_int_eq(1, darray_remove_if(arr, int_is_even));
+    DARRAY_ASSERT_MATCH(arr, 3);
+    mu_assert_int_eq(1, darray_clear(arr));
+    mu_assert_int_eq(3, bulk_calls);
+    mu_assert_int_eq(5, bulk_items);
+
+    DARRAY_APPEND_INTS(arr, 0);
+    darray_set_item_free(arr, NULL);
+    int *intp = darray_get(arr, 0);
+    mu_assert_int_eq(1, darray_pop(arr, 0));
+    mu_assert_int_eq(3, bulk_calls);
+    free(intp);
+}
+
+MU_TEST(test_darray_bulk_free_e) {
+    mu_assert_int_eq(0, darray_set_bulk_free(NULL, int_bulk_free));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST(test_del_darray_deferred) {
+    bulk_calls = bulk_items = 0;
+    darray *arr2 = new_darray(free);
+    for (int i = 0; i < 1000; i++) {
+        darray_append(arr2, new_int(i));
+    }
+    darray_set_bulk_free(arr2, int_bulk_free);
+    new_darray_index(arr2, int_cpy, int_hash, int_cmp);
+    mu_assert_int_eq(1, del_darray_deferred(arr2));
+    mu_assert_int_eq(1, darray_reclaim_wait());
+    mu_assert_int_eq(1, bulk_calls);
+    mu_assert_int_eq(1000, bulk_items);
+
+    arr2 = new_darray(NULL);
+    mu_assert_int_eq(1, del_darray_deferred(arr2));
+    mu_assert_int_eq(1, darray_reclaim_wait());
+}
+
+MU_TEST(test_del_darray_deferred_e) {
+    mu_assert_int_eq(0, del_darray_deferred(NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST(test_darray_stats) {
+    darray_stat stat;
+    mu_assert_int_eq(1, darray_pop(arr, 0));
+    mu_assert_int_eq(1, darray_sort(arr, int_cmp));
+    mu_assert_int_eq(1, darray_stats(arr, &stat));
+#ifdef DARRAY_STATS
+    mu_assert_int_eq(3, stat.resizes);
+    mu_assert_int_eq(4 * sizeof(void *), stat.bytes_moved);
+    mu_check(stat.cmp_calls > 0);
+    mu_assert_int_eq(1, stat.item_frees);
+    mu_assert_int_eq(8, stat.peak_cap);
+    mu_assert_int_eq(1, darray_stats(NULL, &stat));
+    mu_check(stat.resizes >= 3);
+#else
+    mu_assert_int_eq(0, stat.resizes);
+    mu_assert_int_eq(0, stat.bytes_moved);
+    mu_assert_int_eq(0, stat.cmp_calls);
+    mu_assert_int_eq(0, stat.item_frees);
+    mu_assert_int_eq(0, stat.peak_cap);
+#endif
+}
+
+MU_TEST(test_darray_stats_cmp) {
+    darray_stat stat;
+    int val = 2;
+    size_t idx;
+    mu_assert_int_eq(1, darray_search(arr, &val, int_cmp, &idx));
+    mu_assert_int_eq(1, darray_remove_if(arr, int_is_even));
+    mu_assert_int_eq(1, darray_stats(arr, &stat));
+#ifdef DARRAY_STATS
+    mu_assert_int_eq(3, stat.cmp_calls);
+    mu_assert_int_eq(0, stat.bytes_moved);
+#else
+    mu_assert_int_eq(0, stat.cmp_calls);
+#endif
+}
+
+MU_TEST(test_darray_stats_e) {
+    mu_assert_int_eq(0, darray_stats(arr, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST(test_darray_index_1) {
+    darray_index *index = new_darray_index(arr, int_cpy, int_hash, int_cmp);
+    mu_check(index != NULL);
+    for (int i = 0; i < 5; i++) {
+        size_t idx = -1;
+        mu_assert_int_eq(1, darray_index_search(index, &i, &idx));
+        mu_check((size_t) i == idx);
+    }
+}
+
+MU_TEST(test_darray_index_2) {
+    darray_index *index = new_darray_index(arr, int_cpy, int_hash, int_cmp);
+    int val = 42;
+    size_t idx = -1;
+    mu_assert_int_eq(0, darray_index_search(index, &val, &idx));
+    mu_assert_int_eq(DARRAY_ENOTIN, darray_geterr());
+    darray_append(arr, new_int(42));
+    mu_assert_int_eq(1, darray_index_search(index, &val, &idx));
+    mu_check(5 == idx);
+    mu_assert_int_eq(1, darray_pop(arr, 5));
+    mu_assert_int_eq(0, darray_index_search(index, &val, &idx));
+    mu_assert_int_eq(DARRAY_ENOTIN, darray_geterr());
+}
+
+MU_TEST(test_darray_index_3) {
+    darray_index *index = new_darray_index(arr, int_cpy, int_hash, int_cmp);
+    int val = 3;
+    size_t idx = -1;
+    mu_assert_int_eq(1, darray_index_search(index, &val, &idx));
+    mu_assert_int_eq(1, darray_pop(arr, 0));
+    mu_assert_int_eq(1, darray_index_search(index, &val, &idx));
+    mu_check(2 == idx);
+    mu_assert_int_eq(1, darray_insert(arr, 0, new_int(3)));
+    mu_assert_int_eq(1, darray_index_search(index, &val, &idx));
+    mu_check(0 == idx);
+    mu_assert_int_eq(1, darray_reverse(arr));
+    mu_assert_int_eq(1, darray_sort(arr, int_cmp));
+    mu_assert_int_eq(1, darray_index_search(index, &val, &idx));
+    mu_check(2 == idx);
+    mu_assert_int_eq(1, del_darray_index(index));
+}
+
+MU_TEST(test_darray_index_4) {
+    darray_index *index = new_darray_index(arr, int_cpy, int_hash, int_cmp);
+    int val = 2;
+    size_t idx = -1;
+    mu_assert_int_eq(1, darray_index_search(index, &val, &idx));
+    mu_assert_int_eq(1, darray_pop_range(arr, 2, 5));
+    mu_assert_int_eq(0, darray_index_search(index, &val, &idx));
+    mu_assert_int_eq(DARRAY_ENOTIN, darray_geterr());
+    for (int i = 0; i < 100; i++) {
+        darray_append(arr, new_int(i));
+    }
+    val = 99;
+    mu_assert_int_eq(1, darray_index_search(index, &val, &idx));
+    mu_check(101 == idx);
+    val = 1;
+    mu_assert_int_eq(1, darray_index_search(index, &val, &idx));
+    mu_check(1 == idx);
+}
+
+MU_TEST(test_darray_index_e) {
+    int val = 0;
+    size_t idx = -1;
+    mu_check(new_darray_index(NULL, int_cpy, int_hash, int_cmp) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_check(new_darray_index(arr, int_cpy, NULL, int_cmp) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_index_search(NULL, &val, &idx));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, del_darray_index(NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST(test_darray_view_1) {
+    darray_view *view = new_darray_view(arr, int_cmp_desc);
+    mu_check(view != NULL);
+    for (int i = 0; i < 5; i++) {
+        int *p = darray_view_get(view, i);
+        mu_assert_int_eq(4 - i, *p);
+    }
+    DARRAY_ASSERT_MATCH(arr, 0, 1, 2, 3, 4);
+}
+
+MU_TEST(test_darray_view_2) {
+    darray_view *view = new_darray_view(arr, int_cmp_desc);
+    mu_check(darray_view_get(view, 0) != NULL);
+    darray_append(arr, new_int(2));
+    darray_append(arr, new_int(9));
+    mu_assert_int_eq(9, *((int *) darray_view_get(view, 0)));
+    mu_assert_int_eq(2, *((int *) darray_view_get(view, 3)));
+    mu_check(darray_view_get(view, 3) == darray_get(arr, 2));
+    mu_check(darray_view_get(view, 4) == darray_get(arr, 5));
+    mu_assert_int_eq(1, darray_pop(arr, 6));
+    mu_assert_int_eq(4, *((int *) darray_view_get(view, 0)));
+    mu_assert_int_eq(1, darray_pop(arr, 0));
+    mu_assert_int_eq(1, *((int *) darray_view_get(view, 4)));
+    mu_check(darray_view_get(view, 5) == NULL);
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+}
+
+MU_TEST(test_darray_view_search) {
+    darray_view *view = new_darray_view(arr, int_cmp);
+    DARRAY_APPEND_INTS(arr, 3, 3);
+    int val = 3;
+    size_t rank = -1;
+    mu_assert_int_eq(1, darray_view_search(view, &val, int_cmp, &rank));
+    mu_check(3 == rank);
+    val = 5;
+    mu_assert_int_eq(0, darray_view_search(view, &val, int_cmp, &rank));
+    mu_assert_int_eq(DARRAY_ENOTIN, darray_geterr());
+}
+
+MU_TEST(test_darray_view_range) {
+    darray_view *view = new_darray_view(arr, int_cmp);
+    int low = 1, high = 3;
+    size_t start = -1, end = -1;
+    mu_assert_int_eq(1, darray_view_range(
+                view, &low, &high, int_cmp, &start, &end));
+    mu_check(1 == start);
+    mu_check(4 == end);
+    high = 0;
+    mu_assert_int_eq(1, darray_view_range(
+                view, &low, &high, int_cmp, &start, &end));
+    mu_check(start == end);
+}
+
+MU_TEST(test_darray_view_foreach) {
+    darray_view *view = new_darray_view(arr, int_cmp_desc);
+    add_int_static(NULL);
+    mu_assert_int_eq(1, darray_view_foreach(view, add_int_static));
+    mu_check(sum == 0 + 1 + 2 + 3 + 4);
+    mu_assert_int_eq(1, del_darray_view(view));
+}
+
+MU_TEST(test_darray_view_e) {
+    int val = 0;
+    size_t rank = -1;
+    mu_check(new_darray_view(NULL, int_cmp) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_check(darray_view_get(NULL, 0) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_view_search(NULL, &val, int_cmp, &rank));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_view_foreach(NULL, add_int_static));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, del_darray_view(NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+void *new_int_triple(const void *p) { return new_int(*((const int *) p) * 3); }
+
+MU_TEST(test_darray_stream) {
+    darray_stream *stream = new_darray_stream(arr);
+    mu_assert_int_eq(1, darray_stream_filter(stream, int_is_even));
+    mu_assert_int_eq(1, darray_stream_map(stream, new_int_triple, free));
+    darray *res = darray_stream_collect(stream);
+    DARRAY_ASSERT_MATCH(res, 0, 6, 12);
+    del_darray(res);
+
+    long long sum = 0;
+    mu_assert_int_eq(1, darray_stream_aggregate(stream, &sum, add_int_agg));
+    mu_assert_int_eq(0 + 6 + 12, sum);
+    DARRAY_ASSERT_MATCH(arr, 0, 1, 2, 3, 4);
+    mu_assert_int_eq(1, del_darray_stream(stream));
+}
+
+MU_TEST(test_darray_stream_take) {
+    darray_stream *stream = new_darray_stream(arr);
+    darray_stream_map(stream, new_int_triple, free);
+    darray_stream_take(stream, 4);
+    darray_stream_filter(stream, int_is_even);
+    darray_stream_map(stream, new_int_triple, free);
+    darray_stream_take(stream, 1);
+    darray *res = darray_stream_collect(stream);
+    DARRAY_ASSERT_MATCH(res, 0);
+    del_darray(res);
+    del_darray_stream(stream);
+
+    stream = new_darray_stream(arr);
+    darray_stream_take(stream, 3);
+    res = darray_stream_collect(stream);
+    DARRAY_ASSERT_MATCH(res, 0, 1, 2);
+    del_darray(res);
+    darray_stream_take(stream, 0);
+    res = darray_stream_collect(stream);
+    mu_assert_int_eq(0, darray_len(res));
+    del_darray(res);
+    del_darray_stream(stream);
+}
+
+MU_TEST(test_darray_stream_threads) {
+    darray *numbers = new_darray(free);
+    for (int i = 0; i < 10000; i++) {
+        darray_append(numbers, new_int(i));
+    }
+    darray_stream *stream = new_darray_stream(numbers);
+    mu_assert_int_eq(1, darray_stream_set_threads(stream, 4));
+    darray_stream_filter(stream, int_is_even);
+    darray_stream_map(stream, new_int_triple, free);
+    darray *res = darray_stream_collect(stream);
+    mu_assert_int_eq(5000, darray_len(res));
+    for (int i = 0; i < 5000; i++) {
+        mu_assert_int_eq(i * 6, *((int *) darray_get(res, i)));
+    }
+    del_darray(res);
+    del_darray_stream(stream);
+    del_darray(numbers);
+}
+
+MU_TEST(test_darray_stream_e) {
+    mu_check(new_darray_stream(NULL) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    darray_stream *stream = new_darray_stream(arr);
+    mu_assert_int_eq(0, darray_stream_map(stream, NULL, free));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_stream_filter(stream, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_stream_take(NULL, 1));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_stream_set_threads(stream, 0));
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+
+    mu_check(darray_stream_collect(NULL) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_stream_aggregate(stream, NULL, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, del_darray_stream(NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+    del_darray_stream(stream);
+}
+
+typedef struct {
+    int key;
+    int count;
+} int_count;
+
+void *new_int_count(const void *p) {
+    int_count *c = malloc(sizeof(int_count));
+    c->key = *((const int *) p);
+    c->count = 0;
+    return c;
+}
+
+void *new_int_count_dense(const void *p) {
+    int key = (int) *((const uint64_t *) p);
+    return new_int_count(&key);
+}
+
+void *new_int_count_fail(const void *p) { return NULL; }
+
+void int_count_step(const void *p, void *resp) {
+    ((int_count *) resp)->count++;
+}
+
+void int_count_merge(const void *p, void *resp) {
+    ((int_count *) resp)->count += ((const int_count *) p)->count;
+}
+
+uint64_t int_dense_key(const void *p) { return *((const int *) p); }
+
+MU_TEST(test_darray_group_by) {
+    DARRAY_APPEND_INTS(arr, 3, 1, 3, 0);
+    darray *res = darray_group_by(arr, int_cpy, int_hash, int_cmp,
+                                  new_int_count, int_count_step, NULL, free, 1);
+    DARRAY_ASSERT_MATCH(res, 0, 1, 2, 3, 4);
+    int counts[] = {2, 2, 1, 3, 1};
+    for (size_t i = 0; i < 5; i++) {
+        mu_assert_int_eq(counts[i], ((int_count *) darray_get(res, i))->count);
+    }
+    del_darray(res);
+
+    res = darray_group_by_dense(arr, int_dense_key, 5, new_int_count_dense,
+                                int_count_step, NULL, free, 1);
+    DARRAY_ASSERT_MATCH(res, 0, 1, 2, 3, 4);
+    for (size_t i = 0; i < 5; i++) {
+        mu_assert_int_eq(counts[i], ((int_count *) darray_get(res, i))->count);
+    }
+    del_darray(res);
+
+    res = darray_group_by_dense(arr, int_dense_key, 100, new_int_count_dense,
+                                int_count_step, NULL, free, 1);
+    mu_assert_int_eq(5, darray_len(res));
+    del_darray(res);
+}
+
+MU_TEST(test_darray_group_by_threads) {
+    darray *numbers = new_darray(free);
+    for (int i = 0; i < 10000; i++) {
+        darray_append(numbers, new_int(i * 7 % 100));
+    }
+
+    darray *res = darray_group_by(numbers, int_cpy, int_hash, int_cmp,
+                                  new_int_count, int_count_step,
+                                  int_count_merge, free, 4);
+    mu_assert_int_eq(100, darray_len(res));
+    for (int i = 0; i < 100; i++) {
+        int_count *c = darray_get(res, i);
+        mu_assert_int_eq(i * 7 % 100, c->key);
+        mu_assert_int_eq(100, c->count);
+    }
+    del_darray(res);
+
+    res = darray_group_by_dense(numbers, int_dense_key, 100,
+                                new_int_count_dense, int_count_step,
+                                int_count_merge, free, 4);
+    mu_assert_int_eq(100, darray_len(res));
+    for (int i = 0; i < 100; i++) {
+        int_count *c = darray_get(res, i);
+        mu_assert_int_eq(i, c->key);
+        mu_assert_int_eq(100, c->count);
+    }
+    del_darray(res);
+    del_darray(numbers);
+}
+
+MU_TEST(test_darray_group_by_e) {
+    mu_check(darray_group_by(NULL, int_cpy, int_hash, int_cmp, new_int_count,
+                             int_count_step, NULL, free, 1) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_check(darray_group_by(arr, int_cpy, int_hash, int_cmp, new_int_count,
+                             int_count_step, NULL, free, 2) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_check(darray_group_by(arr, int_cpy, int_hash, int_cmp, new_int_count,
+                             int_count_step, NULL, free, 0) == NULL);
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+
+    mu_check(darray_group_by(arr, int_cpy, int_hash, int_cmp,
+                             new_int_count_fail, int_count_step, NULL, free,
+                             1) == NULL);
+    mu_assert_int_eq(DARRAY_EALLOC, darray_geterr());
+
+    mu_check(darray_group_by_dense(arr, NULL, 5, new_int_count_dense,
+                                   int_count_step, NULL, free, 1) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_check(darray_group_by_dense(arr, int_dense_key, 0, new_int_count_dense,
+                                   int_count_step, NULL, free, 1) == NULL);
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+
+    mu_check(darray_group_by_dense(arr, int_dense_key, 3, new_int_count_dense,
+                                   int_count_step, NULL, free, 1) == NULL);
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+}
+
+typedef struct {
+    int left[16];
+    int right[16];
+    size_t len;
+} int_pairs;
+
+//! Records the left int and the tag after the key of the right item.
+void collect_pair(void *p1, void *p2, void *ctx) {
+    int_pairs *pairs = ctx;
+    pairs->left[pairs->len] = *((int *) p1);
+    pairs->right[pairs->len] = ((int *) p2)[1];
+    pairs->len++;
+}
+
+int *new_tagged(int key, int tag) {
+    int *p = malloc(sizeof(int) * 2);
+    p[0] = key;
+    p[1] = tag;
+    return p;
+}
+
+#define PAIRS_ASSERT_MATCH(pairs, n, ...) do { \
+    int pairs##_[] = {__VA_ARGS__}; \
+    mu_assert_int_eq(n, pairs.len); \
+    for (size_t i = 0; i < n; i++) { \
+        mu_assert_int_eq(pairs##_[2 * i], pairs.left[i]); \
+        mu_assert_int_eq(pairs##_[2 * i + 1], pairs.right[i]); \
+    } \
+} while (0)
+
+MU_TEST(test_darray_hash_join) {
+    darray *tagged = new_darray(free);
+    darray_append(tagged, new_tagged(3, 10));
+    darray_append(tagged, new_tagged(1, 11));
+    darray_append(tagged, new_tagged(3, 12));
+    darray_append(tagged, new_tagged(7, 13));
+    int_pairs pairs = { .len = 0 };
+    mu_assert_int_eq(1, darray_hash_join(arr, tagged, int_cpy, int_cpy,
+                                         int_hash, int_cmp, collect_pair,
+                                         &pairs));
+    PAIRS_ASSERT_MATCH(pairs, 3, 1, 11, 3, 10, 3, 12);
+
+    darray_append(tagged, new_tagged(0, 14));
+    darray_append(tagged, new_tagged(9, 15));
+    pairs.len = 0;
+    mu_assert_int_eq(1, darray_hash_join(arr, tagged, int_cpy, int_cpy,
+                                         int_hash, int_cmp, collect_pair,
+                                         &pairs));
+    PAIRS_ASSERT_MATCH(pairs, 4, 3, 10, 1, 11, 3, 12, 0, 14);
+
+    darray *empty = new_darray(free);
+    pairs.len = 0;
+    mu_assert_int_eq(1, darray_hash_join(empty, tagged, int_cpy, int_cpy,
+                                         int_hash, int_cmp, collect_pair,
+                                         &pairs));
+    mu_assert_int_eq(0, pairs.len);
+    del_darray(empty);
+    del_darray(tagged);
+}
+
+MU_TEST(test_darray_merge_join) {
+    darray *left = new_darray(free);
+    DARRAY_APPEND_INTS(left, 0, 1, 3, 3, 5);
+    darray *tagged = new_darray(free);
+    darray_append(tagged, new_tagged(0, 20));
+    darray_append(tagged, new_tagged(3, 21));
+    darray_append(tagged, new_tagged(3, 22));
+    darray_append(tagged, new_tagged(4, 23));
+    darray_append(tagged, new_tagged(8, 24));
+    int_pairs pairs = { .len = 0 };
+    mu_assert_int_eq(1, darray_merge_join(left, tagged, int_cpy, int_cpy,
+                                          int_cmp, collect_pair, &pairs));
+    PAIRS_ASSERT_MATCH(pairs, 5, 0, 20, 3, 21, 3, 22, 3, 21, 3, 22);
+
+    pairs.len = 0;
+    mu_assert_int_eq(1, darray_merge_join(arr, tagged, int_cpy, int_cpy,
+                                          int_cmp, collect_pair, &pairs));
+    PAIRS_ASSERT_MATCH(pairs, 4, 0, 20, 3, 21, 3, 22, 4, 23);
+    del_darray(tagged);
+    del_darray(left);
+}
+
+MU_TEST(test_darray_join_e) {
+    int_pairs pairs = { .len = 0 };
+    mu_assert_int_eq(0, darray_hash_join(NULL, arr, int_cpy, int_cpy,
+                                         int_hash, int_cmp, collect_pair,
+                                         &pairs));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_hash_join(arr, arr, int_cpy, int_cpy, NULL,
+                                         int_cmp, collect_pair, &pairs));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_merge_join(arr, NULL, int_cpy, int_cpy,
+                                          int_cmp, collect_pair, &pairs));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, darray_merge_join(arr, arr, int_cpy, int_cpy,
+                                          int_cmp, NULL, &pairs));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+    mu_assert_int_eq(0, pairs.len);
+}
+
+MU_TEST_SUITE(darray_test_suite) {
+    MU_SUITE_CONFIGURE(&darray_test_setup, &darray_test_teardown);
+
+    MU_RUN_TEST(test_darray_setup);
+    MU_RUN_TEST(test_new_darray_from);
+    MU_RUN_TEST(test_darray_len);
+    MU_RUN_TEST(test_darray_capacity);
+    MU_RUN_TEST(test_darray_memory_usage);
+    MU_RUN_TEST(test_darray_memory_usage_e);
+    MU_RUN_TEST(test_darray_registry_top);
+    MU_RUN_TEST(test_darray_registry_e);
+    MU_RUN_TEST(test_darray_foreach);
+    MU_RUN_TEST(test_darray_foreach_e);
+    MU_RUN_TEST(test_darray_aggregate);
+    MU_RUN_TEST(test_darray_aggregate_e);
+    MU_RUN_TEST(test_darray_pop_1);
+    MU_RUN_TEST(test_darray_pop_2);
     MU_RUN_TEST(test_darray_pop_3);
     MU_RUN_TEST(test_darray_pop_e1);
     MU_RUN_TEST(test_darray_pop_e2);
@@ -532,22 +1782,831 @@ MU_TEST_SUITE(darray_test_suite) {
     MU_RUN_TEST(test_darray_extend_at_e2);
     MU_RUN_TEST(test_darray_reverse);
     MU_RUN_TEST(test_darray_reverse_e);
+    MU_RUN_TEST(test_darray_remove_if);
+    MU_RUN_TEST(test_darray_remove_if_index);
+    MU_RUN_TEST(test_darray_remove_if_e);
+    MU_RUN_TEST(test_darray_partition);
+    MU_RUN_TEST(test_darray_partition_e);
+    MU_RUN_TEST(test_darray_foreach_r);
+    MU_RUN_TEST(test_darray_aggregate_r);
+    MU_RUN_TEST(test_darray_search_r);
+    MU_RUN_TEST(test_darray_remove_if_r);
+    MU_RUN_TEST(test_darray_sort_r);
+    MU_RUN_TEST(test_darray_clone_r);
+    MU_RUN_TEST(test_darray_r_e);
     MU_RUN_TEST(test_darray_unique_1);
     MU_RUN_TEST(test_darray_unique_2);
     MU_RUN_TEST(test_darray_unique_3);
     MU_RUN_TEST(test_darray_unique_e);
     MU_RUN_TEST(test_darray_sort);
     MU_RUN_TEST(test_darray_sort_e);
+    MU_RUN_TEST(test_darray_sort_by_key_1);
+    MU_RUN_TEST(test_darray_sort_by_key_2);
+    MU_RUN_TEST(test_darray_sort_by_key_e);
+    MU_RUN_TEST(test_darray_sort_cached_1);
+    MU_RUN_TEST(test_darray_sort_cached_2);
+    MU_RUN_TEST(test_darray_sort_cached_e);
+    MU_RUN_TEST(test_darray_nth_element_1);
+    MU_RUN_TEST(test_darray_nth_element_2);
+    MU_RUN_TEST(test_darray_nth_element_e);
+    MU_RUN_TEST(test_darray_partial_sort);
+    MU_RUN_TEST(test_darray_partial_sort_e);
+    MU_RUN_TEST(test_darray_top_k_1);
+    MU_RUN_TEST(test_darray_top_k_2);
+    MU_RUN_TEST(test_darray_top_k_e);
+    MU_RUN_TEST(test_darray_heapify);
+    MU_RUN_TEST(test_darray_heap_push_pop);
+    MU_RUN_TEST(test_darray_heap_update);
+    MU_RUN_TEST(test_darray_heap_e);
+    MU_RUN_TEST(test_darray_merge_1);
+    MU_RUN_TEST(test_darray_merge_2);
+    MU_RUN_TEST(test_darray_merge_self);
+    MU_RUN_TEST(test_darray_set_ops);
+    MU_RUN_TEST(test_darray_set_ops_gallop);
+    MU_RUN_TEST(test_darray_set_ops_e);
     MU_RUN_TEST(test_darray_clone_1);
     MU_RUN_TEST(test_darray_clone_2);
     MU_RUN_TEST(test_darray_clone_e);
+    MU_RUN_TEST(test_darray_clone_cow);
+    MU_RUN_TEST(test_darray_clone_cow_source);
+    MU_RUN_TEST(test_darray_clone_cow_snapshot);
+    MU_RUN_TEST(test_darray_clone_cow_unique);
+    MU_RUN_TEST(test_darray_clone_cow_e);
+    MU_RUN_TEST(test_darray_data);
+    MU_RUN_TEST(test_darray_cdata);
+    MU_RUN_TEST(test_darray_map_threshold);
     MU_RUN_TEST(test_darray_clear);
     MU_RUN_TEST(test_darray_clear_e);
+    MU_RUN_TEST(test_darray_bulk_free);
+    MU_RUN_TEST(test_darray_bulk_free_e);
+    MU_RUN_TEST(test_del_darray_deferred);
+    MU_RUN_TEST(test_del_darray_deferred_e);
+    MU_RUN_TEST(test_darray_stats);
+    MU_RUN_TEST(test_darray_stats_cmp);
+    MU_RUN_TEST(test_darray_stats_e);
+    MU_RUN_TEST(test_darray_index_1);
+    MU_RUN_TEST(test_darray_index_2);
+    MU_RUN_TEST(test_darray_index_3);
+    MU_RUN_TEST(test_darray_index_4);
+    MU_RUN_TEST(test_darray_index_e);
+    MU_RUN_TEST(test_darray_view_1);
+    MU_RUN_TEST(test_darray_view_2);
+    MU_RUN_TEST(test_darray_view_search);
+    MU_RUN_TEST(test_darray_view_range);
+    MU_RUN_TEST(test_darray_view_foreach);
+    MU_RUN_TEST(test_darray_view_e);
+    MU_RUN_TEST(test_darray_stream);
+    MU_RUN_TEST(test_darray_stream_take);
+    MU_RUN_TEST(test_darray_stream_threads);
+    MU_RUN_TEST(test_darray_stream_e);
+    MU_RUN_TEST(test_darray_group_by);
+    MU_RUN_TEST(test_darray_group_by_threads);
+    MU_RUN_TEST(test_darray_group_by_e);
+    MU_RUN_TEST(test_darray_hash_join);
+    MU_RUN_TEST(test_darray_merge_join);
+    MU_RUN_TEST(test_darray_join_e);
+}
+
+void int_max_agg(const void *intp, void *resp) {
+    if (*((const int *) intp) > *((int *) resp)) {
+        *((int *) resp) = *((const int *) intp);
+    }
+}
+
+void int_max_tile(const void *tile_ptr,
+                  size_t rows, size_t cols, size_t stride, void *resp) {
+    const int *row = tile_ptr;
+    for (size_t i = 0; i < rows; i++, row += stride) {
+        for (size_t j = 0; j < cols; j++) {
+            int_max_agg(row + j, resp);
+        }
+    }
+    (*((int *) resp + 1))++;
+}
+
+void dmatrix_test_setup() {
+    mat = new_dmatrix(sizeof(int), 2, 3);
+    for (int i = 0; i < 6; i++) {
+        *((int *) dmatrix_get(mat, i / 3, i % 3)) = i;
+    }
+}
+
+void dmatrix_test_teardown() {
+    del_dmatrix(mat);
+    mat = NULL;
+}
+
+MU_TEST(test_dmatrix_setup) {
+    mu_assert(mat != NULL, "fail to create new matrix");
+    DMATRIX_ASSERT_MATCH(mat, 2, 3, 0, 1, 2, 3, 4, 5);
+}
+
+MU_TEST(test_dmatrix_row) {
+    int *row = dmatrix_row(mat, 1);
+    mu_assert_int_eq(3, row[0]);
+    mu_assert_int_eq(5, row[2]);
+}
+
+MU_TEST(test_dmatrix_row_view) {
+    darray *view = dmatrix_row_view(mat, 1);
+    DARRAY_ASSERT_MATCH(view, 3, 4, 5);
+    mu_check(darray_get(view, 0) == dmatrix_get(mat, 1, 0));
+    mu_assert_int_eq(1, darray_sort(view, int_cmp_desc));
+    DARRAY_ASSERT_MATCH(view, 5, 4, 3);
+    mu_assert_int_eq(3, *(int *) dmatrix_get(mat, 1, 0));
+    del_darray(view);
+}
+
+MU_TEST(test_dmatrix_append_row) {
+    int row[] = {6, 7, 8};
+    mu_assert_int_eq(1, dmatrix_append_row(mat, row));
+    mu_assert_int_eq(1, dmatrix_append_row(mat, row));
+    DMATRIX_ASSERT_MATCH(mat, 4, 3, 0, 1, 2, 3, 4, 5, 6, 7, 8, 6, 7, 8);
+}
+
+MU_TEST(test_dmatrix_append_col) {
+    int col[] = {-1, -2};
+    mu_assert_int_eq(1, dmatrix_append_col(mat, col));
+    mu_assert_int_eq(1, dmatrix_append_col(mat, col));
+    DMATRIX_ASSERT_MATCH(mat, 2, 5, 0, 1, 2, -1, -1, 3, 4, 5, -2, -2);
+}
+
+MU_TEST(test_dmatrix_pop_row) {
+    mu_assert_int_eq(1, dmatrix_pop_row(mat, 0));
+    DMATRIX_ASSERT_MATCH(mat, 1, 3, 3, 4, 5);
+}
+
+MU_TEST(test_dmatrix_pop_col) {
+    mu_assert_int_eq(1, dmatrix_pop_col(mat, 1));
+    DMATRIX_ASSERT_MATCH(mat, 2, 2, 0, 2, 3, 5);
+}
+
+MU_TEST(test_dmatrix_aggregate) {
+    int max = -1;
+    mu_assert_int_eq(1, dmatrix_aggregate(mat, &max, int_max_agg));
+    mu_assert_int_eq(5, max);
+}
+
+MU_TEST(test_dmatrix_aggregate_tiles) {
+    int res[2] = {-1, 0};
+    mu_assert_int_eq(1, dmatrix_aggregate_tiles(mat, 1, 2, res, int_max_tile));
+    mu_assert_int_eq(5, res[0]);
+    mu_assert_int_eq(4, res[1]);
+}
+
+int int_sq(int x) { return x * x; }
+
+MU_TEST(test_dmatrix_transpose) {
+    dmatrix *trans = dmatrix_transpose(mat);
+    DMATRIX_ASSERT_MATCH(trans, 3, 2, 0, 3, 1, 4, 2, 5);
+    del_dmatrix(trans);
+}
+
+MU_TEST(test_dmatrix_mul_1) {
+    dmatrix *trans = dmatrix_transpose(mat);
+    dmatrix *prod = dmatrix_mul_int(mat, trans);
+    DMATRIX_ASSERT_MATCH(prod, 2, 2, 5, 14, 14, 50);
+    del_dmatrix(trans);
+    del_dmatrix(prod);
+}
+
+MU_TEST(test_dmatrix_mul_2) {
+    dmatrix *mat1 = new_dmatrix(sizeof(double), 100, 300);
+    dmatrix *mat2 = new_dmatrix(sizeof(double), 300, 300);
+    for (size_t i = 0; i < 300; i++) {
+        for (size_t j = 0; j < 300; j++) {
+            if (i < 100) {
+                *((double *) dmatrix_get(mat1, i, j)) = (double) (i + j);
+            }
+            *((double *) dmatrix_get(mat2, i, j)) = (double) (i == j);
+        }
+    }
+    mu_assert_int_eq(1, dmatrix_set_threads(4));
+    dmatrix *prod = dmatrix_mul_double(mat1, mat2);
+    mu_assert_int_eq(100, dmatrix_rows(prod));
+    mu_assert_int_eq(300, dmatrix_cols(prod));
+    for (size_t i = 0; i < 100; i++) {
+        for (size_t j = 0; j < 300; j++) {
+            mu_assert_double_eq(*((double *) dmatrix_get(mat1, i, j)),
+                                *((double *) dmatrix_get(prod, i, j)));
+        }
+    }
+    del_dmatrix(mat1);
+    del_dmatrix(mat2);
+    del_dmatrix(prod);
+}
+
+MU_TEST(test_dmatrix_mul_vec) {
+    int vec[] = {1, 0, -1};
+    int out[2];
+    mu_assert_int_eq(1, dmatrix_mul_vec_int(mat, vec, out));
+    mu_assert_int_eq(-2, out[0]);
+    mu_assert_int_eq(-2, out[1]);
+}
+
+MU_TEST(test_dmatrix_map) {
+    mu_assert_int_eq(1, dmatrix_map_int(mat, int_sq));
+    DMATRIX_ASSERT_MATCH(mat, 2, 3, 0, 1, 4, 9, 16, 25);
+}
+
+MU_TEST(test_dmatrix_kernels_e) {
+    double vec[] = {0, 0, 0};
+    double out[2];
+    mu_check(dmatrix_mul_int(mat, mat) == NULL);
+    mu_assert_int_eq(DARRAY_ESHAPE, darray_geterr());
+
+    mu_check(dmatrix_mul_int(NULL, mat) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, dmatrix_mul_vec_double(mat, vec, out));
+    mu_assert_int_eq(DARRAY_ESHAPE, darray_geterr());
+
+    mu_assert_int_eq(0, dmatrix_map_int(mat, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, dmatrix_set_threads(0));
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+}
+
+MU_TEST(test_dmatrix_e) {
+    int row[] = {0, 0, 0};
+    int max = -1;
+    mu_check(dmatrix_get(mat, 2, 0) == NULL);
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+
+    mu_check(dmatrix_row(NULL, 0) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, dmatrix_append_row(mat, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, dmatrix_append_col(NULL, row));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, dmatrix_pop_col(mat, 3));
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+
+    mu_assert_int_eq(0, dmatrix_aggregate_tiles(mat, 0, 1, &max, int_max_tile));
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+
+    mu_check(new_dmatrix(sizeof(int), SIZE_MAX / 2 + 1, 2) == NULL);
+    mu_assert_int_eq(DARRAY_EALLOC, darray_geterr());
+}
+
+MU_TEST_SUITE(dmatrix_test_suite) {
+    MU_SUITE_CONFIGURE(&dmatrix_test_setup, &dmatrix_test_teardown);
+
+    MU_RUN_TEST(test_dmatrix_setup);
+    MU_RUN_TEST(test_dmatrix_row);
+    MU_RUN_TEST(test_dmatrix_row_view);
+    MU_RUN_TEST(test_dmatrix_append_row);
+    MU_RUN_TEST(test_dmatrix_append_col);
+    MU_RUN_TEST(test_dmatrix_pop_row);
+    MU_RUN_TEST(test_dmatrix_pop_col);
+    MU_RUN_TEST(test_dmatrix_aggregate);
+    MU_RUN_TEST(test_dmatrix_aggregate_tiles);
+    MU_RUN_TEST(test_dmatrix_transpose);
+    MU_RUN_TEST(test_dmatrix_mul_1);
+    MU_RUN_TEST(test_dmatrix_mul_2);
+    MU_RUN_TEST(test_dmatrix_mul_vec);
+    MU_RUN_TEST(test_dmatrix_map);
+    MU_RUN_TEST(test_dmatrix_kernels_e);
+    MU_RUN_TEST(test_dmatrix_e);
+}
+
+void dseg_test_setup() {
+    seg = new_dseg(free);
+    for (int i = 0; i < 100; i++) {
+        dseg_append(seg, new_int(i));
+    }
+}
+
+void dseg_test_teardown() {
+    del_dseg(seg);
+    seg = NULL;
+}
+
+MU_TEST(test_dseg_setup) {
+    mu_assert(seg != NULL, "fail to create new segmented array");
+    mu_assert_int_eq(100, dseg_len(seg));
+    for (int i = 0; i < 100; i++) {
+        mu_assert_int_eq(i, *((int *) dseg_get(seg, i)));
+    }
+}
+
+MU_TEST(test_dseg_slot) {
+    void **slot_arr[100];
+    for (size_t i = 0; i < 100; i++) {
+        slot_arr[i] = dseg_slot(seg, i);
+    }
+    for (int i = 100; i < 10000; i++) {
+        dseg_append(seg, new_int(i));
+    }
+    for (size_t i = 0; i < 100; i++) {
+        mu_check(slot_arr[i] == dseg_slot(seg, i));
+    }
+    for (int i = 0; i < 10000; i++) {
+        mu_assert_int_eq(i, *((int *) dseg_get(seg, i)));
+    }
+}
+
+MU_TEST(test_dseg_pop) {
+    for (int i = 100; i < 1000; i++) {
+        dseg_append(seg, new_int(i));
+    }
+    for (int i = 0; i < 990; i++) {
+        mu_assert_int_eq(1, dseg_pop(seg));
+    }
+    mu_assert_int_eq(10, dseg_len(seg));
+    mu_assert_int_eq(9, *((int *) dseg_get(seg, 9)));
+    dseg_append(seg, new_int(10));
+    mu_assert_int_eq(10, *((int *) dseg_get(seg, 10)));
+}
+
+MU_TEST(test_dseg_foreach) {
+    add_int_static(NULL);
+    mu_assert_int_eq(1, dseg_foreach(seg, add_int_static));
+    mu_check(sum == 99 * 100 / 2);
+}
+
+MU_TEST(test_dseg_to_darray) {
+    darray *array = dseg_to_darray(seg);
+    mu_assert_int_eq(100, darray_len(array));
+    for (size_t i = 0; i < 100; i++) {
+        mu_check(darray_get(array, i) == dseg_get(seg, i));
+    }
+    del_darray(array);
+}
+
+MU_TEST(test_dseg_e) {
+    mu_assert_int_eq(0, dseg_len(NULL));
+
+    mu_assert_int_eq(0, dseg_append(seg, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_check(dseg_get(seg, 100) == NULL);
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+
+    mu_check(dseg_slot(NULL, 0) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    dseg *empty = new_dseg(NULL);
+    mu_assert_int_eq(0, dseg_pop(empty));
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+    del_dseg(empty);
+
+    mu_assert_int_eq(0, dseg_foreach(seg, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_check(dseg_to_darray(NULL) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, del_dseg(NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST_SUITE(dseg_test_suite) {
+    MU_SUITE_CONFIGURE(&dseg_test_setup, &dseg_test_teardown);
+
+    MU_RUN_TEST(test_dseg_setup);
+    MU_RUN_TEST(test_dseg_slot);
+    MU_RUN_TEST(test_dseg_pop);
+    MU_RUN_TEST(test_dseg_foreach);
+    MU_RUN_TEST(test_dseg_to_darray);
+    MU_RUN_TEST(test_dseg_e);
+}
+
+int write_int(const void *p, FILE *stream) {
+    return fwrite(p, sizeof(int), 1, stream) == 1;
+}
+
+void *read_int(FILE *stream) {
+    int *p = malloc(sizeof(int));
+    if (p != NULL && fread(p, sizeof(int), 1, stream) != 1) {
+        free(p);
+        p = NULL;
+    }
+    return p;
+}
+
+void *read_int_fail(FILE *stream) { return NULL; }
+
+int write_int_fail(const void *p, FILE *stream) { return 0; }
+
+//! Frees an integer after checking that it is not less than the previous one.
+void int_check_order(void *p, void *ctx) {
+    int *prev = ctx;
+    if (*((int *) p) < *prev) {
+        *prev = INT32_MAX;
+    } else if (*prev != INT32_MAX) {
+        *prev = *((int *) p);
+    }
+    free(p);
+}
+
+void dsort_test_setup() {
+    sorter = new_dsort(8 * (sizeof(void *) + sizeof(int)), int_cmp, int_size,
+                       write_int, read_int, free);
+    for (int i = 0; i < 100; i++) {
+        dsort_push(sorter, new_int(i * 37 % 100));
+    }
+}
+
+void dsort_test_teardown() {
+    del_dsort(sorter);
+    sorter = NULL;
+}
+
+MU_TEST(test_dsort_setup) {
+    mu_assert(sorter != NULL, "fail to create new external sorter");
+    mu_assert_int_eq(100, dsort_len(sorter));
+    mu_assert_int_eq(12, dsort_runs(sorter));
+}
+
+MU_TEST(test_dsort_collect) {
+    darray *array = dsort_collect(sorter);
+    mu_assert_int_eq(100, darray_len(array));
+    for (int i = 0; i < 100; i++) {
+        mu_assert_int_eq(i, *((int *) darray_get(array, i)));
+    }
+    del_darray(array);
+    mu_assert_int_eq(0, dsort_len(sorter));
+    mu_assert_int_eq(0, dsort_runs(sorter));
+
+    dsort_push(sorter, new_int(1));
+    dsort_push(sorter, new_int(0));
+    array = dsort_collect(sorter);
+    DARRAY_ASSERT_MATCH(array, 0, 1);
+    del_darray(array);
+}
+
+MU_TEST(test_dsort_drain_r) {
+    for (int i = 100; i < 20000; i++) {
+        dsort_push(sorter, new_int(i * 7919 % 20000));
+    }
+    // About 2500 runs are spilled, and merged as they pile up.
+    mu_check(dsort_runs(sorter) < 64);
+    int prev = -1;
+    mu_assert_int_eq(1, dsort_drain_r(sorter, int_check_order, &prev));
+    mu_assert_int_eq(19999, prev);
+    mu_assert_int_eq(0, dsort_len(sorter));
+}
+
+MU_TEST(test_dsort_in_memory) {
+    dsort *memory = new_dsort(SIZE_MAX, int_cmp, NULL, write_int, read_int,
+                              free);
+    for (int i = 0; i < 100; i++) {
+        dsort_push(memory, new_int(99 - i));
+    }
+    mu_assert_int_eq(0, dsort_runs(memory));
+    darray *array = dsort_collect(memory);
+    mu_assert_int_eq(100, darray_len(array));
+    mu_assert_int_eq(99, *((int *) darray_get(array, 99)));
+    del_darray(array);
+    del_dsort(memory);
+}
+
+MU_TEST(test_dsort_e) {
+    mu_assert_int_eq(0, dsort_len(NULL));
+    mu_assert_int_eq(0, dsort_runs(NULL));
+
+    mu_check(new_dsort(0, NULL, NULL, write_int, read_int, free) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, dsort_push(sorter, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_assert_int_eq(0, dsort_drain_r(sorter, NULL, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    mu_check(dsort_collect(NULL) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+
+    dsort *broken = new_dsort(0, int_cmp, NULL, write_int, read_int_fail, free);
+    for (int i = 0; i < 10; i++) {
+        dsort_push(broken, new_int(i));
+    }
+    mu_check(dsort_collect(broken) == NULL);
+    mu_assert_int_eq(DARRAY_EIO, darray_geterr());
+    mu_assert_int_eq(0, dsort_len(broken));
+    del_dsort(broken);
+
+    broken = new_dsort(0, int_cmp, NULL, write_int_fail, read_int, free);
+    mu_assert_int_eq(1, dsort_push(broken, new_int(0)));
+    int *item = new_int(1);
+    mu_assert_int_eq(0, dsort_push(broken, item));
+    mu_assert_int_eq(DARRAY_EIO, darray_geterr());
+    mu_assert_int_eq(0, dsort_runs(broken));
+    mu_assert_int_eq(1, dsort_len(broken));
+    free(item);
+    del_dsort(broken);
+
+    mu_assert_int_eq(0, del_dsort(NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST_SUITE(dsort_test_suite) {
+    MU_SUITE_CONFIGURE(&dsort_test_setup, &dsort_test_teardown);
+
+    MU_RUN_TEST(test_dsort_setup);
+    MU_RUN_TEST(test_dsort_collect);
+    MU_RUN_TEST(test_dsort_drain_r);
+    MU_RUN_TEST(test_dsort_in_memory);
+    MU_RUN_TEST(test_dsort_e);
+}
+
+void dtype_test_setup() {
+    ints = new_int_array();
+    for (int i = 0; i < 5; i++) {
+        int_array_push(ints, i);
+    }
+}
+
+void dtype_test_teardown() {
+    del_int_array(ints);
+    ints = NULL;
+}
+
+MU_TEST(test_dtype_setup) {
+    mu_assert(ints != NULL, "fail to create new value array");
+    mu_assert_int_eq(5, dtyped_len(ints));
+    for (int i = 0; i < 5; i++) {
+        mu_assert_int_eq(i, dtyped_get(ints, i));
+    }
+}
+
+MU_TEST(test_dtype_reserve) {
+    int_array *array = new_int_array();
+    mu_assert_int_eq(0, array->cap);
+    mu_assert_int_eq(1, int_array_reserve(array, 3));
+    mu_assert_int_eq(8, array->cap);
+    int *data = array->data;
+    mu_assert_int_eq(1, int_array_reserve(array, 5));
+    mu_check(array->data == data);
+    mu_assert_int_eq(1, int_array_reserve(array, 20));
+    mu_assert_int_eq(32, array->cap);
+    mu_assert_int_eq(0, array->len);
+    del_int_array(array);
+
+    mu_assert_int_eq(0, int_array_reserve(NULL, 1));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST(test_dtype_push) {
+    int_array *array = new_int_array();
+    for (int i = 0; i < 9; i++) {
+        mu_assert_int_eq(1, dtyped_push(array, i * i));
+    }
+    mu_assert_int_eq(9, dtyped_len(array));
+    mu_assert_int_eq(16, array->cap);
+    for (int i = 0; i < 9; i++) {
+        mu_assert_int_eq(i * i, dtyped_get(array, i));
+    }
+    const int values[] = {-1, -2};
+    mu_assert_int_eq(1, int_array_extend(array, values, 2));
+    mu_assert_int_eq(-2, dtyped_get(array, 10));
+    mu_assert_int_eq(1, int_array_truncate(array, 3));
+    mu_assert_int_eq(3, dtyped_len(array));
+    mu_assert_int_eq(0, int_array_truncate(array, 4));
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+    del_int_array(array);
+
+    mu_assert_int_eq(0, dtyped_get(ints, 5));
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+    mu_assert_int_eq(0, dtyped_push((int_array *) NULL, 0));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST(test_dtype_sum) {
+    mu_assert_int_eq(10, dtyped_sum(ints));
+
+    uchar_array *bytes = new_uchar_array();
+    for (int i = 0; i < 1000; i++) {
+        dtyped_push(bytes, 255);
+    }
+    mu_check(dtyped_sum(bytes) == 255000ULL);
+    del_uchar_array(bytes);
+
+    int_array *big = new_int_array();
+    dtyped_push(big, 2000000000);
+    dtyped_push(big, 2000000000);
+    dtyped_push(big, -1);
+    mu_check(dtyped_sum(big) == 3999999999LL);
+    del_int_array(big);
+}
+
+//! Checks that a value array is sorted and keeps the sum it had.
+static int int_array_check_sorted(int_array *array, long long total) {
+    for (size_t i = 1; i < array->len; i++) {
+        if (array->data[i - 1] > array->data[i]) return 0;
+    }
+    return dtyped_sum(array) == total;
+}
+
+MU_TEST(test_dtype_sort) {
+    int_array *sorted = new_int_array();
+    int_array *reversed = new_int_array();
+    int_array *repeated = new_int_array();
+    for (int i = 0; i < 1000; i++) {
+        dtyped_push(sorted, i);
+        dtyped_push(reversed, 999 - i);
+        dtyped_push(repeated, i * 7 % 3);
+    }
+    long long repeated_sum = dtyped_sum(repeated);
+
+    mu_assert_int_eq(1, dtyped_sort(sorted));
+    mu_check(int_array_check_sorted(sorted, 999 * 500));
+    mu_assert_int_eq(1, dtyped_sort(reversed));
+    mu_check(int_array_check_sorted(reversed, 999 * 500));
+    for (int i = 0; i < 1000; i++) {
+        mu_assert_int_eq(i, dtyped_get(reversed, i));
+    }
+    mu_assert_int_eq(1, dtyped_sort(repeated));
+    mu_check(int_array_check_sorted(repeated, repeated_sum));
+    mu_assert_int_eq(0, dtyped_get(repeated, 333));
+    mu_assert_int_eq(1, dtyped_get(repeated, 334));
+    mu_assert_int_eq(2, dtyped_get(repeated, 999));
+
+    del_int_array(sorted);
+    del_int_array(reversed);
+    del_int_array(repeated);
+
+    mu_assert_int_eq(0, dtyped_sort((int_array *) NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST(test_dtype_argsort) {
+    int_array *array = new_int_array();
+    const int values[] = {2, 1, 2, 1, 0, 2};
+    int_array_extend(array, values, 6);
+    size_t perm[100];
+    mu_assert_int_eq(1, int_array_argsort(array, perm));
+    const size_t expected[] = {4, 1, 3, 0, 2, 5};
+    for (size_t i = 0; i < 6; i++) {
+        mu_assert_int_eq(expected[i], perm[i]);
+    }
+
+    int_array_truncate(array, 0);
+    for (int i = 0; i < 100; i++) {
+        dtyped_push(array, 3 - i % 4);
+    }
+    mu_assert_int_eq(1, int_array_argsort(array, perm));
+    for (size_t i = 1; i < 100; i++) {
+        int prev = dtyped_get(array, perm[i - 1]);
+        int cur = dtyped_get(array, perm[i]);
+        mu_check(prev < cur || (prev == cur && perm[i - 1] < perm[i]));
+    }
+    del_int_array(array);
+
+    mu_assert_int_eq(0, int_array_argsort(ints, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST(test_dtype_between) {
+    size_t rows[5];
+    mu_assert_int_eq(3, int_array_between(ints, 1, 3, rows));
+    for (size_t i = 0; i < 3; i++) {
+        mu_assert_int_eq(i + 1, rows[i]);
+    }
+    mu_assert_int_eq(5, int_array_between(ints, -1, 9, rows));
+    mu_assert_int_eq(0, int_array_between(ints, 5, 9, rows));
+    mu_assert_int_eq(0, int_array_between(ints, 3, 1, rows));
+    mu_assert_int_eq(0, int_array_between(ints, 0, 4, NULL));
+}
+
+MU_TEST(test_dtype_gather) {
+    const size_t rows[] = {4, 0, 4};
+    int_array *result = int_array_gather(ints, rows, 3);
+    mu_assert_int_eq(3, dtyped_len(result));
+    mu_assert_int_eq(4, dtyped_get(result, 0));
+    mu_assert_int_eq(0, dtyped_get(result, 1));
+    mu_assert_int_eq(4, dtyped_get(result, 2));
+    del_int_array(result);
+
+    result = int_array_gather(ints, NULL, 0);
+    mu_assert_int_eq(0, dtyped_len(result));
+    del_int_array(result);
+
+    const size_t bad_rows[] = {1, 5};
+    mu_check(int_array_gather(ints, bad_rows, 2) == NULL);
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+    mu_check(int_array_gather(ints, NULL, 1) == NULL);
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+}
+
+MU_TEST(test_dtype_string) {
+    string_array *strings = new_string_array();
+    mu_assert_int_eq(1, dtyped_push(strings, "pear"));
+    mu_assert_int_eq(1, dtyped_push(strings, ""));
+    mu_assert_int_eq(1, dtyped_push(strings, "apple"));
+    mu_assert_int_eq(1, dtyped_push(strings, "pear"));
+    mu_assert_int_eq(4, dtyped_len(strings));
+    mu_assert_string_eq("pear", dtyped_get(strings, 0));
+    mu_assert_string_eq("", dtyped_get(strings, 1));
+    mu_assert_string_eq("apple", dtyped_get(strings, 2));
+    mu_assert_int_eq(5 + 1 + 6 + 5, strings->bytes->len);
+
+    mu_assert_int_eq(0, dtyped_push(strings, NULL));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+    mu_assert_int_eq(4, dtyped_len(strings));
+    mu_check(dtyped_get(strings, 4) == NULL);
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+
+    size_t perm[4];
+    mu_assert_int_eq(1, string_array_argsort(strings, perm));
+    const size_t expected[] = {1, 2, 0, 3};
+    for (size_t i = 0; i < 4; i++) {
+        mu_assert_int_eq(expected[i], perm[i]);
+    }
+
+    mu_assert_int_eq(1, string_array_truncate(strings, 2));
+    mu_assert_int_eq(2, dtyped_len(strings));
+    mu_assert_int_eq(5 + 1, strings->bytes->len);
+    mu_assert_int_eq(1, dtyped_push(strings, "fig"));
+    mu_assert_string_eq("fig", dtyped_get(strings, 2));
+    mu_assert_int_eq(0, string_array_truncate(strings, 4));
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+    mu_assert_int_eq(1, string_array_truncate(strings, 0));
+    mu_assert_int_eq(0, dtyped_len(strings));
+    mu_assert_int_eq(0, strings->bytes->len);
+    del_string_array(strings);
+}
+
+MU_TEST(test_dtype_table) {
+    person_table *people = new_person_table();
+    mu_assert_int_eq(1, person_table_append(people,
+                (person_row) {7, "Ada", 99}));
+    mu_assert_int_eq(1, person_table_append(people,
+                (person_row) {3, "Bob", 50}));
+    mu_assert_int_eq(1, person_table_append(people,
+                (person_row) {5, "Cy", 75}));
+    mu_assert_int_eq(3, person_table_len(people));
+
+    mu_assert_int_eq(0, person_table_append(people,
+                (person_row) {9, NULL, 10}));
+    mu_assert_int_eq(DARRAY_ENULLS, darray_geterr());
+    mu_assert_int_eq(3, person_table_len(people));
+    mu_assert_int_eq(3, dtyped_len(people->id));
+    mu_assert_int_eq(3, dtyped_len(people->name));
+    mu_assert_int_eq(3, dtyped_len(people->score));
+
+    person_row row = person_table_get(people, 1);
+    mu_assert_int_eq(3, row.id);
+    mu_assert_string_eq("Bob", row.name);
+    mu_assert_int_eq(50, row.score);
+    row = person_table_get(people, 3);
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+    mu_assert_int_eq(0, row.id);
+    mu_check(row.name == NULL);
+    mu_assert_int_eq(0, row.score);
+
+    size_t perm[3];
+    ulong_array_argsort(people->id, perm);
+    person_table *by_id = person_table_select(people, perm, 3);
+    mu_assert_int_eq(3, person_table_len(by_id));
+    const unsigned long ids[] = {3, 5, 7};
+    const char *names[] = {"Bob", "Cy", "Ada"};
+    for (size_t i = 0; i < 3; i++) {
+        row = person_table_get(by_id, i);
+        mu_assert_int_eq(ids[i], row.id);
+        mu_assert_string_eq(names[i], row.name);
+    }
+    del_person_table(by_id);
+
+    size_t n = uchar_array_between(people->score, 60, 100, perm);
+    person_table *passed = person_table_select(people, perm, n);
+    mu_assert_int_eq(2, person_table_len(passed));
+    mu_assert_string_eq("Cy", person_table_get(passed, 1).name);
+    del_person_table(passed);
+
+    const size_t bad_rows[] = {0, 3};
+    mu_check(person_table_select(people, bad_rows, 2) == NULL);
+    mu_assert_int_eq(DARRAY_EINDEX, darray_geterr());
+    del_person_table(people);
+}
+
+MU_TEST_SUITE(dtype_test_suite) {
+    MU_SUITE_CONFIGURE(&dtype_test_setup, &dtype_test_teardown);
+
+    MU_RUN_TEST(test_dtype_setup);
+    MU_RUN_TEST(test_dtype_reserve);
+    MU_RUN_TEST(test_dtype_push);
+    MU_RUN_TEST(test_dtype_sum);
+    MU_RUN_TEST(test_dtype_sort);
+    MU_RUN_TEST(test_dtype_argsort);
+    MU_RUN_TEST(test_dtype_between);
+    MU_RUN_TEST(test_dtype_gather);
+    MU_RUN_TEST(test_dtype_string);
+    MU_RUN_TEST(test_dtype_table);
 }
 
 int main() {
     MU_RUN_SUITE(int_test_suite);
     MU_RUN_SUITE(darray_test_suite);
+    MU_RUN_SUITE(dmatrix_test_suite);
+    MU_RUN_SUITE(dseg_test_suite);
+    MU_RUN_SUITE(dsort_test_suite);
+    MU_RUN_SUITE(dtype_test_suite);
     MU_REPORT();
     return MU_EXIT_CODE;
 }
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "../darray.hpp"
+#include "minunit.h"
+
+static int copies = 0;
+
+//! Copies an integer allocated with `new` and counts the copy.
+void *int_copy(const void *p) {
+    copies++;
+    return new int(*static_cast<const int *>(p));
+}
+
+//! Represents an object whose constructor throws on request.
+struct thrower {
+    explicit thrower(bool fail) {
+        if (fail) {
+            throw std::runtime_error("thrower");
+        }
+    }
+};
+
+static DArray<int> *numbers = nullptr;
+
+void wrapper_test_setup() {
+    numbers = new DArray<int>();
+    for (int i = 0; i < 5; i++) {
+        numbers->emplace_back(4 - i);
+    }
+}
+
+void wrapper_test_teardown() {
+    delete numbers;
+    numbers = nullptr;
+}
+
+MU_TEST(test_wrapper_setup) {
+    mu_assert_int_eq(5, numbers->size());
+    mu_assert_int_eq(4, numbers->front());
+    mu_assert_int_eq(0, numbers->back());
+}
+
+MU_TEST(test_wrapper_move) {
+    DArray<int> moved(std::move(*numbers));
+    mu_check(numbers->get() == nullptr);
+    const DArray<int> &empty = *numbers;
+    mu_check(empty.begin() == empty.end());
+    mu_assert_int_eq(5, moved.size());
+
+    DArray<int> assigned;
+    assigned.emplace_back(42);
+    assigned = std::move(moved);
+    mu_check(moved.get() == nullptr);
+    mu_assert_int_eq(5, assigned.size());
+    mu_assert_int_eq(4, assigned[0]);
+
+    *numbers = std::move(assigned);
+    mu_assert_int_eq(5, numbers->size());
+}
+
+MU_TEST(test_wrapper_emplace_back) {
+    int &item = numbers->emplace_back(7);
+    mu_assert_int_eq(7, item);
+    mu_check(&item == &numbers->back());
+    mu_assert_int_eq(6, numbers->size());
+
+    DArray<thrower> throwers;
+    throwers.emplace_back(false);
+    bool thrown = false;
+    try {
+        throwers.emplace_back(true);
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    mu_check(thrown);
+    mu_assert_int_eq(1, throwers.size());
+}
+
+MU_TEST(test_wrapper_at) {
+    mu_assert_int_eq(2, numbers->at(2));
+    bool thrown = false;
+    try {
+        numbers->at(5);
+    } catch (const std::out_of_range &) {
+        thrown = true;
+    }
+    mu_check(thrown);
+
+    const DArray<int> &view = *numbers;
+    thrown = false;
+    try {
+        view.at(5);
+    } catch (const std::out_of_range &) {
+        thrown = true;
+    }
+    mu_check(thrown);
+}
+
+MU_TEST(test_wrapper_iterator) {
+    DArray<int>::iterator first = numbers->begin();
+    DArray<int>::iterator last = numbers->end();
+    mu_assert_int_eq(5, last - first);
+    mu_assert_int_eq(2, *(first + 2));
+    mu_assert_int_eq(1, first[3]);
+    mu_assert_int_eq(0, *(last - 1));
+    mu_check(first < last && last > first && first <= first);
+
+    std::sort(numbers->begin(), numbers->end());
+    for (int i = 0; i < 5; i++) {
+        mu_assert_int_eq(i, (*numbers)[i]);
+    }
+    DArray<int>::iterator it =
+        std::lower_bound(numbers->begin(), numbers->end(), 3);
+    mu_assert_int_eq(3, it - numbers->begin());
+    it = std::lower_bound(numbers->begin(), numbers->end(), 9);
+    mu_check(it == numbers->end());
+}
+
+MU_TEST(test_wrapper_const_clone) {
+    DArray<int> clone(darray_clone_cow(numbers->get(), int_copy));
+    const DArray<int> &view = clone;
+    copies = 0;
+    int total = 0;
+    for (const int &item : view) {
+        total += item;
+    }
+    mu_assert_int_eq(0 + 1 + 2 + 3 + 4, total);
+    mu_assert_int_eq(4, *std::max_element(view.cbegin(), view.cend()));
+    mu_assert_int_eq(0, copies);
+    mu_check(darray_cdata(clone.get()) == darray_cdata(numbers->get()));
+
+    std::sort(clone.begin(), clone.end());
+    mu_assert_int_eq(5, copies);
+    mu_check(darray_cdata(clone.get()) != darray_cdata(numbers->get()));
+}
+
+MU_TEST_SUITE(wrapper_test_suite) {
+    MU_SUITE_CONFIGURE(&wrapper_test_setup, &wrapper_test_teardown);
+
+    MU_RUN_TEST(test_wrapper_setup);
+    MU_RUN_TEST(test_wrapper_move);
+    MU_RUN_TEST(test_wrapper_emplace_back);
+    MU_RUN_TEST(test_wrapper_at);
+    MU_RUN_TEST(test_wrapper_iterator);
+    MU_RUN_TEST(test_wrapper_const_clone);
+}
+
+int main() {
+    MU_RUN_SUITE(wrapper_test_suite);
+    MU_REPORT();
+    return MU_EXIT_CODE;
+}
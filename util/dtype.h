@@ -41,6 +41,268 @@ void *alph##_cpy_deep(const void *p) {                                         \
     return cpy;                                                                \
 }
 
+//! Generates a stable sort of row numbers by the values of an array.
+/*!
+The generated function fills `perm` with the `len_of(array)` row numbers of the
+array ordered by `less(array, i, j)`. Both must be macros or functions, and
+`less` returns whether row `i` comes before row `j`. It is a bottom-up merge
+sort, so rows with equal values keep their order, and sorting by one column
+after another sorts by several keys.
+*/
+#define MAKE_DTYPE_ARGSORT(name, array_type, len_of, less)                     \
+                                                                               \
+static inline int name(array_type *array, size_t *perm) {                      \
+    if (array == NULL || perm == NULL) {                                       \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    size_t len = len_of(array);                                                \
+    size_t *tmp = (size_t *) malloc(sizeof(size_t) * (len > 0 ? len : 1));     \
+    if (tmp == NULL) {                                                         \
+        darray_errno = DARRAY_EALLOC;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    for (size_t i = 0; i < len; i++) perm[i] = i;                              \
+    size_t *src = perm, *dst = tmp;                                            \
+    for (size_t width = 1; width < len; width *= 2) {                          \
+        for (size_t lo = 0; lo < len; lo += 2 * width) {                       \
+            size_t mid = len - lo > width ? lo + width : len;                  \
+            size_t hi = len - mid > width ? mid + width : len;                 \
+            size_t i = lo, j = mid, k = lo;                                    \
+            while (i < mid && j < hi) {                                        \
+                dst[k++] = less(array, src[j], src[i]) ? src[j++] : src[i++];  \
+            }                                                                  \
+            while (i < mid) dst[k++] = src[i++];                               \
+            while (j < hi) dst[k++] = src[j++];                                \
+        }                                                                      \
+        size_t *swap = src;                                                    \
+        src = dst;                                                             \
+        dst = swap;                                                            \
+    }                                                                          \
+    for (size_t i = 0; src != perm && i < len; i++) perm[i] = src[i];          \
+    free(tmp);                                                                 \
+    return 1;                                                                  \
+}
+
+//! Returns the number of values in an array.
+#define DTYPE_ARRAY_LEN(array) ((array)->len)
+
+//! Returns whether a value of an array is less than another.
+#define DTYPE_VALUE_LESS(array, i, j) ((array)->data[i] < (array)->data[j])
+
+//! Generates a growable array of values of a given type.
+/*!
+The generated `alph##_array` stores the values themselves contiguously, unlike a
+dynamic array of pointers to values. Its functions are `static inline` and
+compare, add and copy values directly, so a compiler can inline them into the
+caller without any call through a function pointer. `sum_type` is the type of
+the sum, which is wider than the values to avoid overflowing.
+
+Besides the usual operations, `alph##_array_argsort`, `alph##_array_gather` and
+`alph##_array_between` work with row numbers, so that several arrays of the same
+length can be sorted or filtered together as the columns of a table. The `perm`
+and `rows` buffers they fill must have room for every row of the array.
+
+\see The `_Generic` front-end in `util/dtyped.h` instantiates this macro for
+every primitive type.
+*/
+#define MAKE_DTYPE_ARRAY(type, alph, sum_type)                                 \
+                                                                               \
+typedef struct {                                                               \
+    type *data;                                                                \
+    size_t len;                                                                \
+    size_t cap;                                                                \
+} alph##_array;                                                                \
+                                                                               \
+typedef type alph##_value;                                                     \
+                                                                               \
+static inline alph##_array *new_##alph##_array(void) {                         \
+    alph##_array *array = (alph##_array *) malloc(sizeof(alph##_array));       \
+    if (array == NULL) {                                                       \
+        darray_errno = DARRAY_EALLOC;                                          \
+        return NULL;                                                           \
+    }                                                                          \
+    array->data = NULL;                                                        \
+    array->len = 0;                                                            \
+    array->cap = 0;                                                            \
+    return array;                                                              \
+}                                                                              \
+                                                                               \
+static inline int del_##alph##_array(alph##_array *array) {                    \
+    if (array == NULL) {                                                       \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    free(array->data);                                                         \
+    free(array);                                                               \
+    return 1;                                                                  \
+}                                                                              \
+                                                                               \
+static inline int alph##_array_reserve(alph##_array *array, size_t cap) {      \
+    if (array == NULL) {                                                       \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    if (cap <= array->cap) return 1;                                           \
+    size_t new_cap = array->cap == 0 ? 8 : array->cap;                         \
+    while (new_cap < cap) new_cap *= 2;                                        \
+    type *data = (type *) realloc(array->data, sizeof(type) * new_cap);        \
+    if (data == NULL) {                                                        \
+        darray_errno = DARRAY_EALLOC;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    array->data = data;                                                        \
+    array->cap = new_cap;                                                      \
+    return 1;                                                                  \
+}                                                                              \
+                                                                               \
+static inline int alph##_array_push(alph##_array *array, type x) {             \
+    if (array == NULL) {                                                       \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    if (array->len == array->cap &&                                            \
+            !alph##_array_reserve(array, array->len + 1)) {                    \
+        return 0;                                                              \
+    }                                                                          \
+    array->data[array->len++] = x;                                             \
+    return 1;                                                                  \
+}                                                                              \
+                                                                               \
+static inline int alph##_array_extend(alph##_array *array,                     \
+                                      const type *values, size_t n) {          \
+    if (array == NULL || (values == NULL && n > 0)) {                          \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    if (!alph##_array_reserve(array, array->len + n)) return 0;                \
+    for (size_t i = 0; i < n; i++) array->data[array->len + i] = values[i];    \
+    array->len += n;                                                           \
+    return 1;                                                                  \
+}                                                                              \
+                                                                               \
+static inline size_t alph##_array_len(alph##_array *array) {                   \
+    return array == NULL ? 0 : array->len;                                     \
+}                                                                              \
+                                                                               \
+static inline type alph##_array_get(alph##_array *array, size_t index) {       \
+    if (array == NULL) {                                                       \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    if (index >= array->len) {                                                 \
+        darray_errno = DARRAY_EINDEX;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    return array->data[index];                                                 \
+}                                                                              \
+                                                                               \
+static inline int alph##_array_truncate(alph##_array *array, size_t len) {     \
+    if (array == NULL) {                                                       \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    if (len > array->len) {                                                    \
+        darray_errno = DARRAY_EINDEX;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    array->len = len;                                                          \
+    return 1;                                                                  \
+}                                                                              \
+                                                                               \
+static inline sum_type alph##_array_sum(alph##_array *array) {                 \
+    sum_type sum = 0;                                                          \
+    if (array == NULL) return sum;                                             \
+    for (size_t i = 0; i < array->len; i++) sum += array->data[i];             \
+    return sum;                                                                \
+}                                                                              \
+                                                                               \
+static inline void alph##_sort_range(type *data, size_t len) {                 \
+    while (len > 16) {                                                         \
+        size_t mid = len / 2, i = 0, j = len - 1;                              \
+        type tmp;                                                              \
+        if (data[mid] < data[0]) {                                             \
+            tmp = data[mid]; data[mid] = data[0]; data[0] = tmp;               \
+        }                                                                      \
+        if (data[j] < data[mid]) {                                             \
+            tmp = data[j]; data[j] = data[mid]; data[mid] = tmp;               \
+            if (data[mid] < data[0]) {                                         \
+                tmp = data[mid]; data[mid] = data[0]; data[0] = tmp;           \
+            }                                                                  \
+        }                                                                      \
+        type pivot = data[mid];                                                \
+        for (;;) {                                                             \
+            while (data[i] < pivot) i++;                                       \
+            while (pivot < data[j]) j--;                                       \
+            if (i >= j) break;                                                 \
+            tmp = data[i]; data[i] = data[j]; data[j] = tmp;                   \
+            i++;                                                               \
+            j--;                                                               \
+        }                                                                      \
+        size_t left = j + 1;                                                   \
+        if (left < len - left) {                                               \
+            alph##_sort_range(data, left);                                     \
+            data += left;                                                      \
+            len -= left;                                                       \
+        } else {                                                               \
+            alph##_sort_range(data + left, len - left);                        \
+            len = left;                                                        \
+        }                                                                      \
+    }                                                                          \
+    for (size_t i = 1; i < len; i++) {                                         \
+        type x = data[i];                                                      \
+        size_t j = i;                                                          \
+        for (; j > 0 && x < data[j - 1]; j--) data[j] = data[j - 1];           \
+        data[j] = x;                                                           \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+static inline int alph##_array_sort(alph##_array *array) {                     \
+    if (array == NULL) {                                                       \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    alph##_sort_range(array->data, array->len);                                \
+    return 1;                                                                  \
+}                                                                              \
+                                                                               \
+MAKE_DTYPE_ARGSORT(alph##_array_argsort, alph##_array,                         \
+                   DTYPE_ARRAY_LEN, DTYPE_VALUE_LESS)                          \
+                                                                               \
+static inline alph##_array *alph##_array_gather(                               \
+        alph##_array *array, const size_t *rows, size_t n) {                   \
+    if (array == NULL || (rows == NULL && n > 0)) {                            \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return NULL;                                                           \
+    }                                                                          \
+    alph##_array *result = new_##alph##_array();                               \
+    if (result == NULL || !alph##_array_reserve(result, n)) {                  \
+        if (result != NULL) del_##alph##_array(result);                        \
+        return NULL;                                                           \
+    }                                                                          \
+    for (size_t i = 0; i < n; i++) {                                           \
+        if (rows[i] >= array->len) {                                           \
+            darray_errno = DARRAY_EINDEX;                                      \
+            del_##alph##_array(result);                                        \
+            return NULL;                                                       \
+        }                                                                      \
+        result->data[i] = array->data[rows[i]];                                \
+    }                                                                          \
+    result->len = n;                                                           \
+    return result;                                                             \
+}                                                                              \
+                                                                               \
+static inline size_t alph##_array_between(alph##_array *array,                 \
+                                          type lo, type hi, size_t *rows) {    \
+    size_t n = 0;                                                              \
+    if (array == NULL || rows == NULL) return 0;                               \
+    for (size_t i = 0; i < array->len; i++) {                                  \
+        rows[n] = i;                                                           \
+        n += lo <= array->data[i] && array->data[i] <= hi;                     \
+    }                                                                          \
+    return n;                                                                  \
+}
+
 #define MAKE_DTYPE_CHAR()     MAKE_DTYPE(char,               char,     "%c ")
 #define MAKE_DTYPE_SCHAR()    MAKE_DTYPE(signed char,        schar,    "%hhi ")
 #define MAKE_DTYPE_UCHAR()    MAKE_DTYPE(unsigned char,      uchar,    "%hhu ")
@@ -0,0 +1,348 @@
+/*!
+\file util/dtyped.h
+\author Edward Ji
+\date 19 Oct 2026
+\brief A `_Generic` front-end for arrays of primitive values.
+
+This header generates a value array with `MAKE_DTYPE_ARRAY` for every primitive
+type that `MAKE_DTYPE_*` supports, e.g. `double_array` and `uchar_array`. The
+macros below pick the function for the type of their first argument at compile
+time, so the same code works for any value array and is inlined into the caller.
+
+A `string_array` keeps strings back to back in one arena of bytes, and
+`MAKE_DTYPE_TABLE` generates a columnar table with one array per field of its
+records.
+
+The macros are prefixed with `dtyped_` rather than `darray_`, so the dynamic
+array functions of the same names keep working next to this header.
+
+An example of summing and sorting an array of doubles:
+```
+double_array *numbers = new_double_array();
+dtyped_push(numbers, 3.14);
+dtyped_push(numbers, 2.72);
+double sum = dtyped_sum(numbers);
+dtyped_sort(numbers);
+del_double_array(numbers);
+```
+
+\note The first argument must have exactly a pointer to a value array type or
+`string_array *`. A pointer to `const` or a plain `NULL` does not compile.
+*/
+
+#ifndef DTYPED_H
+#define DTYPED_H
+
+#include <string.h>
+
+#include "dtype.h"
+
+MAKE_DTYPE_ARRAY(char,               char,     long long)
+MAKE_DTYPE_ARRAY(signed char,        schar,    long long)
+MAKE_DTYPE_ARRAY(unsigned char,      uchar,    unsigned long long)
+MAKE_DTYPE_ARRAY(short,              short,    long long)
+MAKE_DTYPE_ARRAY(unsigned short,     ushort,   unsigned long long)
+MAKE_DTYPE_ARRAY(int,                int,      long long)
+MAKE_DTYPE_ARRAY(unsigned,           unsigned, unsigned long long)
+MAKE_DTYPE_ARRAY(long,               long,     long long)
+MAKE_DTYPE_ARRAY(unsigned long,      ulong,    unsigned long long)
+MAKE_DTYPE_ARRAY(long long,          llong,    long long)
+MAKE_DTYPE_ARRAY(unsigned long long, ullong,   unsigned long long)
+MAKE_DTYPE_ARRAY(float,              float,    double)
+MAKE_DTYPE_ARRAY(double,             double,   double)
+MAKE_DTYPE_ARRAY(long double,        ldouble,  long double)
+
+//! Represents a growable array of strings stored in one arena of bytes.
+/*!
+The characters of every string, each followed by a null byte, are appended to a
+single array of bytes, and the offset of each string is kept in another array.
+Pushing a string therefore does not allocate it on its own, and reading the
+strings in order walks memory sequentially.
+*/
+typedef struct {
+    /*! Holds the characters of every string, each followed by a null byte. */
+    char_array *bytes;
+    /*! Holds the offset of each string in the bytes. */
+    ullong_array *offsets;
+} string_array;
+
+typedef const char *string_value;
+
+static inline int del_string_array(string_array *array) {
+    if (array == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (array->bytes != NULL) del_char_array(array->bytes);
+    if (array->offsets != NULL) del_ullong_array(array->offsets);
+    free(array);
+    return 1;
+}
+
+static inline string_array *new_string_array(void) {
+    string_array *array = (string_array *) malloc(sizeof(string_array));
+    if (array == NULL) {
+        darray_errno = DARRAY_EALLOC;
+        return NULL;
+    }
+    array->bytes = new_char_array();
+    array->offsets = new_ullong_array();
+    if (array->bytes == NULL || array->offsets == NULL) {
+        del_string_array(array);
+        return NULL;
+    }
+    return array;
+}
+
+static inline int string_array_push(string_array *array, const char *s) {
+    if (array == NULL || s == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    size_t offset = array->bytes->len;
+    if (!char_array_extend(array->bytes, s, strlen(s) + 1)) return 0;
+    if (!ullong_array_push(array->offsets, offset)) {
+        array->bytes->len = offset;
+        return 0;
+    }
+    return 1;
+}
+
+static inline size_t string_array_len(string_array *array) {
+    return array == NULL ? 0 : array->offsets->len;
+}
+
+static inline const char *string_array_get(string_array *array, size_t index) {
+    if (array == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+    if (index >= array->offsets->len) {
+        darray_errno = DARRAY_EINDEX;
+        return NULL;
+    }
+    return array->bytes->data + array->offsets->data[index];
+}
+
+static inline int string_array_truncate(string_array *array, size_t len) {
+    if (array == NULL) {
+        darray_errno = DARRAY_ENULLS;
+        return 0;
+    }
+    if (len > array->offsets->len) {
+        darray_errno = DARRAY_EINDEX;
+        return 0;
+    }
+    if (len < array->offsets->len) {
+        array->bytes->len = array->offsets->data[len];
+        array->offsets->len = len;
+    }
+    return 1;
+}
+
+//! Returns the number of strings in an array.
+#define DTYPE_STRING_LEN(array) ((array)->offsets->len)
+
+//! Returns whether a string of an array is less than another.
+#define DTYPE_STRING_LESS(array, i, j)                                         \
+    (strcmp((array)->bytes->data + (array)->offsets->data[i],                  \
+            (array)->bytes->data + (array)->offsets->data[j]) < 0)
+
+MAKE_DTYPE_ARGSORT(string_array_argsort, string_array,
+                   DTYPE_STRING_LEN, DTYPE_STRING_LESS)
+
+static inline string_array *string_array_gather(
+        string_array *array, const size_t *rows, size_t n) {
+    if (array == NULL || (rows == NULL && n > 0)) {
+        darray_errno = DARRAY_ENULLS;
+        return NULL;
+    }
+    string_array *result = new_string_array();
+    if (result == NULL || !ullong_array_reserve(result->offsets, n)) {
+        if (result != NULL) del_string_array(result);
+        return NULL;
+    }
+    for (size_t i = 0; i < n; i++) {
+        const char *s = string_array_get(array, rows[i]);
+        if (s == NULL || !string_array_push(result, s)) {
+            del_string_array(result);
+            return NULL;
+        }
+    }
+    return result;
+}
+
+//! Expands to a `_Generic` association of a value array function.
+#define DTYPED_ASSOC(alph, op) , alph##_array *: alph##_array_##op
+
+//! Expands to the `_Generic` associations of a function of every value array.
+#define DTYPED_ASSOCS(op)                                                      \
+    DTYPED_ASSOC(char, op) DTYPED_ASSOC(schar, op) DTYPED_ASSOC(uchar, op)     \
+    DTYPED_ASSOC(short, op) DTYPED_ASSOC(ushort, op) DTYPED_ASSOC(int, op)     \
+    DTYPED_ASSOC(unsigned, op) DTYPED_ASSOC(long, op) DTYPED_ASSOC(ulong, op)  \
+    DTYPED_ASSOC(llong, op) DTYPED_ASSOC(ullong, op) DTYPED_ASSOC(float, op)   \
+    DTYPED_ASSOC(double, op) DTYPED_ASSOC(ldouble, op)
+
+//! Expands to the declaration of a column of a table.
+#define DTYPE_TABLE_COLUMN(alph, field) alph##_array *field;
+
+//! Expands to the declaration of a value of a row.
+#define DTYPE_TABLE_VALUE(alph, field) alph##_value field;
+
+//! Expands to the statements that operate on a column of a table.
+#define DTYPE_TABLE_NEW(alph, field)                                           \
+    ok = ok && (table->field = new_##alph##_array()) != NULL;
+#define DTYPE_TABLE_DEL(alph, field)                                           \
+    if (table->field != NULL) del_##alph##_array(table->field);
+#define DTYPE_TABLE_PUSH(alph, field)                                          \
+    ok = ok && alph##_array_push(table->field, row.field);
+#define DTYPE_TABLE_TRUNCATE(alph, field)                                      \
+    alph##_array_truncate(table->field, table->len);
+#define DTYPE_TABLE_GET(alph, field)                                           \
+    row.field = alph##_array_get(table->field, index);
+#define DTYPE_TABLE_GATHER(alph, field)                                        \
+    ok = ok &&                                                                 \
+        (result->field = alph##_array_gather(table->field, rows, n)) != NULL;
+
+//! Generates a columnar table of records.
+/*!
+The generated `name##_table` keeps one value array or string array per field of
+the records, so that scanning a field only touches the values of that field.
+`FIELDS` must be a macro that takes another macro `X` and calls `X(alph, field)`
+for each field, where `alph` names the array type, e.g. `uchar` or `string`.
+A record is passed in and out as a `name##_row` struct of the field values.
+
+The generated functions are `new_##name##_table`, `name##_table_len`,
+`name##_table_append`, `name##_table_get`, `name##_table_select` and
+`del_##name##_table`. Selecting rows copies them into a new table, which is how
+a table is sorted by a column, with `alph##_array_argsort`, or filtered, e.g.
+with `alph##_array_between`.
+
+An example of a table of students sorted by score:
+```
+#define STUDENT_FIELDS(X) X(ulong, id) X(string, name) X(uchar, score)
+MAKE_DTYPE_TABLE(student, STUDENT_FIELDS)
+
+student_table *students = new_student_table();
+student_table_append(students, (student_row) {42, "Ada", 99});
+size_t *perm = malloc(sizeof(size_t) * student_table_len(students));
+uchar_array_argsort(students->score, perm);
+student_table *by_score = student_table_select(students, perm,
+                                               student_table_len(students));
+```
+*/
+#define MAKE_DTYPE_TABLE(name, FIELDS)                                         \
+                                                                               \
+typedef struct {                                                               \
+    FIELDS(DTYPE_TABLE_COLUMN)                                                 \
+    size_t len;                                                                \
+} name##_table;                                                                \
+                                                                               \
+typedef struct {                                                               \
+    FIELDS(DTYPE_TABLE_VALUE)                                                  \
+} name##_row;                                                                  \
+                                                                               \
+static inline int del_##name##_table(name##_table *table) {                    \
+    if (table == NULL) {                                                       \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    FIELDS(DTYPE_TABLE_DEL)                                                    \
+    free(table);                                                               \
+    return 1;                                                                  \
+}                                                                              \
+                                                                               \
+static inline name##_table *new_##name##_table(void) {                         \
+    name##_table *table = (name##_table *) calloc(1, sizeof(name##_table));    \
+    if (table == NULL) {                                                       \
+        darray_errno = DARRAY_EALLOC;                                          \
+        return NULL;                                                           \
+    }                                                                          \
+    int ok = 1;                                                                \
+    FIELDS(DTYPE_TABLE_NEW)                                                    \
+    if (!ok) {                                                                 \
+        del_##name##_table(table);                                             \
+        return NULL;                                                           \
+    }                                                                          \
+    return table;                                                              \
+}                                                                              \
+                                                                               \
+static inline size_t name##_table_len(name##_table *table) {                   \
+    return table == NULL ? 0 : table->len;                                     \
+}                                                                              \
+                                                                               \
+static inline int name##_table_append(name##_table *table, name##_row row) {   \
+    if (table == NULL) {                                                       \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return 0;                                                              \
+    }                                                                          \
+    int ok = 1;                                                                \
+    FIELDS(DTYPE_TABLE_PUSH)                                                   \
+    if (!ok) {                                                                 \
+        FIELDS(DTYPE_TABLE_TRUNCATE)                                           \
+        return 0;                                                              \
+    }                                                                          \
+    table->len++;                                                              \
+    return 1;                                                                  \
+}                                                                              \
+                                                                               \
+static inline name##_row name##_table_get(name##_table *table, size_t index) { \
+    name##_row row;                                                            \
+    memset(&row, 0, sizeof(row));                                              \
+    if (table == NULL) {                                                       \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return row;                                                            \
+    }                                                                          \
+    if (index >= table->len) {                                                 \
+        darray_errno = DARRAY_EINDEX;                                          \
+        return row;                                                            \
+    }                                                                          \
+    FIELDS(DTYPE_TABLE_GET)                                                    \
+    return row;                                                                \
+}                                                                              \
+                                                                               \
+static inline name##_table *name##_table_select(                               \
+        name##_table *table, const size_t *rows, size_t n) {                   \
+    if (table == NULL || (rows == NULL && n > 0)) {                            \
+        darray_errno = DARRAY_ENULLS;                                          \
+        return NULL;                                                           \
+    }                                                                          \
+    name##_table *result = (name##_table *) calloc(1, sizeof(name##_table));   \
+    if (result == NULL) {                                                      \
+        darray_errno = DARRAY_EALLOC;                                          \
+        return NULL;                                                           \
+    }                                                                          \
+    int ok = 1;                                                                \
+    FIELDS(DTYPE_TABLE_GATHER)                                                 \
+    if (!ok) {                                                                 \
+        del_##name##_table(result);                                            \
+        return NULL;                                                           \
+    }                                                                          \
+    result->len = n;                                                           \
+    return result;                                                             \
+}
+
+//! Appends a value to a value array or a string array.
+#define dtyped_push(array, x)                                                  \
+    _Generic((array) DTYPED_ASSOCS(push),                                      \
+             string_array *: string_array_push)(array, x)
+
+//! Returns the sum of the values in a value array.
+#define dtyped_sum(array)                                                      \
+    _Generic((array) DTYPED_ASSOCS(sum))(array)
+
+//! Sorts a value array in ascending order.
+#define dtyped_sort(array)                                                     \
+    _Generic((array) DTYPED_ASSOCS(sort))(array)
+
+//! Gets a value in a value array or a string array.
+#define dtyped_get(array, index)                                               \
+    _Generic((array) DTYPED_ASSOCS(get),                                       \
+             string_array *: string_array_get)(array, index)
+
+//! Returns the length of a value array or a string array.
+#define dtyped_len(array)                                                      \
+    _Generic((array) DTYPED_ASSOCS(len),                                       \
+             string_array *: string_array_len)(array)
+
+#endif